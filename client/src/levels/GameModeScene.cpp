@@ -226,11 +226,8 @@ void GameModeScene::onStart() {
 }
 
 void GameModeScene::onUpdate(float deltaTime) {
-    static float matchCheckTimer = 0.0f;
-    matchCheckTimer += deltaTime;
-
-    // Check match status every second if in queue
-    if ((hexDuelpressed || hexArenapressed) && matchCheckTimer >= 1.0f) {
+    // While queued, checkMatchStatus only looks at the long poll the server answers once the match is made
+    if (hexDuelpressed || hexArenapressed) {
         try {
             if (ClientNetworkService::checkMatchStatus()) {
                 // Store the player's role in the match
@@ -255,7 +252,6 @@ void GameModeScene::onUpdate(float deltaTime) {
             hexDuelpressed = false;
             hexArenapressed = false;
         }
-        matchCheckTimer = 0.0f;
     }
 
     uiSystem.update(deltaTime, registry, camera);
@@ -212,12 +212,24 @@ uint64_t ClientNetworkService::joinMatch() {
 }
 
 bool ClientNetworkService::checkMatchStatus() {
-    try {
-        auto response = cpr::Get(
-            cpr::Url{serverUrl + "/match_status"},
+    // the server holds /match_wait open until the match is made, only a finished request is looked at
+    if (!pendingMatchWait) {
+        pendingMatchWait = std::make_unique<cpr::AsyncResponse>(cpr::GetAsync(
+            cpr::Url{serverUrl + "/match_wait"},
             cpr::Header{{"Content-Type", "application/json"}},
-            cpr::Parameters{{"playerId", std::to_string(loginToken)}}
-        );
+            cpr::Parameters{{"playerId", std::to_string(loginToken)}, {"timeoutMs", std::to_string(MATCH_WAIT_TIMEOUT_MS)}},
+            cpr::Timeout{MATCH_WAIT_TIMEOUT_MS + 5000}
+        ));
+        return false;
+    }
+
+    if (pendingMatchWait->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+
+    try {
+        auto response = pendingMatchWait->get();
+        pendingMatchWait.reset();
 
         if (response.status_code != 200) {
             if (response.status_code == 404) {
@@ -249,6 +261,7 @@ bool ClientNetworkService::checkMatchStatus() {
             return false;
         }
     } catch (const std::exception &e) {
+        pendingMatchWait.reset();
         AT_ERROR("Network error checking match status: {}", e.what());
         return false;
     }
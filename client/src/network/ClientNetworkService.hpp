@@ -2,6 +2,7 @@
 
 #include <Atlas.hpp>
 #include <boost/beast/http/verb.hpp>
+#include <cpr/cpr.h>
 
 #include "map/MapState.hpp"
 
@@ -25,11 +26,15 @@ public:
     static bool leaveMatchmaking();
     static bool submitMatchResult(uint64_t matchId, uint64_t winnerId);
     static uint64_t joinMatch();
+    // Non-blocking, keeps one long poll of /match_wait in flight and returns true once it reports a match.
     static bool checkMatchStatus();
     static uint64_t getCurrentMatchId();
     static uint64_t getCurrentPlayerId();
 
 private:
+    static constexpr int MATCH_WAIT_TIMEOUT_MS = 20000;
+
+    static inline std::unique_ptr<cpr::AsyncResponse> pendingMatchWait;
     static inline uint64_t loginToken{0};
     static inline std::string serverUrl{};
     static inline uint64_t currentMatchId{0};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <Atlas.hpp>
+
+#include "renderer/Color.hpp"
+
+/**
+ * Applies decoded snapshots to the client registry in place. The networkId -> entity index lives as
+ * long as the connection, entities a snapshot did not change since the last applied one are skipped
+ * and the components of the others are patched instead of replaced. Texture keys are built once per
+ * tile code and only copied when an entity's code changes, so once its entities exist a delta is
+ * applied without allocating.
+ */
+class SnapshotApplier {
+public:
+    static constexpr uint32_t FIREBALL_CODE = TILE_CODE + 110;
+
+    // What the network system needs from the snapshot just applied.
+    struct Result {
+        entt::entity localPawn = entt::null;
+        const EntitySnapshot *localPawnState = nullptr; // points into the applied snapshot
+        bool wallsChanged = false;
+    };
+
+    void setPlayerId(uint64_t playerId) { this->playerId = playerId; }
+
+    static bool isWall(const EntitySnapshot &entity) {
+        return entity.hasRigidbody && entity.isSolid && !entity.hasPawn;
+    }
+
+    Result apply(const Snapshot &snapshot, const Snapshot *previous, entt::registry &registry) {
+        Result result;
+        result.wallsChanged = previous == nullptr;
+
+        removeMissing(snapshot, previous, registry, result);
+
+        size_t previousIndex = 0;
+        for (const auto &state : snapshot.entities) {
+            // unchanged since the snapshot we applied last, its entity is up to date
+            if (previous) {
+                const auto &entities = previous->entities;
+                while (previousIndex < entities.size() && entities[previousIndex].networkId < state.networkId) ++previousIndex;
+                if (previousIndex < entities.size() && entities[previousIndex] == state) {
+                    continue;
+                }
+            }
+
+            entt::entity entity = find(state.networkId, registry);
+            if (entity == entt::null) {
+                entity = registry.create();
+                registry.emplace<NetworkComponent>(entity, state.networkId);
+                entities.emplace(state.networkId, entity);
+            }
+
+            // a wall appeared, changed or stopped being solid
+            if (state.hasRigidbody) {
+                result.wallsChanged = true;
+            }
+
+            patch(entity, state, snapshot, previous, registry, result);
+        }
+
+        return result;
+    }
+
+    // Forgets every entity, for a new connection.
+    void clear(entt::registry &registry) {
+        for (const auto &[networkId, entity] : entities) {
+            if (registry.valid(entity)) registry.destroy(entity);
+        }
+        entities.clear();
+    }
+
+    size_t size() const { return entities.size(); }
+
+private:
+    inline static const std::string IDLE_PAWN_TEXTURE = "front1";
+
+    uint64_t playerId{0};
+    std::unordered_map<uint64_t, entt::entity> entities;    // networkId -> entity, across snapshots
+    std::unordered_map<uint32_t, std::string> textureNames; // tile code -> texture key
+
+    entt::entity find(uint64_t networkId, entt::registry &registry) {
+        auto it = entities.find(networkId);
+        if (it == entities.end()) return entt::null;
+
+        // destroyed behind our back, e.g. with the registry cleared
+        if (!registry.valid(it->second)) {
+            entities.erase(it);
+            return entt::null;
+        }
+        return it->second;
+    }
+
+    void destroy(uint64_t networkId, entt::registry &registry) {
+        if (auto it = entities.find(networkId); it != entities.end()) {
+            if (registry.valid(it->second)) registry.destroy(it->second);
+            entities.erase(it);
+        }
+    }
+
+    void removeMissing(const Snapshot &snapshot, const Snapshot *previous, entt::registry &registry, Result &result) {
+        if (previous) {
+            // both lists are sorted by networkId, what the last one had and this one lacks is gone
+            auto current = snapshot.entities.begin();
+            for (const auto &old : previous->entities) {
+                while (current != snapshot.entities.end() && current->networkId < old.networkId) ++current;
+                if (current != snapshot.entities.end() && current->networkId == old.networkId) continue;
+
+                result.wallsChanged |= isWall(old);
+                destroy(old.networkId, registry);
+            }
+            return;
+        }
+
+        // nothing to compare with, every known entity is looked up
+        for (auto it = entities.begin(); it != entities.end();) {
+            if (std::ranges::binary_search(snapshot.entities, it->first, {}, &EntitySnapshot::networkId)) {
+                ++it;
+                continue;
+            }
+            if (registry.valid(it->second)) registry.destroy(it->second);
+            it = entities.erase(it);
+        }
+    }
+
+    const std::string &textureFor(uint32_t tileCode) {
+        if (auto it = textureNames.find(tileCode); it != textureNames.end()) {
+            return it->second;
+        }
+
+        std::string name;
+        if (tileCode == FIREBALL_CODE) {
+            name = "fireball01";
+        } else if (tileCode >= EntityCode::TILE_CODE && tileCode < EntityCode::TILE_CODE + EntityCode::NEXT) {
+            name = std::format("tile_{:04}", tileCode % TILE_CODE);
+        }
+        return textureNames.emplace(tileCode, std::move(name)).first->second;
+    }
+
+    void patch(entt::entity entity, const EntitySnapshot &state, const Snapshot &snapshot, const Snapshot *previous,
+               entt::registry &registry, Result &result) {
+        registry.get<NetworkComponent>(entity).tileCode = state.tileCode;
+        const std::string *texture = &textureFor(state.tileCode);
+        bool isThePlayer = false;
+
+        if (state.hasPawn) {
+            auto &pawn = registry.get_or_emplace<PawnComponent>(entity, state.playerId, false, false, false, false, 0.0f);
+            pawn.moveForward = state.hasFlag(EntitySnapshot::MOVE_FORWARD);
+            pawn.moveBackwards = state.hasFlag(EntitySnapshot::MOVE_BACKWARDS);
+            pawn.moveLeft = state.hasFlag(EntitySnapshot::MOVE_LEFT);
+            pawn.moveRight = state.hasFlag(EntitySnapshot::MOVE_RIGHT);
+            pawn.aimRotation = EntitySnapshot::dequantizeAngle(state.aimRotation);
+            pawn.lastInputSequence = state.lastInputSequence;
+
+            // If player is completely idle, use some default sprite
+            if (!pawn.moveForward && !pawn.moveBackwards && !pawn.moveLeft && !pawn.moveRight) {
+                texture = &IDLE_PAWN_TEXTURE;
+            }
+
+            if (state.playerId == this->playerId) {
+                isThePlayer = true;
+                result.localPawn = entity;
+                result.localPawnState = &state;
+            }
+        }
+
+        const glm::vec3 position = state.getPosition();
+        const float angleDegrees = glm::degrees(EntitySnapshot::dequantizeAngle(state.rotation)); // server rotation is in radians
+
+        if (auto transform = registry.try_get<TransformComponent>(entity)) {
+            transform->position = position;
+            transform->rotation = angleDegrees;
+            transform->scale = state.getScale();
+        } else {
+            registry.emplace<TransformComponent>(entity, position, angleDegrees, state.getScale());
+        }
+
+        // moving remote entities go through their snapshot buffer, the network system places them
+        const bool isFireball = state.tileCode == FIREBALL_CODE;
+        if (isFireball || (state.hasPawn && !isThePlayer)) {
+            auto &interpolation = registry.get_or_emplace<InterpolationComponent>(entity);
+            if (previous) {
+                interpolation.buffer.hold(SnapshotClock::serverTime(previous->tick));
+            }
+            interpolation.buffer.push(SnapshotClock::serverTime(snapshot.tick), position);
+
+            if (isFireball) {
+                interpolation.extrapolate = true;
+                interpolation.velocity = FireballComponent::velocityFor(EntitySnapshot::dequantizeAngle(state.rotation));
+            }
+        }
+
+        if (auto render = registry.try_get<RenderComponent>(entity)) {
+            if (render->textureKey != *texture) {
+                render->textureKey = *texture;
+            }
+        } else {
+            // Center sprite if it's a fireball
+            registry.emplace<RenderComponent>(entity, *texture, RenderComponent::defaultTexCoords(), Color::white(), isFireball);
+        }
+    }
+};
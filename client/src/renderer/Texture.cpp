@@ -1,5 +1,6 @@
 #include "Texture.hpp"
 
+#define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <glad/glad.h>
 
@@ -6,6 +6,7 @@
 #include <boost/asio/connect.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <entt/entt.hpp>
+#include "network/SnapshotApplier.hpp"
 #include "renderer/Color.hpp"
 #include "window/Keyboard.hpp"
 #include "window/Mouse.hpp"
@@ -49,9 +50,13 @@ public:
 
     // local deltaTime - only for predictions
     void update(float deltaTime, entt::registry &registry, const Camera &camera) {
+        localTime += deltaTime;
+
         if (connected) {
-            sendInput(camera);
+            sendInput(deltaTime, camera);
             processUpdates(registry);
+            showPrediction(registry);
+            showInterpolated(registry);
         } else {
             std::cerr << "WebSocket is not connected. Update skipped." << std::endl;
         }
@@ -59,10 +64,21 @@ public:
 
     void setPlayerId(uint64_t playerId) {
         this->playerId = playerId;
+        this->applier.setPlayerId(playerId);
+    }
+
+    // With prediction on the local pawn moves the frame a key is pressed instead of a round trip later.
+    void setPrediction(bool enabled) {
+        this->predictionEnabled = enabled;
+    }
+
+    // How far behind the server remote entities are drawn, in seconds. Longer hides more jitter.
+    void setInterpolationDelay(double seconds) {
+        this->snapshotClock.setDelay(seconds);
     }
 
 private:
-    void sendInput(const Camera &camera) {
+    void sendInput(float deltaTime, const Camera &camera) {
         nlohmann::json input;
 
         auto playerScreenCoords = camera.worldToScreen(playerPos);
@@ -80,15 +96,33 @@ private:
 
         ImGui::Text("Pos: %.2f, %.2f, Angle: %.2f", playerPos.x, playerPos.y, glm::degrees(angleRadians));
 
+        PlayerInput playerInput;
+        playerInput.moveBackwards = Keyboard::isKeyPressed(Keyboard::S);
+        playerInput.moveForward = Keyboard::isKeyPressed(Keyboard::W);
+        playerInput.moveRight = Keyboard::isKeyPressed(Keyboard::D);
+        playerInput.moveLeft = Keyboard::isKeyPressed(Keyboard::A);
+        playerInput.aimRotation = angleRadians;
+        playerInput.isShooting = Mouse::isButtonPressed(Mouse::ButtonLeft);
+        playerInput.sequence = ++inputSequence;
+        playerInput.deltaTime = deltaTime;
+
         input["playerId"] = this->playerId;
         input["input"] = {
-            {"moveBackward", Keyboard::isKeyPressed(Keyboard::S)},
-            {"moveForward", Keyboard::isKeyPressed(Keyboard::W)},
-            {"moveRight", Keyboard::isKeyPressed(Keyboard::D)},
-            {"moveLeft", Keyboard::isKeyPressed(Keyboard::A)},
-            {"aimRotation", angleRadians},
-            {"isShooting", Mouse::isButtonPressed(Mouse::ButtonLeft)}
+            {"moveBackward", playerInput.moveBackwards},
+            {"moveForward", playerInput.moveForward},
+            {"moveRight", playerInput.moveRight},
+            {"moveLeft", playerInput.moveLeft},
+            {"aimRotation", playerInput.aimRotation},
+            {"isShooting", playerInput.isShooting}
         };
+        // the server simulates every numbered input for the frame time it was held
+        input["seq"] = playerInput.sequence;
+        input["dt"] = playerInput.deltaTime;
+        input["ack"] = lastSnapshotTick;
+
+        if (predictionEnabled) {
+            prediction.predict(playerInput);
+        }
 
         try {
             websocketStream.write(boost::asio::buffer(input.dump()));
@@ -98,15 +132,28 @@ private:
     }
 
 
+    // Frames are copied into strings the main thread handed back, once they have grown to the frame
+    // size a steady stream of snapshots allocates nothing.
     void readServerUpdates() {
+        boost::beast::flat_buffer buffer;
         while (connected) {
             try {
-                boost::beast::flat_buffer buffer;
+                buffer.clear();
                 websocketStream.read(buffer);
 
-                auto response = nlohmann::json::parse(boost::beast::buffers_to_string(buffer.data())); {
+                // game state comes as binary snapshots, text frames are error messages
+                if (!websocketStream.got_binary()) {
+                    AT_WARN("Server message: {}", boost::beast::buffers_to_string(buffer.data()));
+                    continue;
+                }
+
+                {
                     std::lock_guard<std::mutex> lock(updateMutex);
-                    updateQueue.push(response);
+                    if (incomingFrameCount == incomingFrames.size()) {
+                        incomingFrames.emplace_back();
+                    }
+                    const auto data = buffer.data();
+                    incomingFrames[incomingFrameCount++].assign(static_cast<const char *>(data.data()), data.size());
                 }
                 updateCondition.notify_one();
             } catch (const std::exception &e) {
@@ -116,171 +163,111 @@ private:
     }
 
     void processUpdates(entt::registry &registry) {
-        std::queue<nlohmann::json> local_queue; {
+        // the reader gets the strings of the last batch back to fill
+        size_t frameCount;
+        {
             std::lock_guard<std::mutex> lock(updateMutex);
-            std::swap(local_queue, updateQueue);
+            incomingFrames.swap(processingFrames);
+            frameCount = std::exchange(incomingFrameCount, 0);
         }
 
-        while (!local_queue.empty()) {
-            auto update = local_queue.front();
-            local_queue.pop();
-
-            overwriteRegistry(update, registry);
-        }
-    }
+        for (size_t i = 0; i < frameCount; ++i) {
+            const std::string &frame = processingFrames[i];
 
-    void overwriteRegistry(const nlohmann::json &jsonResponse, entt::registry &registry) {
-        try {
-            std::unordered_map<uint64_t, entt::entity> existingEntities;
-            std::unordered_set<uint64_t> deletedEntitiesSet;
-
-            if (jsonResponse.contains("deletedEntities") &&
-                !jsonResponse["deletedEntities"].empty())
-            {
-                for (const auto &id : jsonResponse["deletedEntities"]) {
-                    deletedEntitiesSet.insert(id.get<uint64_t>());
-                }
+            SnapshotCodec::Header header;
+            if (!SnapshotCodec::readHeader(frame, header) || header.tick <= lastSnapshotTick) {
+                continue;
             }
 
-            // Track existing entities
-            auto view = registry.view<NetworkComponent>();
-            for (auto entity : view) {
-                auto &netComp = view.get<NetworkComponent>(entity);
-
-                // Destroy if server says "deleted"
-                if (!deletedEntitiesSet.empty() &&
-                    deletedEntitiesSet.contains(netComp.networkId))
-                {
-                    registry.destroy(entity);
-                    continue;
-                }
-
-                existingEntities[netComp.networkId] = entity;
+            // a frame against a baseline we no longer have is dropped, the server falls back to our last ack
+            if (!SnapshotCodec::decode(frame, snapshots.find(header.baseTick), decoded)) {
+                AT_WARN("Dropped snapshot {} with unknown baseline {}", header.tick, header.baseTick);
+                continue;
             }
 
-            // Process new/updated entities
-            for (const auto &entityData : jsonResponse["entities"]) {
-                uint64_t networkId = entityData["networkId"].get<uint64_t>();
-                entt::entity entity;
-                bool isThePlayer = false;
-
-                // Reuse or create
-                if (existingEntities.contains(networkId)) {
-                    entity = existingEntities[networkId];
-                } else {
-                    entity = registry.create();
-                    registry.emplace<NetworkComponent>(entity, networkId);
-                }
+            snapshotClock.onSnapshot(decoded.tick, localTime);
+            applySnapshot(decoded, snapshots.find(lastSnapshotTick), registry);
 
-                // Check tile code
-                auto tileCode = entityData["tile-code"].get<uint32_t>();
-                std::string textureName;
+            lastSnapshotTick = decoded.tick;
+            snapshots.store(decoded);
+        }
+    }
 
-                // Fireball?
-                if (tileCode == TILE_CODE + 110) {
-                    textureName = "fireball01";
-                }
-                // Normal tile (just an example check)
-                else if (tileCode >= EntityCode::TILE_CODE &&
-                         tileCode < EntityCode::TILE_CODE + EntityCode::NEXT)
-                {
-                    textureName =
-                        std::format("tile_{:04}", tileCode % TILE_CODE);
-                }
+    // Moves the local pawn to its predicted position, every frame and not only when a snapshot came in.
+    void showPrediction(entt::registry &registry) {
+        if (!predictionEnabled || !prediction.hasPosition() || !registry.valid(playerEntity)) {
+            return;
+        }
 
-                // If we have Pawn data
-                if (entityData.contains("PawnComponent")) {
-                    auto id = entityData["PawnComponent"]["playerId"];
-                    auto &pawnComp = registry.get_or_emplace<PawnComponent>(
-                        entity, id, false, false, false, false, 0.0f
-                    );
-
-                    pawnComp.moveForward   = entityData["PawnComponent"]["moveForward"];
-                    pawnComp.moveBackwards = entityData["PawnComponent"]["moveBackwards"];
-                    pawnComp.moveLeft      = entityData["PawnComponent"]["moveLeft"];
-                    pawnComp.moveRight     = entityData["PawnComponent"]["moveRight"];
-                    pawnComp.aimRotation   = entityData["PawnComponent"]["aimRotation"];
-
-                    // If player is completely idle, use some default sprite
-                    if (!pawnComp.moveForward && !pawnComp.moveBackwards &&
-                        !pawnComp.moveLeft    && !pawnComp.moveRight)
-                    {
-                        textureName = "front1";
-                    }
+        if (auto transform = registry.try_get<TransformComponent>(playerEntity)) {
+            transform->position = prediction.getPosition();
+            this->playerPos = transform->position;
+        }
+    }
 
-                    // Track if it's our local player
-                    if (id == this->playerId) {
-                        isThePlayer = true;
-                    }
-                }
+    // Remote pawns and fireballs at the clock's render time, between the snapshots around it.
+    void showInterpolated(entt::registry &registry) {
+        if (!snapshotClock.isSynced()) {
+            return;
+        }
 
-                // If there's a TransformComponent from server
-                if (entityData.contains("TransformComponent")) {
-                    auto pos = glm::vec3(
-                        entityData["TransformComponent"]["position"][0],
-                        entityData["TransformComponent"]["position"][1],
-                        entityData["TransformComponent"]["position"][2]
-                    );
+        const double renderTime = snapshotClock.renderTime(localTime);
+        auto view = registry.view<InterpolationComponent, TransformComponent>();
+        for (auto [entity, interpolation, transform] : view.each()) {
+            const glm::vec3 *velocity = interpolation.extrapolate ? &interpolation.velocity : nullptr;
+            transform.position = interpolation.buffer.sample(renderTime, velocity, MAX_EXTRAPOLATION);
+        }
+    }
 
-                    if (isThePlayer) {
-                        this->playerPos = pos;
-                    }
+    void applySnapshot(const Snapshot &snapshot, const Snapshot *previous, entt::registry &registry) {
+        const auto result = applier.apply(snapshot, previous, registry);
 
-                    // Scale
-                    glm::vec2 scale(
-                        entityData["TransformComponent"]["scale"][0],
-                        entityData["TransformComponent"]["scale"][1]
-                    );
-
-                    // Read server rotation (radians)
-                    float serverRotationRadians =
-                        entityData["TransformComponent"]["rotation"].get<float>();
-                    float angleDegrees = glm::degrees(serverRotationRadians);
-
-                    // For fireballs, use the aim rotation directly
-                    if (tileCode == TILE_CODE + 110) {
-                        // For fireballs, we want them to point in the direction they're moving
-                        // The angle from sendInput() is already in the correct orientation
-                        if (entityData.contains("FireballComponent")) {
-                            angleDegrees = glm::degrees(entityData["FireballComponent"]["direction"].get<float>());
-                        }
-                    }
+        if (result.localPawnState) {
+            this->playerPos = result.localPawnState->getPosition();
+            this->playerEntity = result.localPawn;
+        }
 
-                    // Update the Transform
-                    registry.emplace_or_replace<TransformComponent>(
-                        entity,
-                        pos,
-                        angleDegrees,
-                        scale
-                    );
-
-                    // Center sprite if it's a fireball
-                    bool centerSprite = (tileCode == TILE_CODE + 110);
-                    registry.emplace_or_replace<RenderComponent>(
-                        entity,
-                        textureName,
-                        RenderComponent::defaultTexCoords(),
-                        Color::white(),
-                        centerSprite  // "isCentered" = true for fireballs
-                    );
+        // walls change only when one is blasted, the prediction keeps its own copy
+        if (result.wallsChanged) {
+            prediction.clearWalls();
+            for (const auto &entityData : snapshot.entities) {
+                if (SnapshotApplier::isWall(entityData)) {
+                    prediction.addWall(entityData.getPosition(), entityData.getScale());
                 }
             }
-        } catch (std::exception &e) {
-            // If an exception occurs, just return
-            return;
+        }
+
+        // back to the server's position, then the inputs it has not seen yet on top
+        if (predictionEnabled && result.localPawnState) {
+            const auto &pawn = *result.localPawnState;
+            prediction.reconcile(pawn.getPosition(), pawn.getScale(), pawn.lastInputSequence);
         }
     }
 
 private:
     uint64_t playerId{0};
     glm::vec3 playerPos{0.0f, 0.0f, 0.0f};
+    entt::entity playerEntity{entt::null};
+
+    bool predictionEnabled{true};
+    double localTime{0.0}; // sum of the frame times, the clock snapshots and rendering share
+    SnapshotClock snapshotClock;
+    static constexpr double MAX_EXTRAPOLATION = 0.25; // a fireball that stopped updating flies on this long at most
+    PawnPrediction prediction; // the local pawn, ahead of the snapshots by the inputs still in flight
+    SnapshotApplier applier;
 
     boost::asio::io_context ioContext;
     boost::asio::ip::tcp::resolver resolver;
     boost::beast::websocket::stream<boost::asio::ip::tcp::socket> websocketStream;
     bool connected;
 
-    std::queue<nlohmann::json> updateQueue; // store incoming updates
+    std::vector<std::string> incomingFrames; // binary frames from the reader, guarded by updateMutex
+    size_t incomingFrameCount{0};            // frames in use, the strings after them keep their capacity
+    std::vector<std::string> processingFrames; // the previous batch, main thread only
+    SnapshotHistory snapshots;           // applied snapshots, baselines for the next deltas
+    Snapshot decoded;
+    uint32_t lastSnapshotTick{0};
+    uint32_t inputSequence{0}; // last input sent, a new connection starts again from 1
     std::mutex updateMutex;
     std::condition_variable updateCondition;
     std::thread readerThread;
@@ -0,0 +1,173 @@
+// Applies a full map snapshot and a 10 entity delta to a client registry, once the way
+// NetworkSystem::overwriteRegistry did (index rebuilt every apply, texture names formatted, components
+// replaced) and once through SnapshotApplier. Reports microseconds and heap allocations per apply.
+//
+// usage: snapshot_apply_bench [applies]
+
+#include "network/SnapshotApplier.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> allocations{0};
+}
+
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+namespace {
+    constexpr int MAP_SIZE = 50;
+    constexpr size_t DELTA_ENTITIES = 10;
+
+    // NetworkSystem::overwriteRegistry before the persistent index.
+    class RebuildingApplier {
+    public:
+        void apply(const Snapshot &snapshot, const Snapshot *previous, entt::registry &registry) {
+            std::unordered_map<uint64_t, entt::entity> existingEntities;
+
+            auto view = registry.view<NetworkComponent>();
+            for (auto entity : view) {
+                auto &netComp = view.get<NetworkComponent>(entity);
+                if (!std::ranges::binary_search(snapshot.entities, netComp.networkId, {}, &EntitySnapshot::networkId)) {
+                    registry.destroy(entity);
+                    continue;
+                }
+                existingEntities[netComp.networkId] = entity;
+            }
+
+            size_t previousIndex = 0;
+            for (const auto &entityData : snapshot.entities) {
+                entt::entity entity;
+                if (existingEntities.contains(entityData.networkId)) {
+                    entity = existingEntities[entityData.networkId];
+                    if (previous) {
+                        const auto &entities = previous->entities;
+                        while (previousIndex < entities.size() && entities[previousIndex].networkId < entityData.networkId) ++previousIndex;
+                        if (previousIndex < entities.size() && entities[previousIndex] == entityData) continue;
+                    }
+                } else {
+                    entity = registry.create();
+                    registry.emplace<NetworkComponent>(entity, entityData.networkId);
+                }
+
+                std::string textureName;
+                if (entityData.tileCode == SnapshotApplier::FIREBALL_CODE) {
+                    textureName = "fireball01";
+                } else if (entityData.tileCode >= TILE_CODE && entityData.tileCode < TILE_CODE + NEXT) {
+                    textureName = std::format("tile_{:04}", entityData.tileCode % TILE_CODE);
+                }
+
+                registry.emplace_or_replace<TransformComponent>(entity, entityData.getPosition(),
+                    glm::degrees(EntitySnapshot::dequantizeAngle(entityData.rotation)), entityData.getScale());
+                registry.emplace_or_replace<RenderComponent>(entity, textureName, RenderComponent::defaultTexCoords(),
+                    Color::white(), entityData.tileCode == SnapshotApplier::FIREBALL_CODE);
+            }
+        }
+    };
+
+    Snapshot buildMap(uint32_t tick) {
+        Snapshot snapshot;
+        snapshot.tick = tick;
+        uint64_t networkId = 0;
+        for (int row = 0; row < MAP_SIZE; ++row) {
+            for (int col = 0; col < MAP_SIZE; ++col) {
+                EntitySnapshot &tile = snapshot.entities.emplace_back();
+                tile.networkId = networkId++;
+                tile.tileCode = TILE_CODE + (row * 7 + col * 3) % 64;
+                tile.setPosition({col * 100.0f - 2450.0f, row * 100.0f - 2450.0f, 5.0f});
+                tile.setScale({100.0f, 100.0f});
+                tile.hasRigidbody = tile.tileCode == TILE_CODE + 40;
+                tile.isSolid = tile.hasRigidbody;
+            }
+        }
+
+        // the moving part: two pawns and a few fireballs
+        for (size_t i = 0; i < DELTA_ENTITIES; ++i) {
+            EntitySnapshot &entity = snapshot.entities.emplace_back();
+            entity.networkId = networkId++;
+            entity.setScale({100.0f, 100.0f});
+            if (i < 2) {
+                entity.tileCode = TILE_CODE + 100;
+                entity.hasPawn = true;
+                entity.playerId = i + 1;
+                entity.pawnFlags = EntitySnapshot::MOVE_RIGHT;
+            } else {
+                entity.tileCode = SnapshotApplier::FIREBALL_CODE;
+                entity.rotation = EntitySnapshot::quantizeAngle(0.3f * i);
+            }
+        }
+        return snapshot;
+    }
+
+    // The moving entities of base one tick later.
+    Snapshot advance(const Snapshot &base) {
+        Snapshot next = base;
+        next.tick = base.tick + 1;
+        for (size_t i = next.entities.size() - DELTA_ENTITIES; i < next.entities.size(); ++i) {
+            auto position = next.entities[i].getPosition();
+            position.x += 3.0f;
+            next.entities[i].setPosition(position);
+        }
+        return next;
+    }
+
+    struct Cost {
+        double microseconds;
+        double allocations;
+    };
+
+    template<typename Func>
+    Cost measure(size_t applies, Func &&apply) {
+        const uint64_t allocationsBefore = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < applies; ++i) {
+            apply(i);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {seconds * 1e6 / static_cast<double>(applies),
+                static_cast<double>(allocations.load() - allocationsBefore) / static_cast<double>(applies)};
+    }
+
+    template<typename Applier>
+    void run(const char *name, size_t applies) {
+        const Snapshot even = buildMap(10);
+        const Snapshot odd = advance(even);
+        entt::registry registry;
+        Applier applier;
+        applier.apply(even, nullptr, registry); // joined, every entity exists from here on
+
+        // a resync: the full state again, no baseline
+        const Cost full = measure(applies, [&](size_t i) {
+            applier.apply(i % 2 ? odd : even, nullptr, registry);
+        });
+
+        // steady play: every tick moves the same 10 entities
+        applier.apply(even, nullptr, registry);
+        const Cost delta = measure(applies * 10, [&](size_t i) {
+            if (i % 2) applier.apply(even, &odd, registry);
+            else applier.apply(odd, &even, registry);
+        });
+
+        std::printf("%-10s full map %9.1f us %9.1f allocations   delta %7.2f us %6.1f allocations\n",
+                    name, full.microseconds, full.allocations, delta.microseconds, delta.allocations);
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t applies = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+
+    std::printf("%d tiles and %zu moving entities, %zu full and %zu delta applies\n",
+                MAP_SIZE * MAP_SIZE, DELTA_ENTITIES, applies, applies * 10);
+    run<RebuildingApplier>("rebuild", applies);
+    run<SnapshotApplier>("in place", applies);
+    return 0;
+}
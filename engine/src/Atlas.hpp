@@ -2,12 +2,19 @@
 
 // core
 #include "core/Core.hpp"
+#include "core/Profiler.hpp"
 
 // events
 #include "event/EventManager.hpp"
 
 // entity
 #include "entity/Entity.hpp"
+#include "entity/PawnMovement.hpp"
+
+// network
+#include "network/SnapshotCodec.hpp"
+#include "network/PawnPrediction.hpp"
+#include "network/SnapshotInterpolation.hpp"
 
 // utils
 #include "utils/Time.hpp"
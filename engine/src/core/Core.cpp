@@ -1,7 +0,0 @@
-#include "Core.hpp"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-#include <ft2build.h>
-#include FT_FREETYPE_H
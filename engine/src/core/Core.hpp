@@ -47,12 +47,17 @@
 #else
 #define ATLAS_API __declspec(dllimport)
 #endif
+#define AT_DEBUGBREAK() __debugbreak()
+#elif defined(__linux__)
+#include <csignal>
+#define ATLAS_API __attribute__((visibility("default")))
+#define AT_DEBUGBREAK() std::raise(SIGTRAP)
 #else
-#error "Atlas currently supports only Windows platforms."
+#error "Atlas currently supports only Windows and Linux platforms."
 #endif
 
 #ifdef ATLAS_ENABLE_ASSERT
-#define AT_ASSERT(X, ...) { if(!(X)) { AT_ERROR(__VA_ARGS__); __debugbreak(); } }
+#define AT_ASSERT(X, ...) { if(!(X)) { AT_ERROR(__VA_ARGS__); AT_DEBUGBREAK(); } }
 #else
 #define AT_ASSERT(X, ...)
 #endif
@@ -1,5 +1,7 @@
 #include "Log.hpp"
 
+#include <sstream>
+
 #ifdef _WIN32
 
 #include <windows.h>
@@ -10,6 +12,37 @@
 
 std::shared_ptr<Log> Log::coreLogger = nullptr;
 
+Log::Log() : records(std::make_unique<Record[]>(QUEUE_CAPACITY)) {
+    for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+        records[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+#ifdef _WIN32
+    // let the console understand the same ANSI color codes as a Linux terminal
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(hConsole, &mode)) {
+        SetConsoleMode(hConsole, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+#endif
+
+    writer = std::thread(&Log::writerLoop, this);
+}
+
+Log::~Log() { {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    stopping = true;
+}
+    writerCondition.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    if (file) {
+        std::fclose(file);
+    }
+}
+
 void Log::init() {
     coreLogger = std::make_shared<Log>();
 }
@@ -22,25 +55,192 @@ void Log::setLogLevel(LogLevel level) {
     logLevel = level;
 }
 
+void Log::setFileOutput(const std::string &path, LogFormat format) {
+    flush();
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (file) {
+        std::fclose(file);
+    }
+
+    file = std::fopen(path.c_str(), format == LogFormat::Binary ? "ab" : "a");
+    fileFormat = format;
+}
+
 void Log::log(LogLevel level, const std::string &message) {
-    if (level >= logLevel || level == LogLevel::Message) {
-        applyColor(level);
-        std::cout << "[" << getCurrentTime() << "/" << getLogLevelString(level) << "]: "
-                  << message << std::endl;
-        resetColor();
-
-        if (level == LogLevel::Fatal) {
-            exit(1);
+    if (!isEnabled(level)) return;
+
+    if (Record *record = beginRecord(level)) {
+        record->length = static_cast<uint32_t>(message.copy(record->text, MAX_MESSAGE));
+        commitRecord(record);
+    }
+}
+
+void Log::flush() {
+    const uint64_t target = enqueuePosition.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> lock(writerMutex);
+    writerCondition.notify_one();
+    flushCondition.wait(lock, [&]() {
+        return stopping || writtenPosition.load(std::memory_order_acquire) >= target;
+    });
+}
+
+// Bounded MPMC queue by Dmitry Vyukov, used with a single consumer. A slot is free for position p
+// when its sequence equals p and readable when it equals p + 1.
+Log::Record *Log::beginRecord(LogLevel level) {
+    uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+    while (true) {
+        Record &record = records[position & (QUEUE_CAPACITY - 1)];
+        const auto difference = static_cast<int64_t>(record.sequence.load(std::memory_order_acquire)) -
+                                static_cast<int64_t>(position);
+
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                record.position = position;
+                record.level = level;
+                record.timestamp = now();
+                return &record;
+            }
+        } else if (difference < 0) {
+            // full, the writer is behind. Warnings and errors wait for room, chatter is dropped
+            if (level >= LogLevel::Warn) {
+                writerCondition.notify_one();
+                std::this_thread::yield();
+                position = enqueuePosition.load(std::memory_order_relaxed);
+                continue;
+            }
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
         }
     }
 }
 
-std::string Log::getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::ostringstream oss;
-    oss << std::put_time(std::localtime(&in_time_t), "%H:%M:%S");
-    return oss.str();
+void Log::commitRecord(Record *record) {
+    const LogLevel level = record->level;
+    record->sequence.store(record->position + 1, std::memory_order_release);
+
+    if (writerIdle.load(std::memory_order_acquire)) {
+        writerCondition.notify_one();
+    }
+
+    if (level == LogLevel::Fatal) {
+        flush();
+        exit(1);
+    }
+}
+
+void Log::writerLoop() {
+    std::string consoleBatch;
+    std::string fileBatch;
+    uint64_t reportedDrops = 0;
+
+    while (true) {
+        consoleBatch.clear();
+        fileBatch.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(writerMutex);
+            while (true) {
+                Record &record = records[dequeuePosition & (QUEUE_CAPACITY - 1)];
+                if (record.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+                    break;
+                }
+
+                writeRecord(consoleBatch, fileBatch, record.level, record.timestamp,
+                            std::string_view(record.text, record.length));
+
+                record.sequence.store(dequeuePosition + QUEUE_CAPACITY, std::memory_order_release);
+                ++dequeuePosition;
+            }
+
+            // written by the writer itself, going through the ring could wait on a full ring only it drains
+            if (const uint64_t totalDrops = dropped.load(std::memory_order_relaxed); totalDrops > reportedDrops) {
+                const std::string notice = "Logger queue full, dropped " + std::to_string(totalDrops - reportedDrops) + " messages";
+                writeRecord(consoleBatch, fileBatch, LogLevel::Warn, now(), notice);
+                reportedDrops = totalDrops;
+            }
+
+            if (!consoleBatch.empty()) {
+                std::fwrite(consoleBatch.data(), 1, consoleBatch.size(), stdout);
+                std::fflush(stdout);
+            }
+            if (file && !fileBatch.empty()) {
+                std::fwrite(fileBatch.data(), 1, fileBatch.size(), file);
+                std::fflush(file);
+            }
+
+            writtenPosition.store(dequeuePosition, std::memory_order_release);
+        }
+        flushCondition.notify_all();
+
+        if (!consoleBatch.empty()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(writerMutex);
+        if (stopping) {
+            return;
+        }
+
+        // producers only notify when the writer says it is idle, the timeout covers the race in between
+        writerIdle.store(true, std::memory_order_release);
+        writerCondition.wait_for(lock, std::chrono::milliseconds(10));
+        writerIdle.store(false, std::memory_order_release);
+    }
+}
+
+uint64_t Log::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Log::writeRecord(std::string &consoleBatch, std::string &fileBatch, LogLevel level, uint64_t timestamp, std::string_view text) {
+    writeText(consoleBatch, level, timestamp, text, true);
+    if (file) {
+        fileFormat == LogFormat::Binary ? writeBinary(fileBatch, level, timestamp, text) : writeText(fileBatch, level, timestamp, text, false);
+    }
+}
+
+// Color codes only go to the console, a log file gets plain lines.
+void Log::writeText(std::string &batch, LogLevel level, uint64_t timestamp, std::string_view text, bool colored) {
+    if (colored) batch += getColor(level);
+    batch += "[";
+    batch += getCurrentTime(timestamp);
+    batch += "/";
+    batch += getLogLevelString(level);
+    batch += "]: ";
+    batch += text;
+    batch += colored ? "\033[0m\n" : "\n";
+}
+
+void Log::writeBinary(std::string &batch, LogLevel level, uint64_t timestamp, std::string_view text) {
+    auto append = [&](const auto &value) {
+        batch.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+
+    append(timestamp);
+    append(static_cast<int8_t>(level));
+    append(static_cast<uint32_t>(text.size()));
+    batch += text;
+}
+
+std::string Log::getCurrentTime(uint64_t timestamp) {
+    const auto in_time_t = static_cast<std::time_t>(timestamp / 1'000'000'000ull);
+
+    // only the writer thread formats times, cache the last second it printed
+    static std::time_t cachedTime = -1;
+    static std::string cachedString;
+
+    if (in_time_t != cachedTime) {
+        std::ostringstream oss;
+        oss << std::put_time(std::localtime(&in_time_t), "%H:%M:%S");
+        cachedString = oss.str();
+        cachedTime = in_time_t;
+    }
+    return cachedString;
 }
 
 // Get log level as string
@@ -63,46 +263,14 @@ constexpr std::string Log::getLogLevelString(LogLevel level) {
     }
 }
 
-void Log::applyColor(LogLevel level) {
-#ifdef _WIN32
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    switch (level) {
-        case LogLevel::Message:
-            SetConsoleTextAttribute(hConsole, 10);
-            break; // green
-        case LogLevel::Trace:
-            SetConsoleTextAttribute(hConsole, 7);
-            break;    // White
-        case LogLevel::Info:
-            SetConsoleTextAttribute(hConsole, 13);
-            break;   // Violet (Magenta)
-        case LogLevel::Warn:
-            SetConsoleTextAttribute(hConsole, 14);
-            break;   // Yellow
-        case LogLevel::Error:
-            SetConsoleTextAttribute(hConsole, 12);
-            break;   // Red
-        case LogLevel::Fatal:
-            SetConsoleTextAttribute(hConsole, 12 | FOREGROUND_INTENSITY);
-            break; // Bold Red
-    }
-#else
+const char *Log::getColor(LogLevel level) {
     switch (level) {
-        case LogLevel::Message  std::cout << "\033[32m"; break;  // Green
-        case LogLevel::Trace: std::cout << "\033[37m"; break;  // White
-        case LogLevel::Info:  std::cout << "\033[35m"; break;  // Violet (Magenta)
-        case LogLevel::Warn:  std::cout << "\033[33m"; break;  // Yellow
-        case LogLevel::Error: std::cout << "\033[31m"; break;  // Red
-        case LogLevel::Fatal: std::cout << "\033[1;31m"; break; // Bold Red
+        case LogLevel::Message: return "\033[32m";  // Green
+        case LogLevel::Trace: return "\033[37m";    // White
+        case LogLevel::Info: return "\033[35m";     // Violet (Magenta)
+        case LogLevel::Warn: return "\033[33m";     // Yellow
+        case LogLevel::Error: return "\033[31m";    // Red
+        case LogLevel::Fatal: return "\033[1;31m";  // Bold Red
+        default: return "\033[0m";
     }
-#endif
-}
-
-void Log::resetColor() {
-#ifdef _WIN32
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hConsole, 7);
-#else
-    std::cout << "\033[0m";
-#endif
 }
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <format>
 #include <chrono>
 #include <iomanip>
+#include <thread>
 
 enum class LogLevel {
     Message = -1,
@@ -16,38 +23,139 @@ enum class LogLevel {
     Fatal
 };
 
-class Log {
-private:
-    static std::shared_ptr<Log> coreLogger;
-    LogLevel logLevel = LogLevel::Trace;
+enum class LogFormat {
+    Text,
+    Binary // u64 timestamp (ns since epoch), u8 level, u32 length, message bytes
+};
+
+// Levels below this are removed at compile time, the arguments are not even evaluated.
+#ifndef AT_LOG_MIN_LEVEL
+#define AT_LOG_MIN_LEVEL 0
+#endif
 
+/**
+ * Asynchronous logger. The calling thread formats straight into a slot of a bounded lock-free
+ * multi producer ring; a background thread drains the ring and writes the records in batches.
+ * When the ring is full trace and info records are dropped and counted instead of blocking the
+ * caller, warnings and above wait for room.
+ */
+class Log {
 public:
+    static constexpr size_t QUEUE_CAPACITY = 2048; // power of two
+    static constexpr size_t MAX_MESSAGE = 384;     // longer messages are truncated
+
+    struct Record {
+        std::atomic<uint64_t> sequence;
+        uint64_t position;
+        uint64_t timestamp;
+        LogLevel level;
+        uint32_t length;
+        char text[MAX_MESSAGE];
+    };
+
+    Log();
+    ~Log();
+
+    Log(const Log &) = delete;
+    Log &operator=(const Log &) = delete;
+
     static void init();
 
     static std::shared_ptr<Log> &getCoreLogger();
 
     void setLogLevel(LogLevel level);
 
+    // Also writes every record to path, in addition to the console.
+    void setFileOutput(const std::string &path, LogFormat format);
+
     void log(LogLevel level, const std::string &message);
 
     template<typename... Args>
     void log(LogLevel level, const std::format_string<Args...> &formatString, Args &&... args) {
-        log(level, std::format(formatString, std::forward<Args>(args)...));
+        if (!isEnabled(level)) return;
+
+        if (Record *record = beginRecord(level)) {
+            auto result = std::format_to_n(record->text, MAX_MESSAGE, formatString, std::forward<Args>(args)...);
+            record->length = static_cast<uint32_t>(std::min<size_t>(result.size, MAX_MESSAGE));
+            commitRecord(record);
+        }
     }
 
+    // Blocks until everything logged so far has been written.
+    void flush();
+
+    uint64_t getDroppedRecords() const { return dropped.load(std::memory_order_relaxed); }
+
 private:
-    std::string getCurrentTime();
+    static std::shared_ptr<Log> coreLogger;
+    std::atomic<LogLevel> logLevel = LogLevel::Trace;
 
-    constexpr std::string getLogLevelString(LogLevel level);
+    std::unique_ptr<Record[]> records;
+    std::atomic<uint64_t> enqueuePosition{0};
+    uint64_t dequeuePosition = 0; // writer thread only
+    std::atomic<uint64_t> dropped{0};
+
+    std::thread writer;
+    std::mutex writerMutex;
+    std::condition_variable writerCondition;
+    std::condition_variable flushCondition;
+    std::atomic<bool> writerIdle{false};
+    std::atomic<uint64_t> writtenPosition{0};
+    bool stopping = false;
 
-    void applyColor(LogLevel level);
+    std::FILE *file = nullptr;
+    LogFormat fileFormat = LogFormat::Text;
 
-    void resetColor();
+    bool isEnabled(LogLevel level) const {
+        return level >= logLevel.load(std::memory_order_relaxed) || level == LogLevel::Message;
+    }
+
+    Record *beginRecord(LogLevel level);
+
+    void commitRecord(Record *record);
+
+    void writerLoop();
+
+    static uint64_t now();
+
+    void writeRecord(std::string &consoleBatch, std::string &fileBatch, LogLevel level, uint64_t timestamp, std::string_view text);
+
+    void writeText(std::string &batch, LogLevel level, uint64_t timestamp, std::string_view text, bool colored);
+
+    void writeBinary(std::string &batch, LogLevel level, uint64_t timestamp, std::string_view text);
+
+    std::string getCurrentTime(uint64_t timestamp);
+
+    constexpr std::string getLogLevelString(LogLevel level);
+
+    static const char *getColor(LogLevel level);
 };
 
+// Fatal is never filtered, it terminates the process.
 #define AT_FATAL(...) { ::Log::getCoreLogger()->log(LogLevel::Fatal, __VA_ARGS__); }
+
+#if AT_LOG_MIN_LEVEL <= 3
 #define AT_ERROR(...) { ::Log::getCoreLogger()->log(LogLevel::Error, __VA_ARGS__); }
+#else
+#define AT_ERROR(...) {}
+#endif
+
+#if AT_LOG_MIN_LEVEL <= 2
 #define AT_WARN(...)  { ::Log::getCoreLogger()->log(LogLevel::Warn, __VA_ARGS__); }
+#else
+#define AT_WARN(...)  {}
+#endif
+
+#if AT_LOG_MIN_LEVEL <= 1
 #define AT_INFO(...)  { ::Log::getCoreLogger()->log(LogLevel::Info, __VA_ARGS__); }
+#else
+#define AT_INFO(...)  {}
+#endif
+
+#if AT_LOG_MIN_LEVEL <= 0
 #define AT_TRACE(...) { ::Log::getCoreLogger()->log(LogLevel::Trace, __VA_ARGS__); }
+#else
+#define AT_TRACE(...) {}
+#endif
+
 #define AT_MESSAGE(...) { ::Log::getCoreLogger()->log(LogLevel::Message, __VA_ARGS__); }
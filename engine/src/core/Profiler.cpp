@@ -0,0 +1,179 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::array<ProfileEvent, Profiler::RING_CAPACITY> events{};
+        std::atomic<uint64_t> head{0}; // written by the owning thread
+        std::atomic<uint64_t> tail{0}; // written by collect()
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    struct Zone {
+        std::vector<uint64_t> samples;
+        size_t next = 0;
+        uint64_t count = 0;
+    };
+
+    struct TraceEvent {
+        ProfileEvent event;
+        uint32_t threadId;
+    };
+
+    struct ProfilerState {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        uint32_t nextThreadId = 0;
+
+        std::unordered_map<std::string_view, Zone> zones;
+        std::vector<TraceEvent> trace;
+        size_t traceNext = 0;
+    };
+
+    ProfilerState &state() {
+        static ProfilerState instance;
+        return instance;
+    }
+
+    const auto epoch = std::chrono::steady_clock::now();
+
+    thread_local std::shared_ptr<ThreadBuffer> threadBuffer;
+
+    // The buffer is shared with the registry so events of a finished thread can still be collected.
+    ThreadBuffer &localBuffer() {
+        if (!threadBuffer) {
+            auto buffer = std::make_shared<ThreadBuffer>();
+
+            auto &profiler = state();
+            std::lock_guard<std::mutex> lock(profiler.mutex);
+            buffer->threadId = profiler.nextThreadId++;
+            profiler.buffers.push_back(buffer);
+            threadBuffer = std::move(buffer);
+        }
+        return *threadBuffer;
+    }
+
+    double percentile(std::vector<uint64_t> &sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        const auto index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[index]) / 1e6;
+    }
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(const char *name, uint64_t start, uint64_t end) {
+    auto &buffer = localBuffer();
+
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= RING_CAPACITY) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[head & (RING_CAPACITY - 1)] = {name, start, end - start};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::collect() {
+    auto &profiler = state();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+
+    if (profiler.trace.empty()) {
+        profiler.trace.resize(TRACE_CAPACITY);
+    }
+
+    for (const auto &buffer: profiler.buffers) {
+        const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+
+        for (uint64_t i = tail; i < head; ++i) {
+            const auto &event = buffer->events[i & (RING_CAPACITY - 1)];
+
+            auto &zone = profiler.zones[event.name];
+            if (zone.samples.size() < ZONE_WINDOW) {
+                zone.samples.push_back(event.duration);
+            } else {
+                zone.samples[zone.next] = event.duration;
+            }
+            zone.next = (zone.next + 1) % ZONE_WINDOW;
+            ++zone.count;
+
+            profiler.trace[profiler.traceNext % TRACE_CAPACITY] = {event, buffer->threadId};
+            ++profiler.traceNext;
+        }
+
+        buffer->tail.store(head, std::memory_order_release);
+    }
+}
+
+std::vector<ProfileZoneStats> Profiler::getZoneStats() {
+    auto &profiler = state();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+
+    std::vector<ProfileZoneStats> stats;
+    stats.reserve(profiler.zones.size());
+
+    std::vector<uint64_t> sorted;
+    for (const auto &[name, zone]: profiler.zones) {
+        sorted = zone.samples;
+        std::ranges::sort(sorted);
+
+        stats.push_back({
+            std::string(name),
+            zone.count,
+            percentile(sorted, 0.50),
+            percentile(sorted, 0.95),
+            percentile(sorted, 0.99),
+            percentile(sorted, 1.0)
+        });
+    }
+
+    std::ranges::sort(stats, {}, &ProfileZoneStats::name);
+    return stats;
+}
+
+std::string Profiler::exportChromeTrace() {
+    auto &profiler = state();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+
+    nlohmann::json events = nlohmann::json::array();
+
+    const size_t count = std::min(profiler.traceNext, TRACE_CAPACITY);
+    for (size_t i = profiler.traceNext - count; i < profiler.traceNext; ++i) {
+        const auto &[event, threadId] = profiler.trace[i % TRACE_CAPACITY];
+        events.push_back({
+            {"name", event.name},
+            {"ph", "X"},
+            {"ts", static_cast<double>(event.start) / 1e3},
+            {"dur", static_cast<double>(event.duration) / 1e3},
+            {"pid", 0},
+            {"tid", threadId}
+        });
+    }
+
+    return nlohmann::json{{"traceEvents", events}, {"displayTimeUnit", "ms"}}.dump();
+}
+
+uint64_t Profiler::getDroppedEvents() {
+    auto &profiler = state();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+
+    uint64_t dropped = 0;
+    for (const auto &buffer: profiler.buffers) {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
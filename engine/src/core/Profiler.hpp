@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ProfileEvent {
+    const char *name;
+    uint64_t start;    // nanoseconds since the profiler started
+    uint64_t duration; // nanoseconds
+};
+
+struct ProfileZoneStats {
+    std::string name;
+    uint64_t count;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    double maxMs;
+};
+
+/**
+ * Scoped zone profiler. Every thread writes its finished zones into its own single producer ring,
+ * collect() drains all rings into rolling per-zone windows and a bounded trace buffer.
+ *
+ * Zones are recorded through AT_PROFILE_SCOPE, which compiles to nothing unless
+ * ATLAS_ENABLE_PROFILING is defined.
+ */
+class Profiler {
+public:
+    static constexpr size_t RING_CAPACITY = 4096;   // per thread, power of two
+    static constexpr size_t ZONE_WINDOW = 1024;     // samples kept per zone for the percentiles
+    static constexpr size_t TRACE_CAPACITY = 65536; // most recent events kept for the trace export
+
+    static uint64_t now();
+
+    // Called by the owning thread only, never blocks. Drops the event when the ring is full.
+    static void record(const char *name, uint64_t start, uint64_t end);
+
+    // Drains every thread ring. Safe to call from any thread.
+    static void collect();
+
+    static std::vector<ProfileZoneStats> getZoneStats();
+
+    // Chrome trace event JSON, loadable in chrome://tracing or Perfetto.
+    static std::string exportChromeTrace();
+
+    static uint64_t getDroppedEvents();
+};
+
+class ProfileScope {
+public:
+    // name must outlive the profiler, in practice a string literal
+    explicit ProfileScope(const char *name) : name(name), start(Profiler::now()) {}
+
+    ~ProfileScope() { Profiler::record(name, start, Profiler::now()); }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name;
+    uint64_t start;
+};
+
+// Sums the many short intervals of one phase of a per-entity loop and records them as a single zone
+// starting where the phase began, so the zone costs one event per tick instead of one per entity.
+class ProfilePhase {
+public:
+    explicit ProfilePhase(const char *name) : name(name), start(Profiler::now()) {}
+
+    ~ProfilePhase() { Profiler::record(name, start, start + total); }
+
+    ProfilePhase(const ProfilePhase &) = delete;
+    ProfilePhase &operator=(const ProfilePhase &) = delete;
+
+    void add(uint64_t duration) { total += duration; }
+
+private:
+    const char *name;
+    uint64_t start;
+    uint64_t total = 0;
+};
+
+class ProfilePhaseScope {
+public:
+    explicit ProfilePhaseScope(ProfilePhase &phase) : phase(phase), start(Profiler::now()) {}
+
+    ~ProfilePhaseScope() { phase.add(Profiler::now() - start); }
+
+    ProfilePhaseScope(const ProfilePhaseScope &) = delete;
+    ProfilePhaseScope &operator=(const ProfilePhaseScope &) = delete;
+
+private:
+    ProfilePhase &phase;
+    uint64_t start;
+};
+
+#ifdef ATLAS_ENABLE_PROFILING
+#define AT_PROFILE_CONCAT_INNER(a, b) a##b
+#define AT_PROFILE_CONCAT(a, b) AT_PROFILE_CONCAT_INNER(a, b)
+#define AT_PROFILE_SCOPE(name) ::ProfileScope AT_PROFILE_CONCAT(atProfileScope, __LINE__)(name)
+#define AT_PROFILE_PHASE(phase, name) ::ProfilePhase phase(name)
+#define AT_PROFILE_PHASE_SCOPE(phase) ::ProfilePhaseScope AT_PROFILE_CONCAT(atProfilePhase, __LINE__)(phase)
+#else
+#define AT_PROFILE_SCOPE(name)
+#define AT_PROFILE_PHASE(phase, name)
+#define AT_PROFILE_PHASE_SCOPE(phase)
+#endif
@@ -2,21 +2,35 @@
 
 #include <cstdint>
 #include <nlohmann/json.hpp> // Ensure this is properly installed via vcpkg or any other package manager
-#include "Registry.hpp"
 #include "ECSException.hpp"
 
 class Registry;
 using Json = nlohmann::json;
 
+/**
+ * Handle to an entity of a Registry. The id packs the entity's slot index with the generation of the
+ * slot, a destroyed entity's slot is reused with the next generation so an old handle to it no longer
+ * matches. Id 0 is never handed out.
+ */
 class Actor {
 public:
     using IdType = std::uint32_t;
 
+    static constexpr IdType INDEX_BITS = 22; // 4M entities alive at once
+    static constexpr IdType INDEX_MASK = (IdType{1} << INDEX_BITS) - 1;
+    static constexpr IdType GENERATION_MASK = ~IdType{0} >> INDEX_BITS;
+
     Actor() = default;
     explicit Actor(IdType id, Registry* registry = nullptr)
         : id(id), registry(registry) {}
 
+    static constexpr IdType makeId(IdType index, IdType generation) {
+        return (generation & GENERATION_MASK) << INDEX_BITS | (index & INDEX_MASK);
+    }
+
     [[nodiscard]] IdType getId() const { return id; }
+    [[nodiscard]] IdType getIndex() const { return id & INDEX_MASK; }
+    [[nodiscard]] IdType getGeneration() const { return id >> INDEX_BITS; }
     [[nodiscard]] bool isValid() const { return id != 0; }
     [[nodiscard]] Registry* getRegistry() const { return registry; }
 
@@ -46,28 +60,6 @@ private:
     friend class Registry; // Allows the Registry class to access private members
 };
 
-// Template implementations
-template<typename T>
-bool Actor::hasComponent() const {
-    return registry && registry->template getComponent<T>(*this) != nullptr;
-}
-
-template<typename T>
-T* Actor::getComponent() {
-    return registry ? registry->template getComponent<T>(*this) : nullptr;
-}
-
-template<typename T, typename... Args>
-T& Actor::addComponent(Args&&... args) {
-    if (!registry) throw ECSException("Actor has no registry");
-    return registry->template addComponent<T>(*this, std::forward<Args>(args)...);
-}
-
-template<typename T>
-void Actor::removeComponent() {
-    if (registry) registry->template removeComponent<T>(*this);
-}
-
 // Serialization implementations
 inline Json Actor::toJson() const {
     Json json;
@@ -80,3 +72,5 @@ inline void Actor::fromJson(const Json& json) {
         id = json.at("id").get<IdType>();
     }
 }
+
+// The component templates need the complete Registry, they are defined at the end of Registry.hpp.
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "Actor.hpp"
+#include "ComponentType.hpp"
+
+enum class StoragePolicy {
+    SparseSet, // a pool per component type, the default
+    Chunked    // per archetype, in fixed size chunks shared with the entity's other chunked components
+};
+
+// Where a component type is stored. Specialize it with StoragePolicy::Chunked for hot components that are
+// always iterated together, e.g.
+//     template<> struct ComponentStorage<Position> { static constexpr StoragePolicy policy = StoragePolicy::Chunked; };
+template<typename T>
+struct ComponentStorage {
+    static constexpr StoragePolicy policy = StoragePolicy::SparseSet;
+};
+
+template<typename T>
+constexpr bool isChunked = ComponentStorage<T>::policy == StoragePolicy::Chunked;
+
+struct ComponentLayout {
+    std::size_t size = 0;
+    std::size_t align = 0;
+};
+
+/**
+ * Entities sharing one exact set of chunked components. Their rows are kept in CHUNK_BYTES chunks, each
+ * chunk holding one array per component plus the entity ids (structure of arrays), so a pass over some of
+ * the components reads only their tightly packed arrays. Rows are packed: every chunk but the last is full
+ * and removing a row moves the last one into its place. Components are moved as bytes, the Registry only
+ * allows trivially copyable types here.
+ */
+class Archetype {
+public:
+    static constexpr std::size_t CHUNK_BYTES = 16 * 1024;
+    static constexpr std::uint8_t NO_COLUMN = UINT8_MAX;
+
+    Archetype(const ComponentMask& mask, const std::vector<ComponentLayout>& layouts) : mask(mask) {
+        columnOf.fill(NO_COLUMN);
+
+        std::size_t rowBytes = sizeof(Actor::IdType);
+        for (std::size_t type = 0; type < MAX_COMPONENTS; ++type) {
+            if (!mask.test(type)) continue;
+            columnOf[type] = static_cast<std::uint8_t>(columns.size());
+            columns.push_back({layouts[type].size, layouts[type].align, 0});
+            rowBytes += layouts[type].size;
+        }
+
+        // as many rows as fit once every array is aligned
+        capacity = CHUNK_BYTES / rowBytes;
+        while (capacity > 1 && layout(capacity) > CHUNK_BYTES) --capacity;
+        layout(capacity);
+    }
+
+    [[nodiscard]] const ComponentMask& getMask() const { return mask; }
+    [[nodiscard]] std::size_t size() const { return count; }
+    [[nodiscard]] std::size_t getCapacity() const { return capacity; }
+    [[nodiscard]] std::size_t chunkCount() const { return (count + capacity - 1) / capacity; }
+    [[nodiscard]] std::size_t rowsIn(std::size_t chunk) const { return std::min(capacity, count - chunk * capacity); }
+    [[nodiscard]] std::uint8_t column(std::size_t type) const { return columnOf[type]; }
+
+    [[nodiscard]] const Actor::IdType* ids(std::size_t chunk) const {
+        return reinterpret_cast<const Actor::IdType*>(chunks[chunk].get());
+    }
+
+    template<typename T>
+    [[nodiscard]] T* array(std::uint8_t column, std::size_t chunk) const {
+        return reinterpret_cast<T*>(chunks[chunk].get() + columns[column].offset);
+    }
+
+    [[nodiscard]] void* component(std::uint8_t column, std::uint32_t row) const {
+        const Column& at = columns[column];
+        return chunks[row / capacity].get() + at.offset + (row % capacity) * at.size;
+    }
+
+    // Appends a row for id, its components are left for the caller to fill in.
+    std::uint32_t insert(Actor::IdType id) {
+        if (count == chunks.size() * capacity) {
+            chunks.push_back(std::make_unique<std::byte[]>(CHUNK_BYTES));
+        }
+        const auto row = static_cast<std::uint32_t>(count++);
+        idAt(row) = id;
+        return row;
+    }
+
+    // Copies the components both archetypes have from a row of other to a row of this one.
+    void copyRow(const Archetype& other, std::uint32_t otherRow, std::uint32_t row) {
+        for (std::size_t type = 0; type < MAX_COMPONENTS; ++type) {
+            if (columnOf[type] == NO_COLUMN || other.columnOf[type] == NO_COLUMN) continue;
+            std::memcpy(component(columnOf[type], row), other.component(other.columnOf[type], otherRow),
+                        columns[columnOf[type]].size);
+        }
+    }
+
+    // Removes a row, returns the id of the entity moved into it or 0 when it was the last row.
+    Actor::IdType remove(std::uint32_t row) {
+        const auto last = static_cast<std::uint32_t>(--count);
+        if (row == last) return 0;
+
+        for (std::uint8_t column = 0; column < columns.size(); ++column) {
+            std::memcpy(component(column, row), component(column, last), columns[column].size);
+        }
+        idAt(row) = idAt(last);
+        return idAt(row);
+    }
+
+    // Archetypes one component away, filled in by the Registry as entities move.
+    std::array<Archetype*, MAX_COMPONENTS> withEdges{};
+    std::array<Archetype*, MAX_COMPONENTS> withoutEdges{};
+
+private:
+    struct Column {
+        std::size_t size;
+        std::size_t align;
+        std::size_t offset; // of the column's array in a chunk
+    };
+
+    ComponentMask mask;
+    std::vector<Column> columns;
+    std::array<std::uint8_t, MAX_COMPONENTS> columnOf{}; // component type id -> column
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::size_t capacity = 1; // rows per chunk
+    std::size_t count = 0;
+
+    Actor::IdType& idAt(std::uint32_t row) {
+        return reinterpret_cast<Actor::IdType*>(chunks[row / capacity].get())[row % capacity];
+    }
+
+    // Lays the arrays out for rows per chunk, returns the bytes used. The ids come first.
+    std::size_t layout(std::size_t rows) {
+        std::size_t offset = rows * sizeof(Actor::IdType);
+        for (Column& column : columns) {
+            offset = (offset + column.align - 1) / column.align * column.align;
+            column.offset = offset;
+            offset += rows * column.size;
+        }
+        return offset;
+    }
+};
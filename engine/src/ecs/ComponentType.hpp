@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+
+constexpr std::size_t MAX_COMPONENTS = 64;
+
+// Dense ids handed out per component type on first use, they index the registry's pools and masks.
+// Systems running in parallel may ask for a new type's id at the same time.
+class ComponentTypeRegistry {
+public:
+    template<typename Component>
+    static std::size_t getId() {
+        static const std::size_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+private:
+    static inline std::atomic<std::size_t> nextId{0};
+};
+
+class ComponentMask {
+public:
+    void set(std::size_t id) {
+        mask.set(id);
+    }
+
+    void reset(std::size_t id) {
+        mask.reset(id);
+    }
+
+    [[nodiscard]] bool test(std::size_t id) const {
+        return mask.test(id);
+    }
+
+    [[nodiscard]] bool matches(const ComponentMask& other) const {
+        return (mask & other.mask) == other.mask;
+    }
+
+    [[nodiscard]] bool intersects(const ComponentMask& other) const {
+        return (mask & other.mask).any();
+    }
+
+    [[nodiscard]] bool none() const {
+        return mask.none();
+    }
+
+    bool operator==(const ComponentMask& other) const { return mask == other.mask; }
+
+private:
+    std::bitset<MAX_COMPONENTS> mask;
+};
@@ -1,81 +1,286 @@
 #pragma once
 
-#include <iostream>
-#include <functional>
-#include <unordered_map>
-#include <typeindex>
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <vector>
 #include <stdexcept>
 
+#include "utils/MpscQueue.hpp"
+
+// Optional base for events, any copyable type can be an event.
 class Event {
 public:
     virtual ~Event() = default;
 };
 
+// Dense ids handed out per event type on first use, they index the manager's channels.
+class EventTypeRegistry {
+public:
+    template<typename EventType>
+    static std::size_t getId() {
+        static const std::size_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+private:
+    static inline std::atomic<std::size_t> nextId{0};
+};
+
+/**
+ * Listener of EventType, a plain function pointer with the object it is called on. Cheap to copy and
+ * compare, the listeners of a type sit side by side in one vector.
+ */
+template<typename EventType>
+struct Delegate {
+    using Function = void (*)(void *context, const EventType &event);
+
+    Function function = nullptr;
+    void *context = nullptr;
+
+    void operator()(const EventType &event) const { function(context, event); }
+
+    bool operator==(const Delegate &other) const {
+        return function == other.function && context == other.context;
+    }
+};
+
+/**
+ * Event bus. Every event type has its own channel, found by the type's id in a fixed array, holding its
+ * listeners and its pending events. Events are delivered three ways:
+ *   emit     right away, to every listener in subscription order
+ *   enqueue  kept until update(), which delivers the frame's events in batches per type
+ *   post     like enqueue but from any thread, through a bounded lock-free queue
+ *
+ * Listeners are functions, member functions bound to an object, or callables passed by reference; the
+ * manager stores no callable of its own, the caller keeps objects alive until they unsubscribe. Listeners
+ * must not unsubscribe while an event of their type is being delivered. Except for post, which may run
+ * anywhere, the manager belongs to one thread. Once a type's channel has grown, nothing allocates.
+ */
 class EventManager {
 public:
-    // Emit an event of type `EventType` to all subscribed listeners
+    static constexpr std::size_t MAX_EVENT_TYPES = 256;
+    static constexpr std::size_t POSTED_CAPACITY = 1024; // per event type, posts are refused past it
+
+    EventManager() = default;
+    EventManager(const EventManager &) = delete;
+    EventManager &operator=(const EventManager &) = delete;
+
+    ~EventManager() {
+        for (auto &channel : channels) {
+            delete channel.load(std::memory_order_acquire);
+        }
+    }
+
+    // Delivers event to all subscribed listeners before returning.
     template<typename EventType>
     void emit(const EventType& event) const {
-        auto it = listeners.find(typeid(EventType));
-        if (it != listeners.end()) {
-            for (const auto& listener : it->second) {
-                listener->handle(event);
+        if (const Channel<EventType>* channel = find<EventType>()) {
+            channel->publish(event);
+        }
+    }
+
+    // Keeps a copy of event until the next update().
+    template<typename EventType>
+    void enqueue(const EventType& event) {
+        channel<EventType>().queued.push_back(event);
+    }
+
+    // enqueue() for any thread, for default constructible events. Returns false when the type's queue is
+    // full.
+    template<typename EventType>
+    bool post(const EventType& event) {
+        return channel<EventType>().postedQueue().push(event);
+    }
+
+    // Delivers the events enqueued and posted since the last update, type by type. An event a listener
+    // enqueues for a type whose batch already went out waits for the next update.
+    void update() {
+        const std::size_t count = channelCount.load(std::memory_order_acquire);
+        for (std::size_t id = 0; id < count; ++id) {
+            if (ChannelBase* channel = channels[id].load(std::memory_order_acquire)) {
+                channel->flush();
             }
         }
     }
 
-    // Subscribe a callback to an event of type `EventType`
+    // update() for a single event type.
     template<typename EventType>
-    void subscribe(std::function<void(const EventType&)> callback) {
-        auto& listenersForType = listeners[typeid(EventType)];
-        listenersForType.emplace_back(std::make_unique<ConcreteListener<EventType>>(std::move(callback)));
+    void update() {
+        if (Channel<EventType>* channel = find<EventType>()) {
+            channel->flush();
+        }
+    }
+
+    // Subscribe a function, subscribe<Damaged, &onDamaged>()
+    template<typename EventType, auto Function>
+    void subscribe() {
+        channel<EventType>().delegates.push_back(functionDelegate<EventType, Function>());
+    }
+
+    // Subscribe a member function of instance, subscribe<Damaged, &Hud::onDamaged>(hud)
+    template<typename EventType, auto Method, typename Class>
+    void subscribe(Class& instance) {
+        channel<EventType>().delegates.push_back(methodDelegate<EventType, Method>(instance));
+    }
+
+    // Subscribe a callable by reference, it has to outlive the subscription
+    template<typename EventType, typename Callable>
+    void subscribe(Callable& callable) {
+        channel<EventType>().delegates.push_back(callableDelegate<EventType>(callable));
+    }
+
+    template<typename EventType, auto Function>
+    void unsubscribe() {
+        remove<EventType>(functionDelegate<EventType, Function>());
+    }
+
+    template<typename EventType, auto Method, typename Class>
+    void unsubscribe(Class& instance) {
+        remove<EventType>(methodDelegate<EventType, Method>(instance));
+    }
+
+    template<typename EventType, typename Callable>
+    void unsubscribe(Callable& callable) {
+        remove<EventType>(callableDelegate<EventType>(callable));
     }
 
     // Unsubscribe all callbacks for a specific event type
     template<typename EventType>
     void unsubscribeAll() {
-        listeners.erase(typeid(EventType));
+        if (Channel<EventType>* channel = find<EventType>()) {
+            channel->delegates.clear();
+        }
     }
 
-    // Clear all event listeners
+    // Clear all event listeners and pending events
     void clear() {
-        listeners.clear();
+        const std::size_t count = channelCount.load(std::memory_order_acquire);
+        for (std::size_t id = 0; id < count; ++id) {
+            if (ChannelBase* channel = channels[id].load(std::memory_order_acquire)) {
+                channel->clear();
+            }
+        }
     }
 
     // Check if there are listeners for a specific event type
     template<typename EventType>
     bool hasListeners() const {
-        auto it = listeners.find(typeid(EventType));
-        return it != listeners.end() && !it->second.empty();
+        const Channel<EventType>* channel = find<EventType>();
+        return channel && !channel->delegates.empty();
     }
 
 private:
-    // Interface for a generic listener
-    struct IListener {
-        virtual ~IListener() = default;
-        virtual void handle(const Event& event) const = 0;
+    struct ChannelBase {
+        virtual ~ChannelBase() = default;
+        virtual void flush() = 0;
+        virtual void clear() = 0;
     };
 
-    // Concrete listener implementation for a specific event type
     template<typename EventType>
-    struct ConcreteListener : IListener {
-        explicit ConcreteListener(std::function<void(const EventType&)> cb)
-            : callback(std::move(cb)) {}
-
-        void handle(const Event& event) const override {
-            try {
-                callback(static_cast<const EventType&>(event));
-            } catch (const std::bad_cast&) {
-                throw std::runtime_error("Event type mismatch during handling.");
+    struct Channel : ChannelBase {
+        using PostedQueue = MpscQueue<EventType, POSTED_CAPACITY>;
+
+        std::vector<Delegate<EventType>> delegates;
+        std::vector<EventType> queued;
+        std::vector<EventType> delivering; // the batch of the running flush, swapped with queued
+        std::atomic<PostedQueue*> posted{nullptr}; // created by the first post
+
+        ~Channel() override {
+            delete posted.load(std::memory_order_acquire);
+        }
+
+        PostedQueue& postedQueue() {
+            PostedQueue* existing = posted.load(std::memory_order_acquire);
+            if (existing) return *existing;
+
+            auto created = std::make_unique<PostedQueue>();
+            if (posted.compare_exchange_strong(existing, created.get(), std::memory_order_acq_rel)) {
+                return *created.release();
             }
+            return *existing;
         }
 
-    private:
-        std::function<void(const EventType&)> callback;
+        // Listeners subscribed by a listener are called for this event as well.
+        void publish(const EventType& event) const {
+            for (std::size_t i = 0; i < delegates.size(); ++i) {
+                delegates[i](event);
+            }
+        }
+
+        void flush() override {
+            delivering.swap(queued);
+            for (const EventType& event : delivering) {
+                publish(event);
+            }
+            delivering.clear();
+
+            if (PostedQueue* queue = posted.load(std::memory_order_acquire)) {
+                queue->drain([this](const EventType& event) { publish(event); });
+            }
+        }
+
+        void clear() override {
+            delegates.clear();
+            queued.clear();
+            if (PostedQueue* queue = posted.load(std::memory_order_acquire)) {
+                queue->drain([](const EventType&) {});
+            }
+        }
     };
 
-    // Mapping of event types to their associated listeners
-    std::unordered_map<std::type_index, std::vector<std::unique_ptr<IListener>>> listeners;
+    std::array<std::atomic<ChannelBase*>, MAX_EVENT_TYPES> channels{};
+    std::atomic<std::size_t> channelCount{0}; // one past the highest id with a channel
+
+    template<typename EventType>
+    Channel<EventType>* find() const {
+        const std::size_t id = EventTypeRegistry::getId<EventType>();
+        if (id >= MAX_EVENT_TYPES) return nullptr;
+        return static_cast<Channel<EventType>*>(channels[id].load(std::memory_order_acquire));
+    }
+
+    // The type's channel, created on first use. Posting threads may race to create it, one of them wins.
+    template<typename EventType>
+    Channel<EventType>& channel() {
+        const std::size_t id = EventTypeRegistry::getId<EventType>();
+        if (id >= MAX_EVENT_TYPES) {
+            throw std::runtime_error("More than MAX_EVENT_TYPES event types");
+        }
+
+        ChannelBase* existing = channels[id].load(std::memory_order_acquire);
+        if (existing) return static_cast<Channel<EventType>&>(*existing);
+
+        auto created = std::make_unique<Channel<EventType>>();
+        if (channels[id].compare_exchange_strong(existing, created.get(), std::memory_order_acq_rel)) {
+            std::size_t count = channelCount.load(std::memory_order_relaxed);
+            while (count < id + 1 && !channelCount.compare_exchange_weak(count, id + 1, std::memory_order_acq_rel)) {}
+            return *created.release();
+        }
+        return static_cast<Channel<EventType>&>(*existing);
+    }
+
+    template<typename EventType>
+    void remove(const Delegate<EventType>& delegate) {
+        if (Channel<EventType>* channel = find<EventType>()) {
+            std::erase(channel->delegates, delegate);
+        }
+    }
+
+    template<typename EventType, auto Function>
+    static Delegate<EventType> functionDelegate() {
+        return {[](void*, const EventType& event) { Function(event); }, nullptr};
+    }
+
+    template<typename EventType, auto Method, typename Class>
+    static Delegate<EventType> methodDelegate(Class& instance) {
+        return {[](void* context, const EventType& event) { (static_cast<Class*>(context)->*Method)(event); },
+                const_cast<void*>(static_cast<const void*>(&instance))};
+    }
+
+    template<typename EventType, typename Callable>
+    static Delegate<EventType> callableDelegate(Callable& callable) {
+        return {[](void* context, const EventType& event) { (*static_cast<Callable*>(context))(event); },
+                const_cast<void*>(static_cast<const void*>(&callable))};
+    }
 };
@@ -1,149 +1,296 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <vector>
-#include <unordered_map>
-#include <typeindex>
-#include <queue>
-#include <bitset>
-#include <iostream>
+#include <stdexcept>
 #include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include "Actor.hpp"
-
-constexpr std::size_t MAX_COMPONENTS = 64;
-
-class ComponentTypeRegistry {
-public:
-    template<typename Component>
-    static std::size_t getId() {
-        static const std::size_t id = nextId++;
-        return id;
-    }
-
-private:
-    static inline std::size_t nextId = 0;
-};
-
-class ComponentMask {
-public:
-    void set(std::size_t id) {
-        mask.set(id);
-    }
-
-    void reset(std::size_t id) {
-        mask.reset(id);
-    }
-
-    [[nodiscard]] bool matches(const ComponentMask& other) const {
-        return (mask & other.mask) == other.mask;
-    }
-
-private:
-    std::bitset<MAX_COMPONENTS> mask;
-};
-
+#include "ComponentType.hpp"
+#include "SparseSet.hpp"
+#include "Archetype.hpp"
+#include "utils/ExecutorService.hpp"
+
+/**
+ * Entities and their components. Components of a type live packed in a sparse set pool, so lookups,
+ * adds and removes are O(1) and never hash. Entity slots are indices into flat vectors and are reused
+ * LIFO once freed; the slot's generation goes up on every destroy so old Actor handles stop resolving.
+ *
+ * Component types with the Chunked storage policy (see ComponentStorage) live in archetype chunks
+ * instead, read with chunks<...>(). Adding or removing one moves the entity's chunked components to
+ * the archetype of its new set.
+ */
 class Registry {
 public:
-    template<typename... Components>
-    friend class View;
-
     Registry() = default;
 
     Actor createEntity() {
-        Actor::IdType id = (freeIds.empty()) ? nextEntityId++ : freeIds.front();
-        if (!freeIds.empty()) freeIds.pop();
+        Actor::IdType index;
+        if (!freeIndices.empty()) {
+            index = freeIndices.back();
+            freeIndices.pop_back();
+            slots[index] = Actor::makeId(index, slots[index] >> Actor::INDEX_BITS);
+        } else {
+            if (slots.size() == Actor::INDEX_MASK) {
+                throw ECSException("Registry is out of entity slots");
+            }
+            index = static_cast<Actor::IdType>(slots.size());
+            slots.push_back(Actor::makeId(index, 0));
+            masks.emplace_back();
+            chunkRows.emplace_back();
+        }
 
-        Actor actor(id, this);
-        entities.push_back(actor);
-        entityMasks[id] = ComponentMask();
-        std::cout << "Created entity: " << id << std::endl;
-        return actor;
+        return Actor(slots[index], this);
     }
 
     void destroyEntity(Actor entity) {
-        if (!entity.isValid() || entity.getRegistry() != this) {
+        if (!entity.isValid() || entity.getRegistry() != this || !valid(entity)) {
             throw std::runtime_error("Invalid entity or entity does not belong to this registry.");
         }
 
-        for (auto& [type, map] : components) {
-            map->remove(entity.getId());
+        const Actor::IdType index = entity.getIndex();
+        for (std::size_t type = 0; type < pools.size(); ++type) {
+            if (masks[index].test(type) && pools[type]) pools[type]->remove(entity.getId());
+        }
+        if (chunkRows[index].archetype) {
+            moveRow(entity.getId(), nullptr);
         }
 
-        entityMasks.erase(entity.getId());
-        freeIds.push(entity.getId());
-        std::erase_if(entities, [entity](const Actor& e) { return e == entity; });
+        // the index part points nowhere until the slot is reused with the next generation
+        masks[index] = ComponentMask();
+        slots[index] = Actor::makeId(Actor::INDEX_MASK, entity.getGeneration() + 1);
+        freeIndices.push_back(index);
+    }
+
+    // False for handles of destroyed entities, even once their slot is in use again.
+    [[nodiscard]] bool valid(Actor entity) const {
+        const Actor::IdType index = entity.getIndex();
+        return index != 0 && index < slots.size() && slots[index] == entity.getId();
+    }
+
+    // Entities alive right now.
+    [[nodiscard]] std::size_t size() const {
+        return slots.size() - 1 - freeIndices.size();
+    }
+
+    // Creates the pools of Components up front. Views create missing pools, which must not happen while
+    // systems run in parallel, the Scheduler calls this for every declared component before a frame.
+    template<typename... Components>
+    void ensurePools() {
+        (ensurePool<Components>(), ...);
+    }
+
+    // Whether a live entity has every one of Components.
+    template<typename... Components>
+    [[nodiscard]] bool allOf(Actor entity) const {
+        if (!valid(entity)) return false;
 
-        std::cout << "Destroyed entity: " << entity.getId() << std::endl;
+        const ComponentMask& mask = masks[entity.getIndex()];
+        return (mask.test(ComponentTypeRegistry::getId<Components>()) && ...);
     }
 
     template<typename T>
     T* getComponent(Actor entity) {
-        auto& map = getComponentMap<T>();
-        return map.get(entity.getId());
+        const std::size_t type = ComponentTypeRegistry::getId<T>();
+        if constexpr (isChunked<T>) {
+            if (!valid(entity)) return nullptr;
+
+            const ChunkRow& location = chunkRows[entity.getIndex()];
+            if (!location.archetype || location.archetype->column(type) == Archetype::NO_COLUMN) return nullptr;
+            return static_cast<T*>(location.archetype->component(location.archetype->column(type), location.row));
+        } else {
+            if (type >= pools.size() || !pools[type]) return nullptr;
+            return static_cast<ComponentPool<T>&>(*pools[type]).get(entity.getId());
+        }
     }
 
     template<typename T, typename... Args>
     T& addComponent(Actor entity, Args&&... args) {
-        auto& map = getComponentMap<T>();
-        auto& component = map.add(entity.getId(), T(std::forward<Args>(args)...));
-        entityMasks[entity.getId()].set(ComponentTypeRegistry::getId<T>());
-        return component;
+        if (!valid(entity)) {
+            throw ECSException("Cannot add a component to an entity that is not alive");
+        }
+
+        const std::size_t type = ComponentTypeRegistry::getId<T>();
+        if constexpr (isChunked<T>) {
+            if (T* existing = getComponent<T>(entity)) {
+                *existing = T(std::forward<Args>(args)...);
+                return *existing;
+            }
+
+            T component(std::forward<Args>(args)...);
+            registerLayout<T>(type);
+            Archetype* to = neighbour(chunkRows[entity.getIndex()].archetype, type, true);
+            moveRow(entity.getId(), to);
+            masks[entity.getIndex()].set(type);
+
+            const ChunkRow& location = chunkRows[entity.getIndex()];
+            return *new(location.archetype->component(to->column(type), location.row)) T(component);
+        } else {
+            auto& component = getPool<T>().emplace(entity.getId(), std::forward<Args>(args)...);
+            masks[entity.getIndex()].set(type);
+            return component;
+        }
     }
 
     template<typename T>
     void removeComponent(Actor entity) {
-        auto& map = getComponentMap<T>();
-        map.remove(entity.getId());
-        entityMasks[entity.getId()].reset(ComponentTypeRegistry::getId<T>());
+        if (!valid(entity)) return;
+
+        const std::size_t type = ComponentTypeRegistry::getId<T>();
+        if constexpr (isChunked<T>) {
+            Archetype* from = chunkRows[entity.getIndex()].archetype;
+            if (!from || from->column(type) == Archetype::NO_COLUMN) return;
+            moveRow(entity.getId(), neighbour(from, type, false));
+        } else {
+            getPool<T>().remove(entity.getId());
+        }
+        masks[entity.getIndex()].reset(type);
     }
 
+    /**
+     * Entities that have all of Components. Iteration walks the smallest of their pools and looks the
+     * entity up in the others, yielding (Actor, Components&...) tuples. It runs back to front, so
+     * destroying the current entity or removing one of its components inside the loop is safe.
+     */
     template<typename... Components>
     class View {
+        static_assert(sizeof...(Components) > 0, "A view needs at least one component");
+        static_assert((!isChunked<Components> && ...), "Chunked components are read with Registry::chunks");
+
+        using Pools = std::tuple<ComponentPool<Components>*...>;
+        using Positions = std::array<std::uint32_t, sizeof...(Components)>;
+        using Indices = std::index_sequence_for<Components...>;
+
     public:
-        explicit View(Registry& registry) : registry(registry) {
-            (componentMask.set(ComponentTypeRegistry::getId<Components>()), ...);
+        explicit View(Registry& registry)
+            : registry(&registry), pools(&registry.template getPool<Components>()...) {
+            driver = std::get<0>(pools);
+            std::apply([this](auto*... pool) {
+                ((pool->size() < driver->size() ? driver = pool : driver), ...);
+            }, pools);
         }
 
         class Iterator {
         public:
-            Iterator(Registry& registry, std::size_t index, const ComponentMask& mask)
-                : registry(registry), currentIndex(index), componentMask(mask) {
+            Iterator(const View& view, std::size_t remaining)
+                : view(&view), remaining(remaining) {
                 skipToValidEntity();
             }
 
             Iterator& operator++() {
-                ++currentIndex;
+                --remaining;
                 skipToValidEntity();
                 return *this;
             }
 
-            Actor operator*() const {
-                return registry.entities[currentIndex];
+            std::tuple<Actor, Components&...> operator*() const {
+                const Actor::IdType id = view->driver->entities()[remaining - 1];
+                return view->components(Actor(id, view->registry), positions, Indices{});
             }
 
             bool operator!=(const Iterator& other) const {
-                return currentIndex != other.currentIndex;
+                return remaining != other.remaining;
             }
 
         private:
-            Registry& registry;
-            std::size_t currentIndex;
-            ComponentMask componentMask;
+            const View* view;
+            std::size_t remaining; // the entity is at remaining - 1 in the driving pool
+            Positions positions{};
 
             void skipToValidEntity() {
-                while (currentIndex < registry.entities.size() &&
-                       !registry.entityMasks[registry.entities[currentIndex].getId()].matches(componentMask)) {
-                    ++currentIndex;
+                while (remaining > 0 && !view->locate(static_cast<std::uint32_t>(remaining - 1), positions, Indices{})) {
+                    --remaining;
                 }
             }
         };
 
-        Iterator begin() { return Iterator(registry, 0, componentMask); }
-        Iterator end() { return Iterator(registry, registry.entities.size(), componentMask); }
+        Iterator begin() const { return Iterator(*this, driver->size()); }
+        Iterator end() const { return Iterator(*this, 0); }
+
+        // Calls func(Components&...) or func(Actor, Components&...) for every entity. A single component
+        // view runs over its packed array, a loop the compiler can vectorize.
+        template<typename Func>
+        void each(Func func) const {
+            eachIn(0, driver->size(), func);
+        }
+
+        // each() with the driving pool split in chunks of grain entities that run on the executor, returns
+        // once all are done. func runs concurrently for different entities and must only touch its own.
+        template<typename Func>
+        void parallelEach(ExecutorService& executor, Func func, std::size_t grain = PARALLEL_GRAIN) const {
+            const std::size_t size = driver->size();
+            grain = std::max<std::size_t>(grain, 1);
+            if (size <= grain) {
+                eachIn(0, size, func);
+                return;
+            }
+
+            WaitGroup group;
+            for (std::size_t begin = 0; begin < size; begin += grain) {
+                const std::size_t end = std::min(begin + grain, size);
+                executor.execute([this, &func, begin, end]() { eachIn(begin, end, func); }, group);
+            }
+            executor.wait(group);
+        }
+
+        // Upper bound of the entities the view yields, the size of its smallest pool.
+        [[nodiscard]] std::size_t sizeHint() const { return driver->size(); }
 
     private:
-        Registry& registry;
-        ComponentMask componentMask;
+        static constexpr std::size_t PARALLEL_GRAIN = 16384;
+
+        Registry* registry;
+        Pools pools;
+        const SparseSet* driver = nullptr;
+
+        // each() over the entities at [begin, end) of the driving pool.
+        template<typename Func>
+        void eachIn(std::size_t begin, std::size_t end, Func& func) const {
+            if constexpr (sizeof...(Components) == 1) {
+                auto* pool = std::get<0>(pools);
+                auto* components = pool->data();
+                const Actor::IdType* ids = pool->entities().data();
+                // back to front like the other paths, a removal swaps the last entity into the current slot
+                for (std::size_t i = end; i > begin; --i) {
+                    if constexpr (std::is_invocable_v<Func&, Components&...>) {
+                        func(components[i - 1]);
+                    } else {
+                        func(Actor(ids[i - 1], registry), components[i - 1]);
+                    }
+                }
+            } else {
+                Positions positions{};
+                for (std::size_t i = end; i > begin; --i) {
+                    if (!locate(static_cast<std::uint32_t>(i - 1), positions, Indices{})) continue;
+
+                    if constexpr (std::is_invocable_v<Func&, Components&...>) {
+                        std::apply(func, components(positions, Indices{}));
+                    } else {
+                        std::apply(func, components(Actor(driver->entities()[i - 1], registry), positions, Indices{}));
+                    }
+                }
+            }
+        }
+
+        // Finds the driving pool's entity at position in every pool, false if one of them lacks it.
+        template<std::size_t... I>
+        bool locate(std::uint32_t position, Positions& positions, std::index_sequence<I...>) const {
+            const Actor::IdType id = driver->entities()[position];
+            return (((positions[I] = std::get<I>(pools)->find(id, position)) != SparseSet::NONE) && ...);
+        }
+
+        template<std::size_t... I>
+        std::tuple<Components&...> components(const Positions& positions, std::index_sequence<I...>) const {
+            return std::tuple<Components&...>(std::get<I>(pools)->data()[positions[I]]...);
+        }
+
+        template<std::size_t... I>
+        std::tuple<Actor, Components&...> components(Actor actor, const Positions& positions, std::index_sequence<I...>) const {
+            return std::tuple<Actor, Components&...>(actor, std::get<I>(pools)->data()[positions[I]]...);
+        }
     };
 
     template<typename... Components>
@@ -151,43 +298,173 @@ public:
         return View<Components...>(*this);
     }
 
+    /**
+     * Entities that have all of the chunked Components, read chunk by chunk from every archetype holding
+     * them. No entity may be created, destroyed or change its chunked components during the pass.
+     */
+    template<typename... Components>
+    class ChunkView {
+        static_assert(sizeof...(Components) > 0, "A view needs at least one component");
+        static_assert((isChunked<Components> && ...), "ChunkView only reads chunked components");
+
+    public:
+        explicit ChunkView(Registry& registry) : registry(&registry) {
+            (mask.set(ComponentTypeRegistry::getId<Components>()), ...);
+        }
+
+        // Calls func(count, ids, Components*...) with the arrays of every matching chunk.
+        template<typename Func>
+        void eachChunk(Func func) const {
+            for (const auto& archetype : registry->archetypes) {
+                if (archetype->size() == 0 || !archetype->getMask().matches(mask)) continue;
+
+                const std::array<std::uint8_t, sizeof...(Components)> columns{
+                    archetype->column(ComponentTypeRegistry::getId<Components>())...};
+                for (std::size_t chunk = 0; chunk < archetype->chunkCount(); ++chunk) {
+                    std::apply([&](auto... column) {
+                        func(archetype->rowsIn(chunk), archetype->ids(chunk),
+                             archetype->template array<Components>(column, chunk)...);
+                    }, columns);
+                }
+            }
+        }
+
+        // Calls func(Components&...) or func(Actor, Components&...) for every entity, the inner loop runs
+        // over a chunk's arrays.
+        template<typename Func>
+        void each(Func func) const {
+            eachChunk([this, &func](std::size_t count, const Actor::IdType* ids, Components*... arrays) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    if constexpr (std::is_invocable_v<Func&, Components&...>) {
+                        func(arrays[i]...);
+                    } else {
+                        func(Actor(ids[i], registry), arrays[i]...);
+                    }
+                }
+            });
+        }
+
+    private:
+        Registry* registry;
+        ComponentMask mask;
+    };
+
+    template<typename... Components>
+    ChunkView<Components...> chunks() {
+        return ChunkView<Components...>(*this);
+    }
+
 private:
-    struct IComponentMap {
-        virtual ~IComponentMap() = default;
-        virtual void remove(Actor::IdType id) = 0;
-        virtual void* get(Actor::IdType id) = 0;
+    // Where an entity's chunked components are, archetype is null while it has none.
+    struct ChunkRow {
+        Archetype* archetype = nullptr;
+        std::uint32_t row = 0;
     };
 
+    // Chunked components have no pool, their archetypes are created as entities move.
     template<typename T>
-    struct ComponentMap : IComponentMap {
-        std::unordered_map<Actor::IdType, T> map;
+    void ensurePool() {
+        if constexpr (!isChunked<T>) getPool<T>();
+    }
 
-        T* get(Actor::IdType id) override {
-            auto it = map.find(id);
-            return it != map.end() ? &it->second : nullptr;
+    template<typename T>
+    void registerLayout(std::size_t type) {
+        static_assert(std::is_trivially_copyable_v<T>, "Chunked components are moved between chunks as bytes");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Chunks are only aligned to max_align_t");
+        if (type >= MAX_COMPONENTS) {
+            throw ECSException("More than MAX_COMPONENTS component types");
         }
+        if (type >= layouts.size()) layouts.resize(type + 1);
+        layouts[type] = {sizeof(T), alignof(T)};
+    }
 
-        T& add(Actor::IdType id, T&& component) {
-            return map.insert_or_assign(id, std::move(component)).first->second;
+    // The archetype of from's components with type added or removed, null for the empty set.
+    Archetype* neighbour(Archetype* from, std::size_t type, bool adding) {
+        if (from) {
+            Archetype*& edge = adding ? from->withEdges[type] : from->withoutEdges[type];
+            if (edge) return edge;
         }
 
-        void remove(Actor::IdType id) override {
-            map.erase(id);
+        ComponentMask mask = from ? from->getMask() : ComponentMask();
+        if (adding) mask.set(type);
+        else mask.reset(type);
+
+        Archetype* found = nullptr;
+        if (!mask.none()) {
+            for (const auto& archetype : archetypes) {
+                if (archetype->getMask() == mask) {
+                    found = archetype.get();
+                    break;
+                }
+            }
+            if (!found) {
+                found = archetypes.emplace_back(std::make_unique<Archetype>(mask, layouts)).get();
+            }
         }
-    };
+
+        if (from) (adding ? from->withEdges[type] : from->withoutEdges[type]) = found;
+        return found;
+    }
+
+    // Moves an entity's chunked components to a row of to, dropping the ones to lacks.
+    void moveRow(Actor::IdType id, Archetype* to) {
+        ChunkRow& location = chunkRows[id & Actor::INDEX_MASK];
+        Archetype* from = location.archetype;
+        const std::uint32_t fromRow = location.row;
+
+        std::uint32_t row = 0;
+        if (to) {
+            row = to->insert(id);
+            if (from) to->copyRow(*from, fromRow, row);
+        }
+        if (from) {
+            // the last row of from took the freed one
+            if (const Actor::IdType moved = from->remove(fromRow)) {
+                chunkRows[moved & Actor::INDEX_MASK].row = fromRow;
+            }
+        }
+        location = {to, row};
+    }
 
     template<typename T>
-    ComponentMap<T>& getComponentMap() {
-        auto type = std::type_index(typeid(T));
-        if (!components.contains(type)) {
-            components[type] = std::make_unique<ComponentMap<T>>();
+    ComponentPool<T>& getPool() {
+        static_assert(!isChunked<T>, "Chunked components have no pool");
+        const std::size_t type = ComponentTypeRegistry::getId<T>();
+        if (type >= MAX_COMPONENTS) {
+            throw ECSException("More than MAX_COMPONENTS component types");
         }
-        return static_cast<ComponentMap<T>&>(*components[type]);
+        if (type >= pools.size()) pools.resize(type + 1);
+        if (!pools[type]) pools[type] = std::make_unique<ComponentPool<T>>();
+        return static_cast<ComponentPool<T>&>(*pools[type]);
     }
 
-    std::vector<Actor> entities;
-    std::unordered_map<std::type_index, std::unique_ptr<IComponentMap>> components;
-    std::unordered_map<Actor::IdType, ComponentMask> entityMasks;
-    std::queue<Actor::IdType> freeIds;
-    Actor::IdType nextEntityId = 1;
+    std::vector<std::unique_ptr<SparseSet>> pools; // by component type id
+    std::vector<Actor::IdType> slots{0};           // by entity index, index 0 is never handed out
+    std::vector<ComponentMask> masks = std::vector<ComponentMask>(1); // by entity index
+    std::vector<ChunkRow> chunkRows = std::vector<ChunkRow>(1);        // by entity index
+    std::vector<Actor::IdType> freeIndices;
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::vector<ComponentLayout> layouts; // of chunked components, by type id
 };
+
+// Actor's component templates
+template<typename T>
+bool Actor::hasComponent() const {
+    return registry && registry->template getComponent<T>(*this) != nullptr;
+}
+
+template<typename T>
+T* Actor::getComponent() {
+    return registry ? registry->template getComponent<T>(*this) : nullptr;
+}
+
+template<typename T, typename... Args>
+T& Actor::addComponent(Args&&... args) {
+    if (!registry) throw ECSException("Actor has no registry");
+    return registry->template addComponent<T>(*this, std::forward<Args>(args)...);
+}
+
+template<typename T>
+void Actor::removeComponent() {
+    if (registry) registry->template removeComponent<T>(*this);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "System.hpp"
+
+/**
+ * Runs systems on an ExecutorService. Systems are nodes of a dependency graph: a system depends on every
+ * system added before it that it conflicts with (see ISystem::conflictsWith), so conflicting systems keep
+ * their registration order and the others run side by side. A frame starts every system without pending
+ * dependencies and each finished system starts the dependents it released, there is no barrier between
+ * levels. The results match running the systems one after another in registration order.
+ */
+class Scheduler {
+public:
+    explicit Scheduler(ExecutorService& executor) : executor(executor) {}
+
+    template<typename T, typename... Args>
+    T& addSystem(Args&&... args) {
+        auto system = std::make_unique<T>(std::forward<Args>(args)...);
+        system->executor = &executor;
+
+        T& added = *system;
+        nodes.push_back({std::move(system), {}, 0});
+        graphDirty = true;
+        return added;
+    }
+
+    // Runs every system once, returns when all are done.
+    void update(Registry& registry, float deltaTime) {
+        if (nodes.empty()) return;
+        if (graphDirty) buildGraph();
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].system->ensurePools(registry);
+            pending[i].store(nodes[i].dependencyCount, std::memory_order_relaxed);
+        }
+
+        WaitGroup group;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].dependencyCount == 0) run(i, registry, deltaTime, group);
+        }
+        executor.wait(group);
+    }
+
+    // Same frame on the calling thread, one system after another. Systems using forEach still fan out.
+    void updateSequential(Registry& registry, float deltaTime) {
+        for (auto& node : nodes) {
+            node.system->update(registry, deltaTime);
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return nodes.size(); }
+
+    // Systems that start a frame with no dependency, the ones that run in parallel right away.
+    [[nodiscard]] size_t rootCount() {
+        if (graphDirty) buildGraph();
+        return static_cast<size_t>(std::count_if(nodes.begin(), nodes.end(),
+                                                 [](const Node& node) { return node.dependencyCount == 0; }));
+    }
+
+private:
+    struct Node {
+        std::unique_ptr<ISystem> system;
+        std::vector<size_t> dependents;
+        uint32_t dependencyCount;
+    };
+
+    ExecutorService& executor;
+    std::vector<Node> nodes;
+    std::unique_ptr<std::atomic<uint32_t>[]> pending; // dependencies still running this frame, by node
+    bool graphDirty = false;
+
+    void buildGraph() {
+        for (auto& node : nodes) {
+            node.dependents.clear();
+            node.dependencyCount = 0;
+        }
+
+        for (size_t later = 0; later < nodes.size(); ++later) {
+            for (size_t earlier = 0; earlier < later; ++earlier) {
+                if (nodes[later].system->conflictsWith(*nodes[earlier].system)) {
+                    nodes[earlier].dependents.push_back(later);
+                    ++nodes[later].dependencyCount;
+                }
+            }
+        }
+
+        pending = std::make_unique<std::atomic<uint32_t>[]>(nodes.size());
+        graphDirty = false;
+    }
+
+    void run(size_t index, Registry& registry, float deltaTime, WaitGroup& group) {
+        executor.execute([this, index, &registry, deltaTime, &group]() {
+            nodes[index].system->update(registry, deltaTime);
+
+            // the group still counts this task, the dependents are added to it before it can drain
+            for (size_t dependent : nodes[index].dependents) {
+                if (pending[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    run(dependent, registry, deltaTime, group);
+                }
+            }
+        }, group);
+    }
+};
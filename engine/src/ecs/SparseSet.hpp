@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Actor.hpp"
+
+/**
+ * Set of entities with O(1) insert, remove and lookup. The dense array holds the entity ids back to
+ * back; the sparse side maps an entity index to its position in the dense array and is split in fixed
+ * pages, allocated only once an index in their range is used. Dense ids keep their generation, so a
+ * stale handle to a reused slot is not found.
+ */
+class SparseSet {
+public:
+    static constexpr std::size_t PAGE_SIZE = 4096;
+    static constexpr std::uint32_t NONE = UINT32_MAX;
+
+    virtual ~SparseSet() = default;
+
+    [[nodiscard]] bool contains(Actor::IdType id) const {
+        const std::uint32_t position = find(id);
+        return position != NONE;
+    }
+
+    // Position of the entity in the dense array, NONE when it is not in the set.
+    [[nodiscard]] std::uint32_t find(Actor::IdType id) const {
+        const std::size_t index = id & Actor::INDEX_MASK;
+        const std::size_t page = index / PAGE_SIZE;
+        if (page >= sparse.size() || !sparse[page]) return NONE;
+
+        const std::uint32_t position = sparse[page][index % PAGE_SIZE];
+        return position != NONE && dense[position] == id ? position : NONE;
+    }
+
+    // Same as find, checking the hint position first. Pools filled in the same order keep their entities
+    // at the same positions, there the hint saves the sparse lookup.
+    [[nodiscard]] std::uint32_t find(Actor::IdType id, std::uint32_t hint) const {
+        return hint < dense.size() && dense[hint] == id ? hint : find(id);
+    }
+
+    [[nodiscard]] std::size_t size() const { return dense.size(); }
+    [[nodiscard]] bool empty() const { return dense.empty(); }
+    [[nodiscard]] const std::vector<Actor::IdType>& entities() const { return dense; }
+
+    // Removes the entity if it is in the set, the last entity takes its place.
+    virtual void remove(Actor::IdType id) {
+        const std::uint32_t position = find(id);
+        if (position == NONE) return;
+
+        const std::uint32_t last = static_cast<std::uint32_t>(dense.size() - 1);
+        if (position != last) {
+            dense[position] = dense[last];
+            slot(dense[position]) = position;
+        }
+        dense.pop_back();
+        slot(id) = NONE;
+        onRemoved(position, last);
+    }
+
+protected:
+    std::uint32_t insert(Actor::IdType id) {
+        const auto position = static_cast<std::uint32_t>(dense.size());
+        dense.push_back(id);
+        slot(id) = position;
+        return position;
+    }
+
+    // Lets a derived storage move its element from last to position and drop the last one.
+    virtual void onRemoved(std::uint32_t /*position*/, std::uint32_t /*last*/) {}
+
+private:
+    std::vector<std::unique_ptr<std::uint32_t[]>> sparse;
+    std::vector<Actor::IdType> dense;
+
+    std::uint32_t& slot(Actor::IdType id) {
+        const std::size_t index = id & Actor::INDEX_MASK;
+        const std::size_t page = index / PAGE_SIZE;
+        if (page >= sparse.size()) sparse.resize(page + 1);
+        if (!sparse[page]) {
+            sparse[page] = std::make_unique<std::uint32_t[]>(PAGE_SIZE);
+            std::fill_n(sparse[page].get(), PAGE_SIZE, NONE);
+        }
+        return sparse[page][index % PAGE_SIZE];
+    }
+};
+
+/**
+ * Components of one type, packed in the same order as the entities of the set.
+ */
+template<typename T>
+class ComponentPool : public SparseSet {
+public:
+    T* get(Actor::IdType id) {
+        const std::uint32_t position = find(id);
+        return position != NONE ? &components[position] : nullptr;
+    }
+
+    template<typename... Args>
+    T& emplace(Actor::IdType id, Args&&... args) {
+        if (const std::uint32_t position = find(id); position != NONE) {
+            components[position] = T(std::forward<Args>(args)...);
+            return components[position];
+        }
+
+        insert(id);
+        return components.emplace_back(std::forward<Args>(args)...);
+    }
+
+    [[nodiscard]] T* data() { return components.data(); }
+
+private:
+    std::vector<T> components;
+
+    void onRemoved(std::uint32_t position, std::uint32_t last) override {
+        if (position != last) {
+            components[position] = std::move(components[last]);
+        }
+        components.pop_back();
+    }
+};
@@ -2,41 +2,93 @@
 #include "Registry.hpp"
 #include "Components.hpp"
 #include <iostream> // fuck the error I have it in the #include "core/Core.hpp" why its no finding it !!!!
-class System {
+
+// Component access a system declares, System<Reads<Velocity>, Writes<Position>>.
+template<typename... Components>
+struct Reads {};
+
+template<typename... Components>
+struct Writes {};
+
+class ISystem {
 public:
-    virtual ~System() = default;
+    virtual ~ISystem() = default;
     virtual void update(Registry& registry, float deltaTime) = 0;
+
+    [[nodiscard]] virtual const ComponentMask& getReads() const = 0;
+    [[nodiscard]] virtual const ComponentMask& getWrites() const = 0;
+
+    // Creates the pools of the declared components, see Registry::ensurePools.
+    virtual void ensurePools(Registry& registry) const = 0;
+
+    // Two systems conflict when one writes a component the other reads or writes, they can't run at once.
+    [[nodiscard]] bool conflictsWith(const ISystem& other) const {
+        return getWrites().intersects(other.getReads()) || getWrites().intersects(other.getWrites())
+               || getReads().intersects(other.getWrites());
+    }
+
+protected:
+    // Runs the view's each() on the scheduler's workers when there is one, inline otherwise.
+    template<typename... Components, typename Func>
+    void forEach(Registry::View<Components...> view, Func&& func) const {
+        if (executor) view.parallelEach(*executor, std::forward<Func>(func));
+        else view.each(std::forward<Func>(func));
+    }
+
+private:
+    ExecutorService* executor = nullptr;
+
+    friend class Scheduler;
 };
 
+template<typename Read = Reads<>, typename Write = Writes<>>
+class System;
 
-class MovementSystem : public System {
+/**
+ * A system touching only the components it declares. The Scheduler runs systems whose declarations
+ * don't conflict at the same time, writing anything undeclared from update() is a data race.
+ */
+template<typename... Read, typename... Write>
+class System<Reads<Read...>, Writes<Write...>> : public ISystem {
 public:
-    void update(Registry& registry, float deltaTime) override {
+    System() {
+        (reads.set(ComponentTypeRegistry::getId<Read>()), ...);
+        (writes.set(ComponentTypeRegistry::getId<Write>()), ...);
+    }
 
-        for (auto entity : registry.view<Position, Velocity>()) {
-            auto* position = entity.getComponent<Position>();
-            auto* velocity = entity.getComponent<Velocity>();
-            
-            if (position && velocity) {
-                position->x += velocity->dx * deltaTime;
-                position->y += velocity->dy * deltaTime;
-            }
-        }
+    [[nodiscard]] const ComponentMask& getReads() const override { return reads; }
+    [[nodiscard]] const ComponentMask& getWrites() const override { return writes; }
+
+    void ensurePools(Registry& registry) const override {
+        registry.ensurePools<Read..., Write...>();
+    }
+
+private:
+    ComponentMask reads;
+    ComponentMask writes;
+};
+
+
+class MovementSystem : public System<Reads<Velocity>, Writes<Position>> {
+public:
+    void update(Registry& registry, float deltaTime) override {
+        forEach(registry.view<Position, Velocity>(), [deltaTime](Position& position, const Velocity& velocity) {
+            position.x += velocity.dx * deltaTime;
+            position.y += velocity.dy * deltaTime;
+        });
     }
 };
 
 // Example Health System using the new View system
-class HealthSystem : public System {
+class HealthSystem : public System<Reads<Health>> {
 public:
     void update(Registry& registry, float /*deltaTime*/) override {
         // Using the new view system
-        for (auto entity : registry.view<Health>()) {
-            auto* health = entity.getComponent<Health>();
-            
-            if (health && health->hp <= 0) {
+        for (auto [entity, health] : registry.view<Health>()) {
+            if (health.hp <= 0) {
                 std::cout << "Entity " << entity.getId() << " is dead.\n";
                 // Could emit a death event here using the event system
             }
         }
     }
-};
\ No newline at end of file
+};
@@ -94,6 +94,7 @@ struct PawnComponent {
     bool moveRight{false};
     float aimRotation{0};
     bool isShooting{false};
+    uint32_t lastInputSequence{0}; // last input of the player the server has simulated
 
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(PawnComponent, playerId, isShooting);
 };
@@ -103,13 +104,26 @@ struct RigidbodyComponent {
 };
 
 struct FireballComponent {
+    static constexpr float SPEED = 300.0f;
+
     glm::vec3 position;
     glm::vec3 direction;
     float speed;
     uint64_t ownerId; // ID of the player who created the fireball
 
     FireballComponent(const glm::vec3 &pos, const glm::vec3 &dir, float spd, uint64_t owner)
-        : position(pos), direction(glm::normalize(dir)), speed(300.0f), ownerId(owner) {
+        : position(pos), direction(glm::normalize(dir)), speed(SPEED), ownerId(owner) {
+    }
+
+    // Direction of a shot aimed at aimRotation (radians), the z part only flattens it.
+    static glm::vec3 directionFor(float aimRotation) {
+        return glm::normalize(glm::vec3(glm::cos(aimRotation), -glm::sin(aimRotation), 3.0f));
+    }
+
+    // Speed on the map of a fireball shot at aimRotation, known to the client from the rotation alone.
+    static glm::vec3 velocityFor(float aimRotation) {
+        const glm::vec3 direction = directionFor(aimRotation);
+        return {direction.x * SPEED, direction.y * SPEED, 0.0f};
     }
 
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(FireballComponent, position, direction, speed, ownerId);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+struct PlayerInput {
+    bool moveForward = false;
+    bool moveBackwards = false;
+    bool moveLeft = false;
+    bool moveRight = false;
+    float aimRotation = 0.0f;
+    bool isShooting = false;
+
+    uint32_t sequence = 0;  // numbered by the client from 1, echoed back in the snapshots once processed
+    float deltaTime = 0.0f; // client frame time the input was held for, in seconds
+};
+
+/**
+ * Pawn movement and wall collision, shared by the lobby simulation on the server and the prediction
+ * of the local pawn on the client. Both sides run exactly this code so that the same inputs from the
+ * same position end in the same place.
+ */
+class PawnMovement {
+public:
+    static constexpr float BASE_SPEED = 100.0f;
+    static constexpr float BODY_EXTENT = 0.4f; // half size of a pawn collider, relative to its scale
+    static constexpr float WALL_EXTENT = 0.5f; // walls fill their tile
+
+    static bool intersects(const glm::vec3 &a, const glm::vec2 &halfA, const glm::vec3 &b, const glm::vec2 &halfB) {
+        return a.x + halfA.x > b.x - halfB.x && a.x - halfA.x < b.x + halfB.x &&
+               a.y + halfA.y > b.y - halfB.y && a.y - halfA.y < b.y + halfB.y;
+    }
+
+    static bool hitsWall(const glm::vec3 &position, const glm::vec2 &scale, const glm::vec3 &wallPosition, const glm::vec2 &wallScale) {
+        return intersects(position, scale * BODY_EXTENT, wallPosition, wallScale * WALL_EXTENT);
+    }
+
+    // Moves position by step seconds of input, x first and then y. An axis whose move ends in a wall
+    // is undone, so the pawn slides along walls. blocked(position) tells whether a pawn at position
+    // overlaps a wall.
+    template<typename Blocked>
+    static void move(glm::vec3 &position, const PlayerInput &input, float step, Blocked &&blocked) {
+        const glm::vec3 stepStart = position;
+
+        if (input.moveLeft) position.x -= BASE_SPEED * step;
+        if (input.moveRight) position.x += BASE_SPEED * step;
+
+        if (blocked(position)) {
+            position.x = stepStart.x;
+        }
+
+        if (input.moveForward) position.y += BASE_SPEED * step;
+        if (input.moveBackwards) position.y -= BASE_SPEED * step;
+
+        if (blocked(position)) {
+            position.y = stepStart.y;
+        }
+    }
+};
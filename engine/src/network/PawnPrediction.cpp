@@ -0,0 +1,70 @@
+#include "PawnPrediction.hpp"
+
+void PawnPrediction::clearWalls() {
+    walls.clear();
+}
+
+void PawnPrediction::addWall(const glm::vec3 &position, const glm::vec2 &scale) {
+    walls.emplace(cellKey(cell(position.x), cell(position.y)), Wall{position, scale});
+}
+
+void PawnPrediction::predict(const PlayerInput &input) {
+    if (input.sequence == 0) return;
+
+    // a new connection numbers its inputs from 1 again, the old ones will never be acknowledged
+    if (input.sequence != newest + 1) {
+        acknowledged = input.sequence - 1;
+    }
+
+    history[input.sequence & (HISTORY - 1)] = input;
+    newest = input.sequence;
+
+    if (initialized) {
+        apply(input);
+    }
+}
+
+float PawnPrediction::reconcile(const glm::vec3 &serverPosition, const glm::vec2 &pawnScale, uint32_t lastProcessed) {
+    const glm::vec3 predicted = position;
+    const bool hadPosition = initialized;
+
+    position = serverPosition;
+    scale = pawnScale;
+    initialized = true;
+    acknowledged = std::min(lastProcessed, newest);
+
+    // inputs that fell out of the history while in flight are lost to the prediction
+    const uint32_t oldest = newest >= HISTORY ? newest - HISTORY + 1 : 1;
+    for (uint32_t sequence = std::max(acknowledged + 1, oldest); sequence <= newest; ++sequence) {
+        apply(history[sequence & (HISTORY - 1)]);
+    }
+
+    return hadPosition ? glm::distance(predicted, position) : 0.0f;
+}
+
+// The lobby caps the input time applied per tick, a client whose frames stall sees the difference
+// corrected by the next snapshot.
+void PawnPrediction::apply(const PlayerInput &input) {
+    PawnMovement::move(position, input, std::max(input.deltaTime, 0.0f), [&](const glm::vec3 &at) {
+        return collidesWithWall(at);
+    });
+}
+
+// Same 3x3 neighbourhood as the lobby's collision grid, a wall overlapping the pawn is centered at
+// most one cell away.
+bool PawnPrediction::collidesWithWall(const glm::vec3 &at) const {
+    if (walls.empty()) return false;
+
+    const int32_t column = cell(at.x);
+    const int32_t row = cell(at.y);
+
+    for (int32_t r = row - 1; r <= row + 1; ++r) {
+        for (int32_t c = column - 1; c <= column + 1; ++c) {
+            const auto [first, last] = walls.equal_range(cellKey(c, r));
+            for (auto it = first; it != last; ++it) {
+                if (PawnMovement::hitsWall(at, scale, it->second.position, it->second.scale)) return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/Core.hpp"
+#include "entity/PawnMovement.hpp"
+
+/**
+ * Client side prediction of the local pawn. An input moves the pawn the frame it is sent and stays in
+ * a fixed history until a snapshot reports that the server processed it. Every authoritative position
+ * then replaces the predicted one and the inputs still in flight are replayed on top of it, so the
+ * pawn only ends up somewhere else than predicted when the server disagreed.
+ *
+ * Walls are hashed by tile sized cell, the client does not know the dimensions of the lobby grid.
+ */
+class PawnPrediction {
+public:
+    static constexpr size_t HISTORY = 256;     // inputs in flight, power of two; 1.7s at 144 fps
+    static constexpr float CELL_SIZE = 100.0f; // a tile, no wall is larger
+
+    void clearWalls();
+    void addWall(const glm::vec3 &position, const glm::vec2 &scale);
+
+    // Records an input that was just sent and moves the pawn by it.
+    void predict(const PlayerInput &input);
+
+    // The pawn as a snapshot has it, after the server applied every input up to lastProcessed.
+    // Returns how far the predicted position moved, 0 when the prediction was right.
+    float reconcile(const glm::vec3 &serverPosition, const glm::vec2 &pawnScale, uint32_t lastProcessed);
+
+    bool hasPosition() const { return initialized; }
+    const glm::vec3 &getPosition() const { return position; }
+    uint32_t getPendingInputs() const { return newest - acknowledged; }
+
+private:
+    struct Wall {
+        glm::vec3 position;
+        glm::vec2 scale;
+    };
+
+    std::array<PlayerInput, HISTORY> history{};
+    uint32_t newest = 0;       // sequence of the last recorded input
+    uint32_t acknowledged = 0; // sequence of the last input the server processed
+    glm::vec3 position{0.0f};
+    glm::vec2 scale{0.0f};
+    bool initialized = false;  // no position before the first snapshot, inputs are only recorded
+
+    std::unordered_multimap<uint64_t, Wall> walls; // cell -> walls centered in it
+
+    void apply(const PlayerInput &input);
+    bool collidesWithWall(const glm::vec3 &at) const;
+
+    static int32_t cell(float value) { return static_cast<int32_t>(std::floor(value / CELL_SIZE)); }
+
+    static uint64_t cellKey(int32_t column, int32_t row) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(column)) << 32 | static_cast<uint32_t>(row);
+    }
+};
@@ -0,0 +1,325 @@
+#include "SnapshotCodec.hpp"
+
+namespace {
+    class Writer {
+    public:
+        explicit Writer(std::string &out) : out(out) {}
+
+        void u8(uint8_t value) {
+            out.push_back(static_cast<char>(value));
+        }
+
+        void u16(uint16_t value) {
+            u8(static_cast<uint8_t>(value));
+            u8(static_cast<uint8_t>(value >> 8));
+        }
+
+        void u32(uint32_t value) {
+            u16(static_cast<uint16_t>(value));
+            u16(static_cast<uint16_t>(value >> 16));
+        }
+
+        void patchU32(size_t offset, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out[offset + i] = static_cast<char>(value >> (8 * i));
+            }
+        }
+
+        void varint(uint64_t value) {
+            while (value >= 0x80) {
+                u8(static_cast<uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            u8(static_cast<uint8_t>(value));
+        }
+
+        void svarint(int32_t value) {
+            varint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+        }
+
+        size_t size() const { return out.size(); }
+
+    private:
+        std::string &out;
+    };
+
+    class Reader {
+    public:
+        explicit Reader(std::string_view data) : data(data) {}
+
+        bool u8(uint8_t &value) {
+            if (offset >= data.size()) return false;
+            value = static_cast<uint8_t>(data[offset++]);
+            return true;
+        }
+
+        bool u16(uint16_t &value) {
+            uint8_t low, high;
+            if (!u8(low) || !u8(high)) return false;
+            value = static_cast<uint16_t>(low | (high << 8));
+            return true;
+        }
+
+        bool u32(uint32_t &value) {
+            uint16_t low, high;
+            if (!u16(low) || !u16(high)) return false;
+            value = low | (static_cast<uint32_t>(high) << 16);
+            return true;
+        }
+
+        bool varint(uint64_t &value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                uint8_t byte;
+                if (!u8(byte)) return false;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return true;
+            }
+            return false;
+        }
+
+        bool svarint(int32_t &value) {
+            uint64_t raw;
+            if (!varint(raw)) return false;
+            const auto zigzag = static_cast<uint32_t>(raw);
+            value = static_cast<int32_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+            return true;
+        }
+
+        void seek(size_t position) { offset = position; }
+
+    private:
+        std::string_view data;
+        size_t offset = 0;
+    };
+
+    uint8_t changedFields(const EntitySnapshot &current, const EntitySnapshot *previous) {
+        uint8_t mask = 0;
+
+        if (!previous || previous->tileCode != current.tileCode) mask |= SnapshotCodec::TILE_CODE;
+        if (!previous || previous->position != current.position) mask |= SnapshotCodec::POSITION;
+        if (!previous || previous->rotation != current.rotation) mask |= SnapshotCodec::ROTATION;
+        if (!previous || previous->scale != current.scale) mask |= SnapshotCodec::SCALE;
+
+        if (current.hasPawn && (!previous || !previous->hasPawn ||
+                                previous->playerId != current.playerId ||
+                                previous->pawnFlags != current.pawnFlags ||
+                                previous->aimRotation != current.aimRotation ||
+                                previous->lastInputSequence != current.lastInputSequence)) {
+            mask |= SnapshotCodec::PAWN;
+        }
+
+        if (current.hasRigidbody && (!previous || !previous->hasRigidbody || previous->isSolid != current.isSolid)) {
+            mask |= SnapshotCodec::RIGIDBODY;
+        }
+
+        return mask;
+    }
+
+    void writeFields(Writer &writer, const EntitySnapshot &entity, uint8_t mask) {
+        writer.u8(mask);
+
+        if (mask & SnapshotCodec::TILE_CODE) {
+            writer.varint(entity.tileCode);
+        }
+        if (mask & SnapshotCodec::POSITION) {
+            for (const auto value: entity.position) writer.svarint(value);
+        }
+        if (mask & SnapshotCodec::ROTATION) {
+            writer.u16(entity.rotation);
+        }
+        if (mask & SnapshotCodec::SCALE) {
+            for (const auto value: entity.scale) writer.svarint(value);
+        }
+        if (mask & SnapshotCodec::PAWN) {
+            writer.varint(entity.playerId);
+            writer.u8(entity.pawnFlags);
+            writer.u16(entity.aimRotation);
+            writer.varint(entity.lastInputSequence);
+        }
+        if (mask & SnapshotCodec::RIGIDBODY) {
+            writer.u8(entity.isSolid ? 1 : 0);
+        }
+    }
+
+    bool readFields(Reader &reader, EntitySnapshot &entity) {
+        uint8_t mask;
+        if (!reader.u8(mask)) return false;
+
+        if (mask & SnapshotCodec::TILE_CODE) {
+            uint64_t tileCode;
+            if (!reader.varint(tileCode)) return false;
+            entity.tileCode = static_cast<uint32_t>(tileCode);
+        }
+        if (mask & SnapshotCodec::POSITION) {
+            for (auto &value: entity.position) {
+                if (!reader.svarint(value)) return false;
+            }
+        }
+        if (mask & SnapshotCodec::ROTATION) {
+            if (!reader.u16(entity.rotation)) return false;
+        }
+        if (mask & SnapshotCodec::SCALE) {
+            for (auto &value: entity.scale) {
+                if (!reader.svarint(value)) return false;
+            }
+        }
+        if (mask & SnapshotCodec::PAWN) {
+            entity.hasPawn = true;
+            uint64_t sequence;
+            if (!reader.varint(entity.playerId) || !reader.u8(entity.pawnFlags) || !reader.u16(entity.aimRotation) ||
+                !reader.varint(sequence)) {
+                return false;
+            }
+            entity.lastInputSequence = static_cast<uint32_t>(sequence);
+        }
+        if (mask & SnapshotCodec::RIGIDBODY) {
+            uint8_t solid;
+            if (!reader.u8(solid)) return false;
+            entity.hasRigidbody = true;
+            entity.isSolid = solid != 0;
+        }
+        return true;
+    }
+}
+
+void SnapshotCodec::encode(const Snapshot &current, const Snapshot *baseline, std::string &out) {
+    out.clear();
+    Writer writer(out);
+
+    writer.u16(MAGIC);
+    writer.u8(VERSION);
+    writer.u8(0);
+    writer.u32(current.tick);
+    writer.u32(baseline ? baseline->tick : 0);
+
+    const size_t countsOffset = writer.size();
+    writer.u32(0);
+    writer.u32(0);
+
+    static const std::vector<EntitySnapshot> empty;
+    const auto &base = baseline ? baseline->entities : empty;
+
+    // entities that were in the baseline but are gone now
+    uint32_t deletedCount = 0;
+    uint64_t previousId = 0;
+    for (size_t b = 0, c = 0; b < base.size(); ++b) {
+        while (c < current.entities.size() && current.entities[c].networkId < base[b].networkId) ++c;
+
+        if (c == current.entities.size() || current.entities[c].networkId != base[b].networkId) {
+            writer.varint(base[b].networkId - previousId);
+            previousId = base[b].networkId;
+            ++deletedCount;
+        }
+    }
+
+    // new entities in full, known entities with only the fields that changed
+    uint32_t entityCount = 0;
+    previousId = 0;
+    for (size_t c = 0, b = 0; c < current.entities.size(); ++c) {
+        const auto &entity = current.entities[c];
+        while (b < base.size() && base[b].networkId < entity.networkId) ++b;
+
+        const EntitySnapshot *previous = b < base.size() && base[b].networkId == entity.networkId ? &base[b] : nullptr;
+        const uint8_t mask = changedFields(entity, previous);
+        if (mask == 0) continue;
+
+        writer.varint(entity.networkId - previousId);
+        previousId = entity.networkId;
+        writeFields(writer, entity, mask);
+        ++entityCount;
+    }
+
+    writer.patchU32(countsOffset, deletedCount);
+    writer.patchU32(countsOffset + 4, entityCount);
+}
+
+bool SnapshotCodec::readHeader(std::string_view data, Header &header) {
+    Reader reader(data);
+
+    uint16_t magic;
+    if (!reader.u16(magic) || magic != MAGIC) return false;
+
+    return reader.u8(header.version) && header.version == VERSION &&
+           reader.u8(header.flags) &&
+           reader.u32(header.tick) &&
+           reader.u32(header.baseTick) &&
+           reader.u32(header.deletedCount) &&
+           reader.u32(header.entityCount);
+}
+
+bool SnapshotCodec::decode(std::string_view data, const Snapshot *baseline, Snapshot &out) {
+    Header header;
+    if (!readHeader(data, header)) return false;
+
+    if (header.baseTick != 0 && (!baseline || baseline->tick != header.baseTick)) {
+        return false;
+    }
+
+    static const std::vector<EntitySnapshot> empty;
+    const auto &base = header.baseTick != 0 ? baseline->entities : empty;
+
+    out.tick = header.tick;
+    out.entities.clear();
+
+    // the deleted ids are consumed lazily by a second reader while the entity list is merged
+    Reader deletedReader(data);
+    deletedReader.seek(HEADER_SIZE);
+    uint32_t deletedLeft = header.deletedCount;
+    uint64_t nextDeleted = 0;
+    bool hasDeleted = false;
+
+    auto advanceDeleted = [&]() {
+        hasDeleted = false;
+        if (deletedLeft == 0) return true;
+
+        uint64_t delta;
+        if (!deletedReader.varint(delta)) return false;
+        nextDeleted += delta;
+        hasDeleted = true;
+        --deletedLeft;
+        return true;
+    };
+
+    Reader reader(data);
+    reader.seek(HEADER_SIZE);
+    for (uint32_t i = 0; i < header.deletedCount; ++i) {
+        uint64_t skipped;
+        if (!reader.varint(skipped)) return false;
+    }
+
+    if (!advanceDeleted()) return false;
+
+    size_t b = 0;
+    auto copyBaselineUntil = [&](uint64_t networkId) {
+        for (; b < base.size() && base[b].networkId < networkId; ++b) {
+            while (hasDeleted && nextDeleted < base[b].networkId) {
+                if (!advanceDeleted()) return false;
+            }
+            if (hasDeleted && nextDeleted == base[b].networkId) {
+                continue;
+            }
+            out.entities.push_back(base[b]);
+        }
+        return true;
+    };
+
+    uint64_t networkId = 0;
+    for (uint32_t i = 0; i < header.entityCount; ++i) {
+        uint64_t delta;
+        if (!reader.varint(delta)) return false;
+        networkId += delta;
+
+        if (!copyBaselineUntil(networkId)) return false;
+
+        auto &entity = out.entities.emplace_back();
+        if (b < base.size() && base[b].networkId == networkId) {
+            entity = base[b++];
+        }
+        entity.networkId = networkId;
+
+        if (!readFields(reader, entity)) return false;
+    }
+
+    return copyBaselineUntil(std::numeric_limits<uint64_t>::max());
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "core/Core.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+/**
+ * Networked state of one entity at one server tick. Values are stored already quantized so the
+ * server and the client compare and reproduce exactly the same numbers.
+ */
+struct EntitySnapshot {
+    static constexpr float POSITION_SCALE = 16.0f; // 1/16 of a world unit
+    static constexpr float ANGLE_SCALE = 65536.0f / static_cast<float>(2.0 * M_PI);
+
+    uint64_t networkId{0};
+    uint32_t tileCode{0};
+    std::array<int32_t, 3> position{};
+    uint16_t rotation{0};
+    std::array<int32_t, 2> scale{};
+
+    bool hasPawn{false};
+    uint64_t playerId{0};
+    uint8_t pawnFlags{0};
+    uint16_t aimRotation{0};
+    uint32_t lastInputSequence{0};
+
+    bool hasRigidbody{false};
+    bool isSolid{false};
+
+    enum PawnFlags : uint8_t {
+        MOVE_FORWARD = BIT(0),
+        MOVE_BACKWARDS = BIT(1),
+        MOVE_LEFT = BIT(2),
+        MOVE_RIGHT = BIT(3),
+        SHOOTING = BIT(4)
+    };
+
+    void setPosition(const glm::vec3 &value) {
+        position = {quantize(value.x), quantize(value.y), quantize(value.z)};
+    }
+
+    glm::vec3 getPosition() const {
+        return {position[0] / POSITION_SCALE, position[1] / POSITION_SCALE, position[2] / POSITION_SCALE};
+    }
+
+    void setScale(const glm::vec2 &value) {
+        scale = {quantize(value.x), quantize(value.y)};
+    }
+
+    glm::vec2 getScale() const {
+        return {scale[0] / POSITION_SCALE, scale[1] / POSITION_SCALE};
+    }
+
+    static uint16_t quantizeAngle(float radians) {
+        return static_cast<uint16_t>(static_cast<int32_t>(std::lround(radians * ANGLE_SCALE)) & 0xFFFF);
+    }
+
+    static float dequantizeAngle(uint16_t angle) {
+        return static_cast<float>(angle) / ANGLE_SCALE;
+    }
+
+    bool hasFlag(PawnFlags flag) const { return (pawnFlags & flag) != 0; }
+
+    bool operator==(const EntitySnapshot &) const = default;
+
+private:
+    static int32_t quantize(float value) {
+        return static_cast<int32_t>(std::lround(value * POSITION_SCALE));
+    }
+};
+
+/**
+ * Every networked entity of a lobby at one tick, sorted by networkId.
+ */
+struct Snapshot {
+    uint32_t tick{0};
+    std::vector<EntitySnapshot> entities;
+
+    void sort() {
+        std::ranges::sort(entities, {}, &EntitySnapshot::networkId);
+    }
+};
+
+/**
+ * Fixed ring of the last few snapshots, used as delta baselines. Slots are reused so that
+ * steady state recording does not allocate.
+ */
+class SnapshotHistory {
+public:
+    static constexpr size_t CAPACITY = 32;
+
+    // Returns the slot for tick, cleared but with its capacity kept.
+    Snapshot &record(uint32_t tick) {
+        auto &slot = slots[tick % CAPACITY];
+        slot.tick = tick;
+        slot.entities.clear();
+        return slot;
+    }
+
+    // Swaps an already built snapshot into its slot. The previous slot contents end up in snapshot.
+    void store(Snapshot &snapshot) {
+        std::swap(slots[snapshot.tick % CAPACITY], snapshot);
+    }
+
+    const Snapshot *find(uint32_t tick) const {
+        if (tick == 0) return nullptr;
+        const auto &slot = slots[tick % CAPACITY];
+        return slot.tick == tick ? &slot : nullptr;
+    }
+
+private:
+    std::array<Snapshot, CAPACITY> slots;
+};
+
+/**
+ * Binary game state frame sent from the server to the clients over the websocket.
+ *
+ * Layout (little endian):
+ *   u16 magic, u8 version, u8 flags, u32 tick, u32 baseTick, u32 deletedCount, u32 entityCount
+ *   deletedCount x varint networkId delta
+ *   entityCount  x { varint networkId delta, u8 field mask, present fields }
+ *
+ * Network ids are written as the difference to the previous id in the same list. When baseTick is
+ * not 0 the frame only carries the fields that changed since that snapshot, otherwise it is a full state.
+ */
+class SnapshotCodec {
+public:
+    static constexpr uint16_t MAGIC = 0x4154; // "AT"
+    static constexpr uint8_t VERSION = 2; // 2: pawns carry the last processed input sequence
+    static constexpr size_t HEADER_SIZE = 20;
+    static constexpr uint32_t TICK_RATE = 30; // lobby ticks per second, one snapshot each
+
+    enum Field : uint8_t {
+        TILE_CODE = BIT(0),
+        POSITION = BIT(1),
+        ROTATION = BIT(2),
+        SCALE = BIT(3),
+        PAWN = BIT(4),
+        RIGIDBODY = BIT(5)
+    };
+
+    struct Header {
+        uint8_t version{0};
+        uint8_t flags{0};
+        uint32_t tick{0};
+        uint32_t baseTick{0};
+        uint32_t deletedCount{0};
+        uint32_t entityCount{0};
+    };
+
+    // Encodes current against baseline (full state when baseline is null) into out, reusing its capacity.
+    static void encode(const Snapshot &current, const Snapshot *baseline, std::string &out);
+
+    static bool readHeader(std::string_view data, Header &header);
+
+    // Rebuilds the full snapshot described by data on top of baseline. Returns false on a malformed
+    // frame or when the frame is a delta and baseline is not the snapshot it was encoded against.
+    static bool decode(std::string_view data, const Snapshot *baseline, Snapshot &out);
+};
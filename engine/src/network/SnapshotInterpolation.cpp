@@ -0,0 +1,51 @@
+#include "SnapshotInterpolation.hpp"
+
+void InterpolationBuffer::push(double serverTime, const glm::vec3 &position) {
+    if (count > 0 && serverTime <= fromNewest(0).time) return;
+
+    entries[next] = {serverTime, position};
+    next = (next + 1) & (CAPACITY - 1);
+    count = std::min(count + 1, CAPACITY);
+}
+
+void InterpolationBuffer::hold(double serverTime) {
+    if (count > 0) {
+        push(serverTime, fromNewest(0).position);
+    }
+}
+
+glm::vec3 InterpolationBuffer::sample(double serverTime, const glm::vec3 *velocity, double maxExtrapolation) const {
+    if (count == 0) return glm::vec3(0.0f);
+
+    const Entry &newest = fromNewest(0);
+    if (serverTime >= newest.time) {
+        if (!velocity) return newest.position;
+
+        const double ahead = std::min(serverTime - newest.time, maxExtrapolation);
+        return newest.position + *velocity * static_cast<float>(ahead);
+    }
+
+    // the render time trails the newest snapshot by a few ticks, the pair is near the front
+    for (size_t age = 1; age < count; ++age) {
+        const Entry &from = fromNewest(age);
+        if (from.time <= serverTime) {
+            const Entry &to = fromNewest(age - 1);
+            const float t = static_cast<float>((serverTime - from.time) / (to.time - from.time));
+            return glm::mix(from.position, to.position, t);
+        }
+    }
+
+    return fromNewest(count - 1).position;
+}
+
+void SnapshotClock::onSnapshot(uint32_t tick, double localTime) {
+    const double measured = serverTime(tick) - localTime;
+
+    if (!synced || std::abs(measured - offset) > RESYNC) {
+        offset = measured;
+        synced = true;
+        return;
+    }
+
+    offset += (measured - offset) * SMOOTHING;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "SnapshotCodec.hpp"
+
+/**
+ * Positions of one remote entity by server time, a fixed ring filled as snapshots arrive. Remote
+ * entities are drawn a little in the past, between two snapshots the client already has, so 30 Hz
+ * ticks look smooth at any frame rate and a late snapshot does not show as a stutter. Past the
+ * newest snapshot an entity stands still, unless it has a known velocity to carry on with.
+ */
+class InterpolationBuffer {
+public:
+    static constexpr size_t CAPACITY = 16; // power of two, half a second of snapshots
+
+    void clear() { count = 0; }
+
+    bool empty() const { return count == 0; }
+
+    // Position at serverTime. Times have to grow, an older one is ignored.
+    void push(double serverTime, const glm::vec3 &position);
+
+    // The entity was still at its newest position at serverTime, it did not change in the snapshots
+    // in between. Keeps the next push from spreading the move over the whole gap.
+    void hold(double serverTime);
+
+    // Position at serverTime, interpolated between the snapshots around it. Before the oldest one
+    // that one is used; after the newest the entity holds still, or moves on with velocity for at most
+    // maxExtrapolation seconds when one is given.
+    glm::vec3 sample(double serverTime, const glm::vec3 *velocity = nullptr, double maxExtrapolation = 0.0) const;
+
+private:
+    struct Entry {
+        double time;
+        glm::vec3 position;
+    };
+
+    std::array<Entry, CAPACITY> entries{};
+    size_t next = 0;  // slot of the next push
+    size_t count = 0;
+
+    const Entry &fromNewest(size_t age) const { return entries[(next - 1 - age) & (CAPACITY - 1)]; }
+};
+
+// Client only, the component of remote entities that move, drawn from their recent snapshots.
+struct InterpolationComponent {
+    InterpolationBuffer buffer;
+    bool extrapolate{false}; // keeps moving with velocity past the newest snapshot
+    glm::vec3 velocity{0.0f};
+};
+
+/**
+ * The server clock as the client sees it, from the tick of every snapshot and the local time it
+ * arrived. The offset follows the arrivals slowly so that jitter neither shakes the render time
+ * nor runs it backwards. Remote entities are drawn at renderTime, delay behind the estimate; the
+ * delay has to cover one tick interval and the usual lateness of a snapshot.
+ */
+class SnapshotClock {
+public:
+    static constexpr double TICK_INTERVAL = 1.0 / SnapshotCodec::TICK_RATE;
+    static constexpr double DEFAULT_DELAY = 3.0 * TICK_INTERVAL;
+    static constexpr double RESYNC = 0.5; // an estimate this far off is replaced, not followed
+    static constexpr double SMOOTHING = 0.05;
+
+    explicit SnapshotClock(double delay = DEFAULT_DELAY) : delay(delay) {}
+
+    void onSnapshot(uint32_t tick, double localTime);
+
+    static double serverTime(uint32_t tick) { return tick * TICK_INTERVAL; }
+
+    double renderTime(double localTime) const { return localTime + offset - delay; }
+
+    bool isSynced() const { return synced; }
+
+    void setDelay(double seconds) { delay = seconds; }
+
+    double getDelay() const { return delay; }
+
+private:
+    double delay;
+    double offset = 0.0; // server time minus local time
+    bool synced = false;
+};
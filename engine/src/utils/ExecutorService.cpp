@@ -1,36 +1,191 @@
 #include "ExecutorService.hpp"
 
-ExecutorService::ExecutorService(size_t threadCount): stop(false) {
-    for (std::size_t i = 0; i < threadCount; i++) {
-        workers.emplace_back([this]() {
-            while (true) {
+#include "core/Log.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#endif
 
-                std::function<void()> task; {
+namespace {
+    struct WorkerSlot {
+        const ExecutorService *executor = nullptr;
+        size_t index = 0;
+    };
 
-                    std::unique_lock<std::mutex> lock(this->queueMutex);
-                    this->condition.wait(lock, [this]() {
-                        return this->stop || !this->tasks.empty();
-                    });
+    thread_local WorkerSlot currentSlot;
+}
 
-                    if (this->stop && this->tasks.empty())
-                        return;
+ExecutorService::ExecutorService(size_t threadCount, bool pinThreads): stop(false) {
+    threadCount = std::max<size_t>(threadCount, 1);
 
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
-                }
-                task();
-            }
-        });
+    for (std::size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    // the deques must all exist before the first worker tries to steal
+    for (std::size_t i = 0; i < threadCount; i++) {
+        workers[i]->thread = std::thread(&ExecutorService::workerLoop, this, i);
+
+        if (pinThreads) {
+            pinThread(workers[i]->thread, i % std::max(1u, std::thread::hardware_concurrency()));
+        }
     }
 }
 
 ExecutorService::~ExecutorService() { {
-    std::unique_lock<std::mutex> lock(queueMutex);
+    std::unique_lock<std::mutex> lock(sleepMutex);
     stop = true;
 }
     condition.notify_all();
-    for (std::thread &worker: workers) {
-        if (worker.joinable())
-            worker.join();
+    for (auto &worker: workers) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+
+    Task *task;
+    while (freeTasks.pop(task)) {
+        delete task;
+    }
+}
+
+void ExecutorService::wait(WaitGroup &group) {
+    const int64_t self = currentWorker();
+
+    while (!group.isDone()) {
+        if (Task *task = findTask(self)) {
+            runTask(task);
+        } else {
+            std::this_thread::yield();
+        }
     }
-}
\ No newline at end of file
+}
+
+void ExecutorService::schedule(Task *task) {
+    queued.fetch_add(1);
+
+    if (const int64_t self = currentWorker(); self >= 0) {
+        workers[self]->deque.push(task);
+    } else {
+        std::unique_lock<std::mutex> lock(injectedMutex);
+        pushInjected(task);
+    }
+
+    if (sleeping.load() > 0) {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        condition.notify_one();
+    }
+}
+
+void ExecutorService::workerLoop(size_t index) {
+    currentSlot = {this, index};
+
+    while (true) {
+        if (Task *task = findTask(static_cast<int64_t>(index))) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        this->condition.wait(lock, [this]() {
+            return this->stop || this->queued.load() > 0;
+        });
+        sleeping.fetch_sub(1);
+
+        if (this->stop && this->queued.load() == 0)
+            return;
+    }
+}
+
+Task *ExecutorService::findTask(int64_t self) {
+    Task *task = self >= 0 ? workers[self]->deque.pop() : nullptr;
+
+    if (!task) {
+        std::unique_lock<std::mutex> lock(injectedMutex);
+        task = popInjected();
+    }
+
+    // steal from the others, starting next to us so the victims are spread out
+    const size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : 0;
+    for (size_t i = 0; !task && i < workers.size(); ++i) {
+        const size_t victim = (start + i) % workers.size();
+        if (static_cast<int64_t>(victim) != self) {
+            task = workers[victim]->deque.steal();
+        }
+    }
+
+    if (task) {
+        queued.fetch_sub(1);
+    }
+    return task;
+}
+
+void ExecutorService::runTask(Task *task) {
+    try {
+        (*task)();
+    } catch (const std::exception &e) {
+        AT_ERROR("Uncaught exception in executor task: {}", e.what());
+    }
+    releaseTask(task);
+}
+
+int64_t ExecutorService::currentWorker() const {
+    return currentSlot.executor == this ? static_cast<int64_t>(currentSlot.index) : -1;
+}
+
+Task *ExecutorService::acquireTask() {
+    Task *task;
+    if (freeTasks.pop(task)) {
+        return task;
+    }
+    return new Task();
+}
+
+void ExecutorService::releaseTask(Task *task) {
+    task->reset();
+
+    if (!freeTasks.push(task)) {
+        delete task;
+    }
+}
+
+// injectedMutex held.
+void ExecutorService::pushInjected(Task *task) {
+    if (injectedCount == injected.size()) {
+        // unroll the ring into a bigger one, oldest task first
+        std::vector<Task *> grown(std::max<size_t>(injected.size() * 2, 64));
+        for (size_t i = 0; i < injectedCount; ++i) {
+            grown[i] = injected[(injectedHead + i) % injected.size()];
+        }
+        injected = std::move(grown);
+        injectedHead = 0;
+    }
+
+    injected[(injectedHead + injectedCount) % injected.size()] = task;
+    ++injectedCount;
+}
+
+// injectedMutex held.
+Task *ExecutorService::popInjected() {
+    if (injectedCount == 0) {
+        return nullptr;
+    }
+
+    Task *task = injected[injectedHead];
+    injectedHead = (injectedHead + 1) % injected.size();
+    --injectedCount;
+    return task;
+}
+
+void ExecutorService::pinThread(std::thread &thread, size_t core) {
+#ifdef _WIN32
+    SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << core);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+}
@@ -1,46 +1,182 @@
 #pragma once
 
+#include <algorithm>
 #include <future>
 #include <thread>
 #include <vector>
-#include <queue>
 #include <functional>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <cstddef>
 
+#include "MpmcQueue.hpp"
+#include "WorkStealingDeque.hpp"
+
+/**
+ * Type erased move-only callable. Callables up to INLINE_SIZE bytes live inside the task,
+ * bigger ones fall back to the heap.
+ */
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 64;
+
+    Task() = default;
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() { reset(); }
+
+    template<typename F>
+    void set(F &&func) {
+        using Callable = std::decay_t<F>;
+        reset();
+
+        if constexpr (sizeof(Callable) <= INLINE_SIZE && alignof(Callable) <= alignof(std::max_align_t)) {
+            target = new(storage) Callable(std::forward<F>(func));
+            destroy = [](void *callable) { static_cast<Callable *>(callable)->~Callable(); };
+        } else {
+            target = new Callable(std::forward<F>(func));
+            destroy = [](void *callable) { delete static_cast<Callable *>(callable); };
+        }
+        invoke = [](void *callable) { (*static_cast<Callable *>(callable))(); };
+    }
+
+    void operator()() { invoke(target); }
+
+    void reset() {
+        if (target) {
+            destroy(target);
+            target = nullptr;
+        }
+    }
+
+private:
+    alignas(std::max_align_t) std::byte storage[INLINE_SIZE];
+    void *target = nullptr;
+    void (*invoke)(void *) = nullptr;
+    void (*destroy)(void *) = nullptr;
+};
+
+/**
+ * Counts outstanding work. ExecutorService::wait(group) runs other tasks while it waits, so
+ * waiting from inside a worker (nested parallelFor) does not block the pool.
+ */
+class WaitGroup {
+public:
+    void add(int64_t count = 1) { pending.fetch_add(count, std::memory_order_relaxed); }
+    void done() { pending.fetch_sub(1, std::memory_order_acq_rel); }
+    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    std::atomic<int64_t> pending{0};
+};
+
+/**
+ * Work stealing thread pool. Every worker owns a Chase-Lev deque; tasks submitted from a worker
+ * go to its own deque, tasks from other threads go to a shared injection queue. Idle workers
+ * steal from each other before going to sleep. Finished tasks go back to a free list shared by
+ * every thread, so scheduling does not allocate once the pool has warmed up, whichever thread
+ * submits and whichever runs the task.
+ */
 class ExecutorService {
 public:
-    ExecutorService(size_t threadCount);
+    explicit ExecutorService(size_t threadCount, bool pinThreads = false);
 
     // do not move in cpp -> link error
     template<typename F, typename... Args>
     auto submit(F &&f, Args &&... args) -> std::future<std::invoke_result_t<F, Args...>> {
         using returnType = std::invoke_result_t<F, Args...>;
 
-        auto task = std::make_shared<std::packaged_task<returnType()> >(
+        std::packaged_task<returnType()> task(
             std::bind(std::forward<F>(f), std::forward<Args>(args)...)
         );
 
-        std::future<returnType> result = task->get_future();
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            if (stop)
-                throw std::runtime_error("Submit on stopped ExecutorService");
+        std::future<returnType> result = task.get_future();
+        execute(std::move(task));
+        return result;
+    }
+
+    // Fire and forget, no future is created.
+    template<typename F>
+    void execute(F &&func) {
+        if (stop)
+            throw std::runtime_error("Submit on stopped ExecutorService");
+
+        Task *task = acquireTask();
+        task->set(std::forward<F>(func));
+        schedule(task);
+    }
+
+    template<typename F>
+    void execute(F &&func, WaitGroup &group) {
+        group.add();
+        execute([func = std::forward<F>(func), &group]() mutable {
+            struct Done {
+                WaitGroup &group;
+                ~Done() { group.done(); }
+            } done{group};
+            func();
+        });
+    }
+
+    // Calls func(i) for every i in [begin, end), in chunks of grain, and returns when all are done.
+    template<typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F &&func) {
+        if (begin >= end) return;
+        grain = std::max<size_t>(grain, 1);
 
-            tasks.emplace([task]() { (*task)(); });
+        WaitGroup group;
+        for (size_t chunk = begin; chunk < end; chunk += grain) {
+            const size_t chunkEnd = std::min(chunk + grain, end);
+            execute([&func, chunk, chunkEnd]() {
+                for (size_t i = chunk; i < chunkEnd; ++i) {
+                    func(i);
+                }
+            }, group);
         }
-        condition.notify_one();
-        return result;
+        wait(group);
     }
 
+    // Blocks until group is done, running queued tasks in the meantime.
+    void wait(WaitGroup &group);
+
+    size_t getThreadCount() const { return workers.size(); }
+
     ~ExecutorService();
 
 private:
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
+    struct Worker {
+        WorkStealingDeque<Task> deque;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
 
-    std::mutex queueMutex;
+    // ring of tasks submitted from outside the pool, it grows but never shrinks
+    std::vector<Task *> injected;
+    size_t injectedHead = 0;
+    size_t injectedCount = 0;
+    std::mutex injectedMutex;
+
+    static constexpr size_t FREE_TASKS = 4096; // tasks kept for reuse, more are deleted when they finish
+    MpmcQueue<Task *, FREE_TASKS> freeTasks;
+
+    std::mutex sleepMutex;
     std::condition_variable condition;
+    std::atomic<int64_t> queued{0};
+    std::atomic<int32_t> sleeping{0};
     std::atomic<bool> stop;
+
+    void schedule(Task *task);
+    void workerLoop(size_t index);
+    Task *findTask(int64_t self);
+    void runTask(Task *task);
+    int64_t currentWorker() const;
+
+    Task *acquireTask();
+    void releaseTask(Task *task);
+    void pushInjected(Task *task);
+    Task *popInjected();
+    static void pinThread(std::thread &thread, size_t core);
 };
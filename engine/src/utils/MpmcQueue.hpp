@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded multi producer multi consumer queue (Vyukov's bounded queue). Every slot carries a sequence
+ * number saying whose turn it is: producers claim a position with a CAS on the tail and publish the
+ * slot by bumping its sequence, consumers claim a published slot with a CAS on the head and hand it
+ * back to the producers one lap later. Storage is fixed, nothing allocates or blocks, a full queue
+ * refuses the push and an empty one the pop.
+ */
+template<typename T, size_t CAPACITY>
+class MpmcQueue {
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+    MpmcQueue() {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    bool push(const T &value) {
+        uint64_t position = tailPosition.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[position & (CAPACITY - 1)];
+            const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<int64_t>(sequence - position);
+            if (lag == 0) {
+                if (tailPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                return false; // the slot's previous value has not been popped yet
+            } else {
+                position = tailPosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = value;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &value) {
+        uint64_t position = headPosition.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[position & (CAPACITY - 1)];
+            const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<int64_t>(sequence - (position + 1));
+            if (lag == 0) {
+                if (headPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                return false; // nothing published at this position yet
+            } else {
+                position = headPosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = slot->value;
+        slot->sequence.store(position + CAPACITY, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+
+    std::array<Slot, CAPACITY> slots;
+    alignas(64) std::atomic<uint64_t> tailPosition{0};
+    alignas(64) std::atomic<uint64_t> headPosition{0};
+};
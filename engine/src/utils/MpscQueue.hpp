@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded multi producer single consumer queue (Vyukov's bounded queue with a single consumer). Every
+ * slot carries a sequence number saying whose turn it is: producers claim a position with a CAS on the
+ * tail and publish the slot by bumping its sequence, the consumer reads slots in order until it meets
+ * one that is not published yet. Storage is fixed, neither side allocates or blocks and a full queue
+ * refuses the push.
+ */
+template<typename T, size_t CAPACITY>
+class MpscQueue {
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // Any thread.
+    bool push(const T &value) {
+        uint64_t position = tailPosition.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[position & (CAPACITY - 1)];
+            const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<int64_t>(sequence - position);
+            if (lag == 0) {
+                if (tailPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                return false; // the consumer has not read this slot's previous lap
+            } else {
+                position = tailPosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value = value;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Calls func(const T &) for every value pushed before the call, oldest first, and
+    // returns how many there were. Values pushed meanwhile, also from func, wait for the next drain.
+    template<typename Func>
+    size_t drain(Func &&func) {
+        const uint64_t end = tailPosition.load(std::memory_order_acquire);
+        const uint64_t start = headPosition;
+
+        while (headPosition != end) {
+            Slot &slot = slots[headPosition & (CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != headPosition + 1) {
+                break; // claimed but not written yet
+            }
+
+            func(static_cast<const T &>(slot.value));
+            slot.sequence.store(headPosition + CAPACITY, std::memory_order_release);
+            ++headPosition;
+        }
+        return headPosition - start;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+
+    std::array<Slot, CAPACITY> slots;
+    alignas(64) std::atomic<uint64_t> tailPosition{0};
+    alignas(64) uint64_t headPosition = 0; // consumer only
+};
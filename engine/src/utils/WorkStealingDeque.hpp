@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * Chase-Lev work stealing deque (the C11 formulation by Lê, Pop, Cohen and Zappa Nardelli).
+ *
+ * The owning thread pushes and pops at the bottom, any other thread steals from the top.
+ * Only pointers are stored so a thief never reads a half written element. The buffer grows
+ * when full, retired buffers are kept until the deque dies because a thief may still read them.
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity = 256) {
+        buffers.push_back(std::make_unique<Buffer>(capacity));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // Owner only.
+    void push(T *item) {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        const int64_t t = top.load(std::memory_order_acquire);
+        Buffer *current = buffer.load(std::memory_order_relaxed);
+
+        if (b - t > static_cast<int64_t>(current->capacity) - 1) {
+            current = grow(current, b, t);
+        }
+
+        current->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only. Returns nullptr when empty.
+    T *pop() {
+        const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer *current = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T *item = current->get(b);
+        if (t == b) {
+            // last element, race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread. Returns nullptr when empty or when it lost a race.
+    T *steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return nullptr;
+        }
+
+        T *item = buffer.load(std::memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    bool empty() const {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Buffer {
+        explicit Buffer(size_t capacity) : capacity(capacity), mask(capacity - 1), slots(capacity) {}
+
+        size_t capacity;
+        size_t mask;
+        std::vector<std::atomic<T *>> slots;
+
+        T *get(int64_t index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+        void put(int64_t index, T *item) { slots[index & mask].store(item, std::memory_order_relaxed); }
+    };
+
+    Buffer *grow(Buffer *current, int64_t b, int64_t t) {
+        auto next = std::make_unique<Buffer>(current->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            next->put(i, current->get(i));
+        }
+
+        Buffer *raw = next.get();
+        buffers.push_back(std::move(next));
+        buffer.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Buffer *> buffer{nullptr};
+    std::vector<std::unique_ptr<Buffer>> buffers; // owner only, keeps retired buffers alive
+};
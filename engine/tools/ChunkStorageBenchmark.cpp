@@ -0,0 +1,192 @@
+// Times the fireball integration of Lobby::update, position += direction * speed * dt, over 100k
+// projectiles among 2500 tiles that only have a position. Runs it on entt::registry, on Registry with
+// sparse set pools and on Registry with the components in archetype chunks, plus the cost of spawning
+// and destroying a fireball in each.
+//
+// usage: chunk_storage_bench [fireballs] [frames]
+
+#include "ecs/Registry.hpp"
+
+#include <entt/entt.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    // The fireball's hot data, once per storage policy so both Registry variants run in one binary.
+    template<StoragePolicy Policy>
+    struct Body {
+        float x, y, z;
+    };
+
+    template<StoragePolicy Policy>
+    struct Heading {
+        float x, y, z;
+    };
+
+    template<StoragePolicy Policy>
+    struct Speed {
+        float value;
+    };
+}
+
+template<StoragePolicy Policy>
+struct ComponentStorage<Body<Policy>> {
+    static constexpr StoragePolicy policy = Policy;
+};
+
+template<StoragePolicy Policy>
+struct ComponentStorage<Heading<Policy>> {
+    static constexpr StoragePolicy policy = Policy;
+};
+
+template<StoragePolicy Policy>
+struct ComponentStorage<Speed<Policy>> {
+    static constexpr StoragePolicy policy = Policy;
+};
+
+namespace {
+    constexpr float DELTA_TIME = 1.0f / 30.0f;
+    constexpr size_t TILES = 2500;
+
+    template<typename Func>
+    double microseconds(size_t repeats, Func &&func) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repeats; ++i) {
+            func();
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()
+               / static_cast<double>(repeats);
+    }
+
+    template<typename B, typename H, typename S>
+    void integrate(B &body, const H &heading, const S &speed) {
+        body.x += heading.x * speed.value * DELTA_TIME;
+        body.y += heading.y * speed.value * DELTA_TIME;
+        body.z = 3.0f;
+    }
+
+    Heading<StoragePolicy::SparseSet> headingFor(size_t i) {
+        const float angle = static_cast<float>(i) * 0.01f;
+        return {std::cos(angle), -std::sin(angle), 0.0f};
+    }
+
+    template<typename H>
+    H convert(const Heading<StoragePolicy::SparseSet> &heading) {
+        return {heading.x, heading.y, heading.z};
+    }
+
+    struct Result {
+        double integrate; // us per pass
+        double spawn;     // ns per fireball created with its components and destroyed
+        double checksum;
+    };
+
+    template<StoragePolicy Policy>
+    Result runRegistry(size_t fireballs, size_t frames) {
+        using FireballBody = Body<Policy>;
+        using FireballHeading = Heading<Policy>;
+        using FireballSpeed = Speed<Policy>;
+
+        Registry registry;
+        for (size_t i = 0; i < TILES; ++i) {
+            registry.createEntity().addComponent<FireballBody>(FireballBody{static_cast<float>(i), 0.0f, 5.0f});
+        }
+        std::vector<Actor> spawned;
+        const auto spawn = [&](size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                Actor fireball = registry.createEntity();
+                fireball.addComponent<FireballBody>(FireballBody{0.0f, 0.0f, 3.0f});
+                fireball.addComponent<FireballHeading>(convert<FireballHeading>(headingFor(i)));
+                fireball.addComponent<FireballSpeed>(FireballSpeed{300.0f});
+                spawned.push_back(fireball);
+            }
+        };
+
+        const double spawnMicroseconds = microseconds(1, [&] {
+            spawn(fireballs);
+            for (Actor fireball : spawned) registry.destroyEntity(fireball);
+        });
+        spawned.clear();
+        spawn(fireballs);
+
+        double perPass;
+        if constexpr (Policy == StoragePolicy::Chunked) {
+            perPass = microseconds(frames, [&] {
+                registry.chunks<FireballBody, FireballHeading, FireballSpeed>().each(
+                    [](FireballBody &body, const FireballHeading &heading, const FireballSpeed &speed) {
+                        integrate(body, heading, speed);
+                    });
+            });
+        } else {
+            perPass = microseconds(frames, [&] {
+                registry.view<FireballBody, FireballHeading, FireballSpeed>().each(
+                    [](FireballBody &body, const FireballHeading &heading, const FireballSpeed &speed) {
+                        integrate(body, heading, speed);
+                    });
+            });
+        }
+
+        double checksum = 0.0;
+        for (Actor fireball : spawned) checksum += fireball.getComponent<FireballBody>()->x;
+        return {perPass, spawnMicroseconds * 1000.0 / static_cast<double>(fireballs), checksum};
+    }
+
+    Result runEntt(size_t fireballs, size_t frames) {
+        using FireballBody = Body<StoragePolicy::SparseSet>;
+        using FireballHeading = Heading<StoragePolicy::SparseSet>;
+        using FireballSpeed = Speed<StoragePolicy::SparseSet>;
+
+        entt::registry registry;
+        for (size_t i = 0; i < TILES; ++i) {
+            registry.emplace<FireballBody>(registry.create(), FireballBody{static_cast<float>(i), 0.0f, 5.0f});
+        }
+        std::vector<entt::entity> spawned;
+        const auto spawn = [&](size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                const entt::entity fireball = registry.create();
+                registry.emplace<FireballBody>(fireball, FireballBody{0.0f, 0.0f, 3.0f});
+                registry.emplace<FireballHeading>(fireball, headingFor(i));
+                registry.emplace<FireballSpeed>(fireball, FireballSpeed{300.0f});
+                spawned.push_back(fireball);
+            }
+        };
+
+        const double spawnMicroseconds = microseconds(1, [&] {
+            spawn(fireballs);
+            for (entt::entity fireball : spawned) registry.destroy(fireball);
+        });
+        spawned.clear();
+        spawn(fireballs);
+
+        const double perPass = microseconds(frames, [&] {
+            registry.view<FireballBody, FireballHeading, FireballSpeed>().each(
+                [](FireballBody &body, const FireballHeading &heading, const FireballSpeed &speed) {
+                    integrate(body, heading, speed);
+                });
+        });
+
+        double checksum = 0.0;
+        for (entt::entity fireball : spawned) checksum += registry.get<FireballBody>(fireball).x;
+        return {perPass, spawnMicroseconds * 1000.0 / static_cast<double>(fireballs), checksum};
+    }
+
+    void print(const char *name, const Result &result) {
+        std::printf("%-18s integrate %9.1f us/pass   spawn+destroy %7.0f ns/fireball   (checksum %.1f)\n",
+                    name, result.integrate, result.spawn, result.checksum);
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t fireballs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+
+    std::printf("%zu fireballs and %zu tiles, %zu passes, chunks of %zu bytes\n", fireballs, TILES, frames,
+                Archetype::CHUNK_BYTES);
+    print("entt::registry", runEntt(fireballs, frames));
+    print("Registry sparse", runRegistry<StoragePolicy::SparseSet>(fireballs, frames));
+    print("Registry chunked", runRegistry<StoragePolicy::Chunked>(fireballs, frames));
+    return 0;
+}
@@ -0,0 +1,197 @@
+// Emits 10M events to 1, 4 and 16 listeners, once through the EventManager as it was (type_index map,
+// virtual listener, std::function) and once through the current one, immediately, enqueued with one
+// update() per 1000 events and posted from a second thread. Reports ns per event and heap allocations.
+//
+// usage: event_bench [events]
+
+#include "ecs/EventManager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+
+namespace {
+    std::atomic<uint64_t> allocations{0};
+}
+
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+namespace {
+    constexpr size_t BATCH = 1000;
+
+    struct Damaged : Event {
+        uint32_t entity = 0;
+        int amount = 0;
+    };
+
+    // EventManager before the channels.
+    class MapEventManager {
+    public:
+        template<typename EventType>
+        void emit(const EventType &event) const {
+            auto it = listeners.find(typeid(EventType));
+            if (it != listeners.end()) {
+                for (const auto &listener : it->second) {
+                    listener->handle(event);
+                }
+            }
+        }
+
+        template<typename EventType>
+        void subscribe(std::function<void(const EventType &)> callback) {
+            auto &listenersForType = listeners[typeid(EventType)];
+            listenersForType.emplace_back(std::make_unique<ConcreteListener<EventType>>(std::move(callback)));
+        }
+
+    private:
+        struct IListener {
+            virtual ~IListener() = default;
+            virtual void handle(const Event &event) const = 0;
+        };
+
+        template<typename EventType>
+        struct ConcreteListener : IListener {
+            explicit ConcreteListener(std::function<void(const EventType &)> cb)
+                : callback(std::move(cb)) {}
+
+            void handle(const Event &event) const override {
+                try {
+                    callback(static_cast<const EventType &>(event));
+                } catch (const std::bad_cast &) {
+                    throw std::runtime_error("Event type mismatch during handling.");
+                }
+            }
+
+        private:
+            std::function<void(const EventType &)> callback;
+        };
+
+        std::unordered_map<std::type_index, std::vector<std::unique_ptr<IListener>>> listeners;
+    };
+
+    struct HealthTracker {
+        int64_t total = 0;
+
+        void onDamaged(const Damaged &event) { total += event.amount; }
+    };
+
+    struct Cost {
+        double nanoseconds;
+        double allocations;
+    };
+
+    template<typename Func>
+    Cost measure(size_t events, Func &&func) {
+        const uint64_t allocationsBefore = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return {seconds * 1e9 / static_cast<double>(events),
+                static_cast<double>(allocations.load() - allocationsBefore)};
+    }
+
+    Damaged eventFor(size_t i) {
+        Damaged event;
+        event.entity = static_cast<uint32_t>(i);
+        event.amount = static_cast<int>(i & 7);
+        return event;
+    }
+
+    int64_t expectedTotal(size_t events, size_t listeners) {
+        int64_t total = 0;
+        for (size_t i = 0; i < events; ++i) total += static_cast<int64_t>(i & 7);
+        return total * static_cast<int64_t>(listeners);
+    }
+
+    int64_t sum(const std::vector<HealthTracker> &trackers) {
+        int64_t total = 0;
+        for (const auto &tracker : trackers) total += tracker.total;
+        return total;
+    }
+
+    void run(size_t events, size_t listenerCount) {
+        const int64_t expected = expectedTotal(events, listenerCount);
+        std::vector<HealthTracker> trackers(listenerCount);
+        bool correct = true;
+
+        MapEventManager map;
+        for (auto &tracker : trackers) {
+            map.subscribe<Damaged>([&tracker](const Damaged &event) { tracker.onDamaged(event); });
+        }
+        const Cost mapEmit = measure(events, [&] {
+            for (size_t i = 0; i < events; ++i) map.emit(eventFor(i));
+        });
+        correct &= sum(trackers) == expected;
+
+        EventManager manager;
+        for (auto &tracker : trackers) {
+            tracker.total = 0;
+            manager.subscribe<Damaged, &HealthTracker::onDamaged>(tracker);
+        }
+        const Cost emit = measure(events, [&] {
+            for (size_t i = 0; i < events; ++i) manager.emit(eventFor(i));
+        });
+        correct &= sum(trackers) == expected;
+
+        // two warm-up frames so both batch buffers have their capacity, then batched frames
+        for (size_t frame = 0; frame < 2; ++frame) {
+            for (size_t i = 0; i < BATCH; ++i) manager.enqueue(eventFor(i));
+            manager.update();
+        }
+        for (auto &tracker : trackers) tracker.total = 0;
+        const Cost queued = measure(events, [&] {
+            for (size_t i = 0; i < events; ++i) {
+                manager.enqueue(eventFor(i));
+                if ((i + 1) % BATCH == 0) manager.update();
+            }
+            manager.update();
+        });
+        correct &= sum(trackers) == expected;
+
+        // a producer thread posts, this one updates until all arrived
+        manager.post(eventFor(0));
+        manager.update();
+        for (auto &tracker : trackers) tracker.total = 0;
+        const Cost posted = measure(events, [&] {
+            std::thread producer([&manager, events] {
+                for (size_t i = 0; i < events; ++i) {
+                    while (!manager.post(eventFor(i))) std::this_thread::yield();
+                }
+            });
+            while (sum(trackers) != expected) {
+                manager.update();
+                std::this_thread::yield();
+            }
+            producer.join();
+        });
+
+        std::printf("%2zu listeners  map %6.1f ns %7.0f allocs   emit %6.1f ns %4.0f allocs   enqueue+update %6.1f ns %4.0f allocs"
+                    "   post+update %6.1f ns%s\n",
+                    listenerCount, mapEmit.nanoseconds, mapEmit.allocations, emit.nanoseconds, emit.allocations,
+                    queued.nanoseconds, queued.allocations, posted.nanoseconds, correct ? "" : "   MISMATCH");
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t events = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("%zu events per run, ns per event, allocations over the whole run, updates every %zu enqueues\n",
+                events, BATCH);
+    for (size_t listeners : {1, 4, 16}) {
+        run(events, listeners);
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Feeds small tasks from one outside thread, like the server's tick thread, into the ExecutorService as
+// it was (one locked std::queue of std::function, shared_ptr<packaged_task> per submit) and into the
+// work stealing one, through submit() and through execute(), on 1 to N workers. Tasks go in batches
+// of 1000 and each batch is waited for, like a tick waits for its lobbies. Reports tasks per second,
+// the p50 and p99 time of the enqueue call and heap allocations per task.
+//
+// usage: executor_bench [tasks] [max workers]
+
+#include "utils/ExecutorService.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <queue>
+
+namespace {
+    std::atomic<uint64_t> allocations{0};
+}
+
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+namespace {
+    // ExecutorService before the work stealing scheduler.
+    class LockedExecutor {
+    public:
+        explicit LockedExecutor(size_t threadCount) : stop(false) {
+            for (size_t i = 0; i < threadCount; i++) {
+                workers.emplace_back([this]() {
+                    while (true) {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock<std::mutex> lock(queueMutex);
+                            condition.wait(lock, [this]() { return stop || !tasks.empty(); });
+                            if (stop && tasks.empty()) return;
+                            task = std::move(tasks.front());
+                            tasks.pop();
+                        }
+                        task();
+                    }
+                });
+            }
+        }
+
+        template<typename F, typename... Args>
+        auto submit(F &&f, Args &&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+            using returnType = std::invoke_result_t<F, Args...>;
+
+            auto task = std::make_shared<std::packaged_task<returnType()>>(
+                std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+
+            std::future<returnType> result = task->get_future();
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                tasks.emplace([task]() { (*task)(); });
+            }
+            condition.notify_one();
+            return result;
+        }
+
+        ~LockedExecutor() {
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                stop = true;
+            }
+            condition.notify_all();
+            for (auto &worker : workers) worker.join();
+        }
+
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex queueMutex;
+        std::condition_variable condition;
+        bool stop;
+    };
+
+    struct Result {
+        double tasksPerSecond;
+        double p50;
+        double p99;
+        double allocationsPerTask;
+    };
+
+    constexpr size_t BATCH = 1000;
+
+    // enqueue(counter) queues one task that increments counter.
+    template<typename Enqueue>
+    Result run(size_t tasks, std::vector<uint32_t> &latencies, Enqueue &&enqueue) {
+        std::atomic<size_t> completed{0};
+
+        // a warm-up batch, the work stealing executor's free list fills here
+        for (size_t i = 0; i < BATCH; ++i) enqueue(completed);
+        while (completed.load() < BATCH) std::this_thread::yield();
+        completed = 0;
+
+        const uint64_t allocationsBefore = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < tasks; ++i) {
+            const auto before = std::chrono::steady_clock::now();
+            enqueue(completed);
+            latencies[i] = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - before).count());
+
+            if ((i + 1) % BATCH == 0) {
+                while (completed.load(std::memory_order_acquire) < i + 1) std::this_thread::yield();
+            }
+        }
+        while (completed.load(std::memory_order_acquire) < tasks) std::this_thread::yield();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const uint64_t allocated = allocations.load() - allocationsBefore;
+
+        std::sort(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(tasks));
+        return {static_cast<double>(tasks) / seconds, static_cast<double>(latencies[tasks / 2]),
+                static_cast<double>(latencies[tasks * 99 / 100]), static_cast<double>(allocated) / static_cast<double>(tasks)};
+    }
+
+    void print(const char *name, size_t workers, const Result &result) {
+        std::printf("%-18s %2zu workers  %10.0f tasks/s   enqueue p50 %6.0f ns  p99 %7.0f ns   %4.2f allocs/task\n",
+                    name, workers, result.tasksPerSecond, result.p50, result.p99, result.allocationsPerTask);
+    }
+
+    void increment(std::atomic<size_t> &counter) {
+        counter.fetch_add(1, std::memory_order_release);
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t maxWorkers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<uint32_t> latencies(tasks);
+    std::printf("%zu tasks per run, enqueued from one thread outside the pool in batches of %zu\n", tasks, BATCH);
+
+    for (size_t workers = 1; workers <= maxWorkers; workers *= 2) {
+        {
+            LockedExecutor executor(workers);
+            print("locked submit", workers, run(tasks, latencies, [&](std::atomic<size_t> &counter) {
+                executor.submit([&counter] { increment(counter); });
+            }));
+        }
+        {
+            ExecutorService executor(workers);
+            print("stealing submit", workers, run(tasks, latencies, [&](std::atomic<size_t> &counter) {
+                executor.submit([&counter] { increment(counter); });
+            }));
+            print("stealing execute", workers, run(tasks, latencies, [&](std::atomic<size_t> &counter) {
+                executor.execute([&counter] { increment(counter); });
+            }));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Feeds snapshots of a remote pawn and a fireball through SnapshotClock and InterpolationBuffer with
+// jittered, seeded arrival times and checks what a 144 fps client would draw: positions on the
+// server's path, no frame moving backwards, held positions while the pawn stands still, and the
+// fireball flying on through a gap in the snapshots. Exits with 1 when a check fails.
+//
+// usage: interpolation_check [seed]
+
+#include "network/SnapshotInterpolation.hpp"
+#include "entity/Components.hpp"
+#include "entity/PawnMovement.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+namespace {
+    constexpr double FPS = 144.0;
+    constexpr double LATENCY = 0.04;
+    constexpr double JITTER = 0.05;          // added to the latency, uniform
+    constexpr float TOLERANCE = 0.05f;       // snapshot positions are 1/16 of a unit
+    constexpr double MAX_EXTRAPOLATION = 0.25;
+
+    int failures = 0;
+
+    void check(bool passed, const char *what) {
+        std::printf("%s  %s\n", passed ? "ok  " : "FAIL", what);
+        if (!passed) ++failures;
+    }
+
+    float distance2d(const glm::vec3 &a, const glm::vec3 &b) {
+        return glm::length(glm::vec2(a.x - b.x, a.y - b.y));
+    }
+
+    // The pawn walks a square, stopping for a second on every corner.
+    glm::vec3 pawnPath(double time) {
+        constexpr double leg = 2.0, stop = 1.0;
+        const double lap = std::fmod(time, 4.0 * (leg + stop));
+        const int side = static_cast<int>(lap / (leg + stop));
+        const float walked = static_cast<float>(std::min(lap - side * (leg + stop), leg)) * PawnMovement::BASE_SPEED;
+        const float length = static_cast<float>(leg) * PawnMovement::BASE_SPEED;
+
+        switch (side) {
+            case 0: return {walked, 0.0f, 0.0f};
+            case 1: return {length, walked, 0.0f};
+            case 2: return {length - walked, length, 0.0f};
+            default: return {0.0f, length - walked, 0.0f};
+        }
+    }
+
+    struct Arrival {
+        double time;
+        uint32_t tick;
+        EntitySnapshot pawn;
+        EntitySnapshot fireball;
+        bool pawnChanged;
+    };
+}
+
+int main(int argc, char **argv) {
+    std::mt19937 random(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    const float aim = 0.7f;
+    const glm::vec3 fireballStart{-500.0f, 300.0f, 3.0f};
+    const glm::vec3 fireballVelocity = FireballComponent::velocityFor(aim);
+    const auto fireballPath = [&](double time) { return fireballStart + fireballVelocity * static_cast<float>(time); };
+
+    // snapshots the lobby sends for 20 s, over one in-order connection; 300 ms of them are lost
+    std::deque<Arrival> arrivals;
+    double lastArrival = 0.0;
+    const uint32_t lastTick = 20 * SnapshotCodec::TICK_RATE;
+    const double gapStart = 10.0, gapEnd = 10.3;
+    EntitySnapshot previousPawn;
+    for (uint32_t tick = 1; tick <= lastTick; ++tick) {
+        const double serverTime = SnapshotClock::serverTime(tick);
+        if (serverTime >= gapStart && serverTime < gapEnd) continue;
+
+        Arrival arrival{0.0, tick, {}, {}, false};
+        arrival.pawn.setPosition(pawnPath(serverTime));
+        arrival.fireball.setPosition(fireballPath(serverTime));
+        arrival.fireball.rotation = EntitySnapshot::quantizeAngle(aim);
+        arrival.pawnChanged = !(arrival.pawn == previousPawn); // a delta leaves out unchanged entities
+        previousPawn = arrival.pawn;
+
+        lastArrival = std::max(lastArrival, serverTime + LATENCY + unit(random) * JITTER);
+        arrival.time = lastArrival;
+        arrivals.push_back(arrival);
+    }
+
+    SnapshotClock clock;
+    InterpolationBuffer pawn, fireball;
+    uint32_t previousTick = 0;
+
+    float pawnError = 0.0f, fireballError = 0.0f, gapError = 0.0f, stillDrift = 0.0f;
+    double previousRender = -1.0, behind = 0.0;
+    size_t frames = 0, backwards = 0, pastNewest = 0;
+    glm::vec3 previousPawnShown{0.0f};
+    float rawStep = 0.0f, smoothStep = 0.0f;  // largest per frame move, snapped and interpolated
+    glm::vec3 rawShown{0.0f}, rawPrevious{0.0f};
+    double newestTime = 0.0;
+
+    const double end = SnapshotClock::serverTime(lastTick);
+    for (double now = 0.0; now < end; now += (1.0 + (unit(random) - 0.5) * 0.2) / FPS) {
+        while (!arrivals.empty() && arrivals.front().time <= now) {
+            const Arrival &arrival = arrivals.front();
+            clock.onSnapshot(arrival.tick, now);
+
+            const double serverTime = SnapshotClock::serverTime(arrival.tick);
+            if (arrival.pawnChanged) {
+                if (previousTick) pawn.hold(SnapshotClock::serverTime(previousTick));
+                pawn.push(serverTime, arrival.pawn.getPosition());
+                rawShown = arrival.pawn.getPosition();
+            }
+            fireball.push(serverTime, arrival.fireball.getPosition());
+            newestTime = serverTime;
+            previousTick = arrival.tick;
+            arrivals.pop_front();
+        }
+
+        if (!clock.isSynced() || now < 1.0) continue; // one second to settle
+
+        const double render = clock.renderTime(now);
+        const glm::vec3 pawnShown = pawn.sample(render);
+        const glm::vec3 fireballShown = fireball.sample(render, &fireballVelocity, MAX_EXTRAPOLATION);
+        const bool inGap = render >= gapStart - SnapshotClock::TICK_INTERVAL && render < gapEnd + SnapshotClock::TICK_INTERVAL;
+
+        if (frames++ > 0) {
+            if (render < previousRender) ++backwards;
+            if (!inGap) { // a pawn is not extrapolated, it catches up once the snapshots are back
+                smoothStep = std::max(smoothStep, distance2d(pawnShown, previousPawnShown));
+                rawStep = std::max(rawStep, distance2d(rawShown, rawPrevious));
+            }
+        }
+        if (render > newestTime && !inGap) ++pastNewest;
+        behind = std::max(behind, newestTime - render);
+        previousRender = render;
+
+        if (!inGap) {
+            pawnError = std::max(pawnError, distance2d(pawnShown, pawnPath(render)));
+            fireballError = std::max(fireballError, distance2d(fireballShown, fireballPath(render)));
+        } else if (render - (gapStart - SnapshotClock::TICK_INTERVAL) <= MAX_EXTRAPOLATION) {
+            gapError = std::max(gapError, distance2d(fireballShown, fireballPath(render)));
+        }
+
+        // standing on a corner, the 1/16 rounding aside nothing may move
+        if (pawnPath(render) == pawnPath(render - 1.0 / FPS) && pawnPath(render) == pawnPath(render + 0.2)) {
+            stillDrift = std::max(stillDrift, distance2d(pawnShown, previousPawnShown));
+        }
+
+        previousPawnShown = pawnShown;
+        rawPrevious = rawShown;
+    }
+
+    std::printf("%zu frames, delay %.0f ms, latency %.0f-%.0f ms, largest pawn move per frame: %.2f snapped, %.2f interpolated\n",
+                frames, clock.getDelay() * 1000.0, LATENCY * 1000.0, (LATENCY + JITTER) * 1000.0, rawStep, smoothStep);
+
+    check(backwards == 0, "render time never runs backwards");
+    check(pastNewest == 0, "render time stays behind the newest snapshot outside the gap");
+    check(pawnError <= TOLERANCE, "pawn is drawn on the server path");
+    check(stillDrift <= TOLERANCE, "pawn holds still while it stands on a corner");
+    check(smoothStep <= PawnMovement::BASE_SPEED / FPS * 1.5f, "pawn moves at most a frame's walk per frame");
+    check(fireballError <= TOLERANCE, "fireball is drawn on its path");
+    check(gapError <= 0.5f, "fireball flies on through lost snapshots");
+
+    std::printf("max error: pawn %.3f, fireball %.3f, fireball in gap %.3f, render time behind newest %.0f ms\n",
+                pawnError, fireballError, gapError, behind * 1000.0);
+    return failures == 0 ? 0 : 1;
+}
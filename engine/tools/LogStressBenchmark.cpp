@@ -0,0 +1,121 @@
+// N threads log AT_INFO "Creating fireball for player {}" in bursts every 60 Hz tick, the way lobby
+// threads do when players fire, once through the synchronous logger as it was (std::format into a
+// string, std::cout with std::endl on the calling thread) and once through the queued Log. Reports the
+// caller-side p50, p99 and max per call and the records the queue dropped. Results go to stderr,
+// redirect stdout to compare a terminal, a file or /dev/null.
+//
+// usage: log_stress_bench [threads] [messages per second per thread] [seconds] > /dev/null
+
+#include "core/Log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int TICK_RATE = 60;
+
+    // Log before the queue, with the color and time formatting it did per call.
+    class SyncLog {
+    public:
+        template<typename... Args>
+        void log(LogLevel level, const std::format_string<Args...> &formatString, Args &&... args) {
+            const std::string message = std::format(formatString, std::forward<Args>(args)...);
+            std::cout << "\033[35m";
+            std::cout << "[" << getCurrentTime() << "/" << (level == LogLevel::Info ? "Info" : "Warn") << "]: "
+                      << message << std::endl;
+            std::cout << "\033[0m";
+        }
+
+    private:
+        static std::string getCurrentTime() {
+            auto now = std::chrono::system_clock::now();
+            auto in_time_t = std::chrono::system_clock::to_time_t(now);
+            std::ostringstream oss;
+            oss << std::put_time(std::localtime(&in_time_t), "%H:%M:%S");
+            return oss.str();
+        }
+    };
+
+    struct Result {
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        size_t calls = 0;
+    };
+
+    // Each thread logs its share of a tick in one burst, then sleeps to the next tick.
+    template<typename LogFunction>
+    Result run(int threads, int rate, int seconds, LogFunction logFunction) {
+        const int perTick = std::max(1, rate / TICK_RATE);
+        const int ticks = seconds * TICK_RATE;
+        std::vector<std::vector<float>> latencies(threads);
+
+        std::vector<std::thread> workers;
+        const auto start = Clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                auto &samples = latencies[t];
+                samples.reserve(static_cast<size_t>(perTick) * ticks);
+                auto next = start;
+                for (int tick = 0; tick < ticks; ++tick) {
+                    for (int i = 0; i < perTick; ++i) {
+                        const auto before = Clock::now();
+                        logFunction(static_cast<uint64_t>(t) * 1000 + i);
+                        samples.push_back(std::chrono::duration<float, std::micro>(Clock::now() - before).count());
+                    }
+                    next += std::chrono::microseconds(1'000'000 / TICK_RATE);
+                    std::this_thread::sleep_until(next);
+                }
+            });
+        }
+        for (auto &worker : workers) worker.join();
+
+        std::vector<float> all;
+        for (const auto &samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+        std::sort(all.begin(), all.end());
+
+        Result result;
+        result.calls = all.size();
+        if (!all.empty()) {
+            result.p50 = all[all.size() / 2];
+            result.p99 = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+            result.max = all.back();
+        }
+        return result;
+    }
+
+    void report(const char *name, const Result &result) {
+        std::fprintf(stderr, "%-6s %9zu calls  p50 %8.2f us  p99 %9.2f us  max %10.2f us\n",
+                     name, result.calls, result.p50, result.p99, result.max);
+    }
+}
+
+int main(int argc, char **argv) {
+    const int threads = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int rate = argc > 2 ? std::atoi(argv[2]) : 3000;
+    const int seconds = argc > 3 ? std::atoi(argv[3]) : 3;
+
+    std::fprintf(stderr, "%d threads, %d messages/s each, %d s\n", threads, rate, seconds);
+
+    SyncLog syncLog;
+    report("sync", run(threads, rate, seconds, [&](uint64_t playerId) {
+        syncLog.log(LogLevel::Info, "Creating fireball for player {}", playerId);
+    }));
+
+    Log::init();
+    report("queued", run(threads, rate, seconds, [](uint64_t playerId) {
+        AT_INFO("Creating fireball for player {}", playerId);
+    }));
+    Log::getCoreLogger()->flush();
+    std::fprintf(stderr, "queued dropped %llu records\n",
+                 static_cast<unsigned long long>(Log::getCoreLogger()->getDroppedRecords()));
+    return 0;
+}
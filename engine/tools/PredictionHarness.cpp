@@ -0,0 +1,203 @@
+// Headless client and lobby connected by a simulated link. The client moves its pawn with
+// PawnPrediction and reconciles it against the snapshots, the lobby side applies the inputs the way
+// Lobby::update does. Reports how far the pawn the client shows is from the position the server
+// reaches after the same inputs, once with prediction and once showing the last snapshot only, and
+// how much input time the server applied against the time that passed. A dt scale above 1 makes the
+// client claim longer frames than it had, like a speed hack.
+//
+// usage: prediction_harness [rtt ms] [seconds] [jitter ms] [fps] [dt scale]
+
+#include "network/PawnPrediction.hpp"
+#include "network/SnapshotCodec.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+namespace {
+    constexpr double TICK = 1.0 / 30.0;
+    constexpr float MAX_INPUT_BURST = 0.2f; // Lobby::MAX_INPUT_BURST
+    const glm::vec2 TILE = {100.0f, 100.0f};
+
+    struct Wall {
+        glm::vec3 position;
+        glm::vec2 scale;
+    };
+
+    struct InFlightInput {
+        double arrival;
+        PlayerInput input;
+    };
+
+    struct InFlightSnapshot {
+        double arrival;
+        EntitySnapshot pawn;
+    };
+
+    struct Frame {
+        uint32_t sequence;
+        glm::vec3 predicted;
+        glm::vec3 snapshotOnly;
+    };
+
+    // A 20x20 tile room with pillars, so the pawn keeps sliding along walls.
+    std::vector<Wall> buildRoom() {
+        std::vector<Wall> walls;
+        for (int row = -10; row < 10; ++row) {
+            for (int column = -10; column < 10; ++column) {
+                const bool border = row == -10 || row == 9 || column == -10 || column == 9;
+                const bool pillar = row % 4 == 2 && column % 4 == 2;
+                if (border || pillar) {
+                    walls.push_back({{(column + 0.5f) * TILE.x, (row + 0.5f) * TILE.y, 5.0f}, TILE});
+                }
+            }
+        }
+        return walls;
+    }
+
+    struct Stats {
+        double mean = 0.0;
+        float p95 = 0.0f;
+        float max = 0.0f;
+    };
+
+    Stats summarize(std::vector<float> errors) {
+        Stats stats;
+        if (errors.empty()) return stats;
+        std::ranges::sort(errors);
+        for (const float error: errors) stats.mean += error;
+        stats.mean /= static_cast<double>(errors.size());
+        stats.p95 = errors[errors.size() * 95 / 100];
+        stats.max = errors.back();
+        return stats;
+    }
+}
+
+int main(int argc, char **argv) {
+    const double rtt = (argc > 1 ? std::atof(argv[1]) : 150.0) / 1000.0;
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 60.0;
+    const double jitter = (argc > 3 ? std::atof(argv[3]) : 10.0) / 1000.0;
+    const double fps = argc > 4 ? std::atof(argv[4]) : 144.0;
+    const float dtScale = argc > 5 ? static_cast<float>(std::atof(argv[5])) : 1.0f;
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const auto oneWay = [&] { return rtt / 2.0 + (unit(random) * 2.0 - 1.0) * jitter; };
+
+    const std::vector<Wall> walls = buildRoom();
+    const glm::vec3 spawn{-50.0f, -50.0f, 0.0f};
+    const glm::vec2 pawnScale = TILE;
+
+    // server side
+    glm::vec3 serverPosition = spawn;
+    uint32_t lastProcessed = 0;
+    float inputTime = 0.0f;      // banked like Lobby::inputTime
+    double appliedSeconds = 0.0; // input time the server moved the pawn by
+    double tickedSeconds = 0.0;
+    std::vector<glm::vec3> serverPositions(1, spawn); // by input sequence
+    std::deque<InFlightInput> toServer;
+    const auto blocked = [&](const glm::vec3 &at) {
+        return std::ranges::any_of(walls, [&](const Wall &wall) {
+            return PawnMovement::hitsWall(at, pawnScale, wall.position, wall.scale);
+        });
+    };
+
+    // client side
+    PawnPrediction prediction;
+    for (const auto &wall: walls) prediction.addWall(wall.position, wall.scale);
+    glm::vec3 snapshotPosition = spawn;
+    std::deque<InFlightSnapshot> toClient;
+    PlayerInput held;
+    double nextTurn = 0.0;
+    uint32_t sequence = 0;
+    double lastInputArrival = 0.0, lastSnapshotArrival = 0.0; // one websocket each way, nothing overtakes
+
+    std::vector<Frame> frames;
+    std::vector<float> corrections;
+
+    double now = 0.0, nextTick = 0.0, nextFrame = 0.0;
+    while (now < seconds) {
+        if (nextTick <= nextFrame) {
+            now = nextTick;
+            nextTick += TICK;
+
+            tickedSeconds += TICK;
+            inputTime = std::min(inputTime + static_cast<float>(TICK), MAX_INPUT_BURST);
+            while (!toServer.empty() && toServer.front().arrival <= now) {
+                const PlayerInput &input = toServer.front().input;
+                const float step = std::min(std::max(input.deltaTime, 0.0f), inputTime);
+                inputTime -= step;
+                appliedSeconds += step;
+                PawnMovement::move(serverPosition, input, step, blocked);
+                lastProcessed = input.sequence;
+                serverPositions.resize(std::max<size_t>(serverPositions.size(), input.sequence + 1));
+                serverPositions[input.sequence] = serverPosition;
+                toServer.pop_front();
+            }
+
+            EntitySnapshot pawn;
+            pawn.hasPawn = true;
+            pawn.setPosition(serverPosition);
+            pawn.setScale(pawnScale);
+            pawn.lastInputSequence = lastProcessed;
+            lastSnapshotArrival = std::max(lastSnapshotArrival, now + oneWay());
+            toClient.push_back({lastSnapshotArrival, pawn});
+            continue;
+        }
+
+        now = nextFrame;
+        const float deltaTime = static_cast<float>((1.0 + (unit(random) - 0.5) * 0.2) / fps);
+        nextFrame += deltaTime;
+
+        while (!toClient.empty() && toClient.front().arrival <= now) {
+            const EntitySnapshot &pawn = toClient.front().pawn;
+            snapshotPosition = pawn.getPosition();
+            const float correction = prediction.reconcile(pawn.getPosition(), pawn.getScale(), pawn.lastInputSequence);
+            if (prediction.getPendingInputs() > 0 || correction > 0.0f) corrections.push_back(correction);
+            toClient.pop_front();
+        }
+
+        // hold a direction for a while, like a player would
+        if (now >= nextTurn) {
+            const int keys = static_cast<int>(unit(random) * 16.0);
+            held.moveForward = keys & 1;
+            held.moveBackwards = keys & 2;
+            held.moveLeft = keys & 4;
+            held.moveRight = keys & 8;
+            nextTurn = now + 0.2 + unit(random) * 0.8;
+        }
+
+        PlayerInput input = held;
+        input.sequence = ++sequence;
+        input.deltaTime = deltaTime * dtScale;
+        prediction.predict(input);
+        lastInputArrival = std::max(lastInputArrival, now + oneWay());
+        toServer.push_back({lastInputArrival, input});
+
+        // nothing to predict from before the first snapshot
+        frames.push_back({input.sequence, prediction.hasPosition() ? prediction.getPosition() : snapshotPosition, snapshotPosition});
+    }
+
+    // compare each frame with where the server put the pawn after the same input
+    std::vector<float> predictedErrors, snapshotErrors;
+    for (const Frame &frame: frames) {
+        if (frame.sequence >= serverPositions.size() || frame.sequence > lastProcessed) continue;
+        predictedErrors.push_back(glm::distance(frame.predicted, serverPositions[frame.sequence]));
+        snapshotErrors.push_back(glm::distance(frame.snapshotOnly, serverPositions[frame.sequence]));
+    }
+
+    const Stats predicted = summarize(predictedErrors);
+    const Stats snapshotOnly = summarize(snapshotErrors);
+    const Stats corrected = summarize(corrections);
+
+    std::printf("rtt %.0f ms (+-%.0f), client %.0f fps, server %.0f Hz, %.0f s, %zu frames compared\n",
+                rtt * 1000.0, jitter * 1000.0, fps, 1.0 / TICK, seconds, predictedErrors.size());
+    std::printf("error in world units (pawn speed %.0f/s)   mean      p95      max\n", PawnMovement::BASE_SPEED);
+    std::printf("predicted                         %10.3f %8.3f %8.3f\n", predicted.mean, predicted.p95, predicted.max);
+    std::printf("snapshot only                     %10.3f %8.3f %8.3f\n", snapshotOnly.mean, snapshotOnly.p95, snapshotOnly.max);
+    std::printf("reconcile corrections             %10.3f %8.3f %8.3f  (%zu snapshots)\n",
+                corrected.mean, corrected.p95, corrected.max, corrections.size());
+    std::printf("input time applied %.2f s over %.2f s of ticks (client dt scale %.2f)\n",
+                appliedSeconds, tickedSeconds, dtScale);
+    return 0;
+}
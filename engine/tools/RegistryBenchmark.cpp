@@ -0,0 +1,75 @@
+// Times the engine ECS Registry: MovementSystem over view<Position, Velocity>() with 1M entities, and
+// entity churn, creating entities with components and destroying them again in a different order.
+//
+// usage: registry_bench [entities] [churn rounds]
+
+#include "ecs/System.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+    double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t entityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t churnRounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+    {
+        Registry registry;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < entityCount; ++i) {
+            Actor actor = registry.createEntity();
+            actor.addComponent<Position>(Position{static_cast<float>(i), 0.0f});
+            if (i % 2 == 0) actor.addComponent<Velocity>(Velocity{1.0f, 0.5f});
+            if (i % 4 == 0) actor.addComponent<Health>(Health{100});
+        }
+        const double createMs = millisecondsSince(start);
+
+        MovementSystem movement;
+        constexpr int frames = 10;
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            movement.update(registry, 1.0f / 60.0f);
+        }
+        const double updateMs = millisecondsSince(start) / frames;
+
+        double checksum = 0.0;
+        for (auto [actor, position]: registry.view<Position>()) checksum += position.y;
+
+        std::printf("%zu entities, half with Velocity: create %.1f ms, MovementSystem::update %.2f ms/frame (checksum %.1f)\n",
+                    entityCount, createMs, updateMs, checksum);
+    }
+
+    {
+        Registry registry;
+        std::mt19937 random(3);
+        std::vector<Actor> actors;
+        actors.reserve(entityCount / 10);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t operations = 0;
+        for (size_t round = 0; round < churnRounds; ++round) {
+            for (size_t i = 0; i < entityCount / 10; ++i) {
+                Actor actor = registry.createEntity();
+                actor.addComponent<Position>(Position{0.0f, 0.0f});
+                actor.addComponent<Velocity>(Velocity{1.0f, 1.0f});
+                actors.push_back(actor);
+            }
+            std::shuffle(actors.begin(), actors.end(), random);
+            for (const Actor &actor: actors) registry.destroyEntity(actor);
+            operations += actors.size() * 2;
+            actors.clear();
+        }
+        const double churnMs = millisecondsSince(start);
+
+        std::printf("churn: %zu rounds of %zu entities created and destroyed, %.1f ms, %.0f ns per create or destroy\n",
+                    churnRounds, entityCount / 10, churnMs, churnMs * 1e6 / static_cast<double>(operations));
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Frame time of four systems over 1M entities run one after another on the calling thread and through
+// the Scheduler on 1 to 16 workers, where independent systems overlap and every view is split with
+// parallelEach. Speedups are against the sequential run, they are capped by the machine's core count.
+//
+// usage: scheduler_bench [entities] [frames]
+
+#include "ecs/Scheduler.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+    struct Steering {
+        float targetX;
+        float targetY;
+    };
+
+    struct Heat {
+        float value;
+    };
+
+    // Turns the velocity towards the target, a few transcendental calls per entity.
+    class SteeringSystem : public System<Reads<Steering, Position>, Writes<Velocity>> {
+    public:
+        void update(Registry &registry, float deltaTime) override {
+            forEach(registry.view<Velocity, Position, Steering>(),
+                    [deltaTime](Velocity &velocity, const Position &position, const Steering &steering) {
+                        const float angle = std::atan2(steering.targetY - position.y, steering.targetX - position.x);
+                        velocity.dx += (std::cos(angle) * 100.0f - velocity.dx) * deltaTime;
+                        velocity.dy += (std::sin(angle) * 100.0f - velocity.dy) * deltaTime;
+                    });
+        }
+    };
+
+    class CoolingSystem : public System<Reads<>, Writes<Heat>> {
+    public:
+        void update(Registry &registry, float deltaTime) override {
+            forEach(registry.view<Heat>(), [deltaTime](Heat &heat) {
+                heat.value = heat.value * std::exp(-deltaTime) + std::sin(heat.value) * 0.01f;
+            });
+        }
+    };
+
+    class DecaySystem : public System<Reads<Heat>, Writes<Health>> {
+    public:
+        void update(Registry &registry, float /*deltaTime*/) override {
+            forEach(registry.view<Health, Heat>(), [](Health &health, const Heat &heat) {
+                if (heat.value > 50.0f) health.hp -= 1;
+            });
+        }
+    };
+
+    template<typename Schedule>
+    double millisecondsPerFrame(size_t frames, Schedule &&schedule) {
+        schedule(); // warm up, pools and executor tasks
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t frame = 0; frame < frames; ++frame) {
+            schedule();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+               / static_cast<double>(frames);
+    }
+
+    void populate(Registry &registry, size_t entityCount) {
+        for (size_t i = 0; i < entityCount; ++i) {
+            const float offset = static_cast<float>(i % 1000);
+            Actor actor = registry.createEntity();
+            actor.addComponent<Position>(Position{offset, -offset});
+            actor.addComponent<Velocity>(Velocity{1.0f, 0.0f});
+            actor.addComponent<Steering>(Steering{500.0f - offset, offset});
+            actor.addComponent<Heat>(Heat{offset * 0.1f});
+            if (i % 2 == 0) actor.addComponent<Health>(Health{100});
+        }
+    }
+
+    void addSystems(Scheduler &scheduler) {
+        scheduler.addSystem<SteeringSystem>();
+        scheduler.addSystem<MovementSystem>();
+        scheduler.addSystem<CoolingSystem>();
+        scheduler.addSystem<DecaySystem>();
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t entityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    constexpr float deltaTime = 1.0f / 30.0f;
+
+    Registry registry;
+    populate(registry, entityCount);
+
+    std::printf("%zu entities, 4 systems, %zu frames, %u hardware threads\n", entityCount, frames,
+                std::thread::hardware_concurrency());
+
+    double sequential;
+    {
+        SteeringSystem steering;
+        MovementSystem movement;
+        CoolingSystem cooling;
+        DecaySystem decay;
+        sequential = millisecondsPerFrame(frames, [&] {
+            steering.update(registry, deltaTime);
+            movement.update(registry, deltaTime);
+            cooling.update(registry, deltaTime);
+            decay.update(registry, deltaTime);
+        });
+        std::printf("sequential          %8.2f ms/frame\n", sequential);
+    }
+
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+        ExecutorService executor(threads);
+        Scheduler scheduler(executor);
+        addSystems(scheduler);
+
+        const double scheduled = millisecondsPerFrame(frames, [&] { scheduler.update(registry, deltaTime); });
+        std::printf("scheduler %2zu workers %8.2f ms/frame  %5.2fx\n", threads, scheduled, sequential / scheduled);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Runs the same systems over the same seeded world once one after another without an executor and once
+// through the Scheduler on 1, 2, 4 and 8 workers, and checks the component state matches bit for bit
+// after every frame. Also checks the dependency graph lets the independent systems start together.
+// Exits with 1 when a check fails.
+//
+// usage: scheduler_check [entities] [frames] [seed]
+
+#include "ecs/Scheduler.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace {
+    struct Heat {
+        float value;
+    };
+
+    int failures = 0;
+
+    void check(bool passed, const char *what) {
+        std::printf("%s  %s\n", passed ? "ok  " : "FAIL", what);
+        if (!passed) ++failures;
+    }
+
+    // Slows everything down, after MovementSystem because it writes what that one reads.
+    class DragSystem : public System<Reads<>, Writes<Velocity>> {
+    public:
+        void update(Registry &registry, float deltaTime) override {
+            forEach(registry.view<Velocity>(), [deltaTime](Velocity &velocity) {
+                velocity.dx -= velocity.dx * 0.5f * deltaTime;
+                velocity.dy -= velocity.dy * 0.5f * deltaTime;
+            });
+        }
+    };
+
+    // Hurts whatever is outside the arena.
+    class ArenaSystem : public System<Reads<Position>, Writes<Health>> {
+    public:
+        void update(Registry &registry, float /*deltaTime*/) override {
+            forEach(registry.view<Health, Position>(), [](Health &health, const Position &position) {
+                if (std::abs(position.x) > 500.0f || std::abs(position.y) > 500.0f) health.hp -= 1;
+            });
+        }
+    };
+
+    // Touches nothing the others do, it can run next to all of them.
+    class CoolingSystem : public System<Reads<>, Writes<Heat>> {
+    public:
+        void update(Registry &registry, float deltaTime) override {
+            forEach(registry.view<Heat>(), [deltaTime](Heat &heat) {
+                heat.value = heat.value * std::exp(-deltaTime) + std::sin(heat.value) * 0.01f;
+            });
+        }
+    };
+
+    void populate(Registry &registry, size_t entityCount, unsigned seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> coordinate(-600.0f, 600.0f);
+        std::uniform_real_distribution<float> speed(-80.0f, 80.0f);
+        for (size_t i = 0; i < entityCount; ++i) {
+            Actor actor = registry.createEntity();
+            actor.addComponent<Position>(Position{coordinate(random), coordinate(random)});
+            if (random() % 4 != 0) actor.addComponent<Velocity>(Velocity{speed(random), speed(random)});
+            if (random() % 2 == 0) actor.addComponent<Health>(Health{100});
+            if (random() % 3 == 0) actor.addComponent<Heat>(Heat{coordinate(random)});
+        }
+    }
+
+    // FNV-1a over every component's bytes, in entity order.
+    uint64_t hashState(Registry &registry) {
+        uint64_t hash = 1469598103934665603ull;
+        const auto mix = [&hash](const void *data, size_t size) {
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        for (auto [actor, position] : registry.view<Position>()) {
+            const Actor::IdType id = actor.getId();
+            mix(&id, sizeof(id));
+            mix(&position, sizeof(position));
+            if (auto *velocity = actor.getComponent<Velocity>()) mix(velocity, sizeof(*velocity));
+            if (auto *health = actor.getComponent<Health>()) mix(health, sizeof(*health));
+            if (auto *heat = actor.getComponent<Heat>()) mix(heat, sizeof(*heat));
+        }
+        return hash;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t entityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    const size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 60;
+    const unsigned seed = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 1;
+    constexpr float deltaTime = 1.0f / 30.0f;
+
+    // the reference: plain update() calls in registration order, no executor anywhere
+    std::vector<uint64_t> expected;
+    {
+        Registry registry;
+        populate(registry, entityCount, seed);
+        MovementSystem movement;
+        DragSystem drag;
+        ArenaSystem arena;
+        CoolingSystem cooling;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            movement.update(registry, deltaTime);
+            drag.update(registry, deltaTime);
+            arena.update(registry, deltaTime);
+            cooling.update(registry, deltaTime);
+            expected.push_back(hashState(registry));
+        }
+    }
+
+    for (size_t threads : {1, 2, 4, 8}) {
+        ExecutorService executor(threads);
+        Scheduler scheduler(executor);
+        scheduler.addSystem<MovementSystem>();
+        scheduler.addSystem<DragSystem>();
+        scheduler.addSystem<ArenaSystem>();
+        scheduler.addSystem<CoolingSystem>();
+
+        Registry registry;
+        populate(registry, entityCount, seed);
+
+        size_t firstMismatch = frames;
+        for (size_t frame = 0; frame < frames; ++frame) {
+            scheduler.update(registry, deltaTime);
+            if (firstMismatch == frames && hashState(registry) != expected[frame]) firstMismatch = frame;
+        }
+
+        char what[128];
+        if (firstMismatch == frames) {
+            std::snprintf(what, sizeof(what), "%zu workers: %zu frames match the sequential run", threads, frames);
+        } else {
+            std::snprintf(what, sizeof(what), "%zu workers: state differs from frame %zu on", threads, firstMismatch);
+        }
+        check(firstMismatch == frames, what);
+
+        if (threads == 1) {
+            // MovementSystem and CoolingSystem start the frame, Drag and Arena wait on Movement
+            check(scheduler.rootCount() == 2, "independent systems start together");
+        }
+    }
+
+    std::printf("%zu entities, %zu frames, seed %u\n", entityCount, frames, seed);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+// Bytes per tick and encode time of the lobby broadcast: the JSON game state the lobby used to build
+// from its dirty entities and dump once per connection, against one SnapshotCodec delta per tick
+// against the snapshot the clients acknowledged, shared by every connection. Runs a 50x50 map with 4
+// walking pawns and a steady number of fireballs, walls are destroyed now and then.
+//
+// usage: snapshot_codec_bench [fireballs] [ticks] [ack lag in ticks]
+
+#include "network/SnapshotCodec.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+    constexpr uint32_t WALL = 10040;
+    constexpr uint32_t PATH = 10048;
+    constexpr uint32_t FIREBALL = 10110;
+    constexpr size_t TILES = 2500;
+    constexpr size_t PAWNS = 4;
+    constexpr size_t CONNECTIONS = PAWNS;
+    constexpr float PAWN_STEP = 100.0f / 30.0f; // PawnMovement::BASE_SPEED over one tick
+
+    class World {
+    public:
+        World(size_t fireballs, uint32_t seed) : fireballs(fireballs), random(seed) {
+            for (size_t i = 0; i < TILES; ++i) {
+                EntitySnapshot tile;
+                tile.networkId = nextId++;
+                tile.tileCode = i % 3 == 0 ? WALL : PATH;
+                tile.setPosition({static_cast<float>(i % 50) * 100.0f - 2450.0f, static_cast<float>(i / 50) * 100.0f - 2450.0f, 5.0f});
+                tile.setScale({100.0f, 100.0f});
+                tile.hasRigidbody = tile.tileCode == WALL;
+                tile.isSolid = tile.hasRigidbody;
+                entities.push_back(tile);
+            }
+            for (size_t i = 0; i < PAWNS; ++i) {
+                EntitySnapshot pawn;
+                pawn.networkId = nextId++;
+                pawn.tileCode = 10000;
+                pawn.setPosition({-2400.0f + 1600.0f * static_cast<float>(i), 2400.0f, 0.0f});
+                pawn.setScale({100.0f, 100.0f});
+                pawn.hasPawn = true;
+                pawn.playerId = 100 + i;
+                entities.push_back(pawn);
+            }
+            while (fireballCount() < fireballs) shoot();
+        }
+
+        // Fills dirty with the ids of the entities that changed, the ones the lobby marked dirty.
+        void step(std::vector<uint64_t> &dirty, std::vector<uint64_t> &deleted) {
+            dirty.clear();
+            deleted.clear();
+            std::uniform_int_distribution<int> percent(0, 99);
+
+            for (auto &entity : entities) {
+                if (entity.hasPawn) {
+                    const glm::vec3 position = entity.getPosition();
+                    const float step = PAWN_STEP * (percent(random) < 50 ? 1.0f : -1.0f);
+                    entity.setPosition({position.x + step, position.y, position.z});
+                    entity.pawnFlags = EntitySnapshot::MOVE_RIGHT;
+                    entity.aimRotation = static_cast<uint16_t>(entity.aimRotation + 300);
+                    ++entity.lastInputSequence;
+                    dirty.push_back(entity.networkId);
+                } else if (entity.tileCode == FIREBALL) {
+                    const glm::vec3 position = entity.getPosition();
+                    entity.setPosition({position.x + 10.0f, position.y - 5.0f, 3.0f});
+                    dirty.push_back(entity.networkId);
+                }
+            }
+
+            if (percent(random) < 10) {
+                auto &tile = entities[std::uniform_int_distribution<size_t>(0, TILES - 1)(random)];
+                if (tile.tileCode == WALL) {
+                    tile.tileCode = PATH;
+                    tile.isSolid = false;
+                    dirty.push_back(tile.networkId);
+                }
+            }
+
+            std::erase_if(entities, [&](const EntitySnapshot &entity) {
+                if (entity.tileCode != FIREBALL || percent(random) >= 3) return false;
+                deleted.push_back(entity.networkId);
+                return true;
+            });
+            while (fireballCount() < fireballs) {
+                shoot();
+                dirty.push_back(entities.back().networkId);
+            }
+        }
+
+        const std::vector<EntitySnapshot> &getEntities() const { return entities; }
+
+    private:
+        size_t fireballs;
+        std::mt19937 random;
+        std::vector<EntitySnapshot> entities;
+        uint64_t nextId = 1;
+
+        size_t fireballCount() const {
+            return std::ranges::count(entities, FIREBALL, &EntitySnapshot::tileCode);
+        }
+
+        void shoot() {
+            std::uniform_real_distribution<float> spread(-2000.0f, 2000.0f);
+            EntitySnapshot fireball;
+            fireball.networkId = nextId++;
+            fireball.tileCode = FIREBALL;
+            fireball.setPosition({spread(random), spread(random), 3.0f});
+            fireball.rotation = EntitySnapshot::quantizeAngle(spread(random) * 0.001f);
+            fireball.setScale({100.0f, 100.0f});
+            entities.push_back(fireball);
+        }
+    };
+
+    // The broadcast before SnapshotCodec: a json document of the dirty entities, dumped per connection.
+    size_t encodeJson(const World &world, const std::vector<uint64_t> &dirty, const std::vector<uint64_t> &deleted, bool synced) {
+        nlohmann::json gameState;
+        gameState["entities"] = nlohmann::json::array();
+        gameState["deletedEntities"] = deleted;
+
+        for (const auto &entity : world.getEntities()) {
+            if (synced && std::ranges::find(dirty, entity.networkId) == dirty.end()) continue;
+
+            const glm::vec3 position = entity.getPosition();
+            const glm::vec2 scale = entity.getScale();
+
+            nlohmann::json entityJson;
+            entityJson["id"] = static_cast<int>(entity.networkId);
+            entityJson["networkId"] = entity.networkId;
+            entityJson["tile-code"] = static_cast<int>(entity.tileCode);
+            entityJson["TransformComponent"] = {
+                {"position", {position.x, position.y, position.z}},
+                {"rotation", EntitySnapshot::dequantizeAngle(entity.rotation)},
+                {"scale", {scale.x, scale.y}}
+            };
+
+            if (entity.hasPawn) {
+                entityJson["PawnComponent"] = {
+                    {"playerId", entity.playerId},
+                    {"moveForward", entity.hasFlag(EntitySnapshot::MOVE_FORWARD)},
+                    {"moveBackwards", entity.hasFlag(EntitySnapshot::MOVE_BACKWARDS)},
+                    {"moveLeft", entity.hasFlag(EntitySnapshot::MOVE_LEFT)},
+                    {"moveRight", entity.hasFlag(EntitySnapshot::MOVE_RIGHT)},
+                    {"aimRotation", EntitySnapshot::dequantizeAngle(entity.aimRotation)},
+                    {"isShooting", entity.hasFlag(EntitySnapshot::SHOOTING)}
+                };
+            }
+
+            if (entity.hasRigidbody) {
+                entityJson["RigidbodyComponent"] = {{"isSolid", entity.isSolid}};
+            }
+
+            gameState["entities"].push_back(entityJson);
+        }
+
+        size_t bytes = 0;
+        for (size_t i = 0; i < CONNECTIONS; ++i) {
+            bytes = gameState.dump().size();
+        }
+        return bytes;
+    }
+
+    struct Totals {
+        double microseconds = 0.0;
+        size_t bytes = 0;
+        size_t firstBytes = 0;
+    };
+
+    void print(const char *name, const Totals &totals, uint32_t ticks) {
+        std::printf("%-7s first tick %7zu bytes   then %7.0f bytes/tick per client   %8.1f us/tick to encode for %zu clients\n",
+                    name, totals.firstBytes, static_cast<double>(totals.bytes) / ticks, totals.microseconds / ticks, CONNECTIONS);
+    }
+
+    template<typename Func>
+    double microseconds(Func &&func) {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t fireballs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+    const auto ticks = static_cast<uint32_t>(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3000);
+    const auto ackLag = static_cast<uint32_t>(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 3);
+
+    std::printf("%zu tiles, %zu pawns, %zu fireballs, %u ticks, clients acknowledge %u ticks late\n",
+                TILES, PAWNS, fireballs, ticks, ackLag);
+
+    Totals json, binary;
+    {
+        World world(fireballs, 1);
+        std::vector<uint64_t> dirty, deleted;
+        json.firstBytes = encodeJson(world, dirty, deleted, false);
+        size_t bytes = 0;
+        for (uint32_t tick = 1; tick <= ticks; ++tick) {
+            world.step(dirty, deleted);
+            json.microseconds += microseconds([&] { bytes = encodeJson(world, dirty, deleted, true); });
+            json.bytes += bytes;
+        }
+    }
+    {
+        World world(fireballs, 1);
+        std::vector<uint64_t> dirty, deleted;
+        SnapshotHistory history;
+        std::string frame;
+
+        Snapshot &first = history.record(1);
+        first.entities = world.getEntities();
+        first.sort();
+        SnapshotCodec::encode(first, nullptr, frame);
+        binary.firstBytes = frame.size();
+
+        for (uint32_t tick = 2; tick <= ticks + 1; ++tick) {
+            world.step(dirty, deleted);
+            Snapshot &snapshot = history.record(tick);
+            snapshot.entities.assign(world.getEntities().begin(), world.getEntities().end());
+            snapshot.sort();
+
+            // every client acknowledged the same tick, so the lobby encodes once and shares the frame
+            const Snapshot *baseline = history.find(tick > ackLag + 1 ? tick - ackLag : 1);
+            binary.microseconds += microseconds([&] { SnapshotCodec::encode(snapshot, baseline, frame); });
+            binary.bytes += frame.size();
+        }
+    }
+
+    print("json", json, ticks);
+    print("binary", binary, ticks);
+    std::printf("binary is %.1fx smaller and %.1fx faster to encode per tick\n",
+                static_cast<double>(json.bytes) / static_cast<double>(binary.bytes), json.microseconds / binary.microseconds);
+    return 0;
+}
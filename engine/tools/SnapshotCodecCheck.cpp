@@ -0,0 +1,232 @@
+// Round trips seeded lobby snapshots through SnapshotCodec: full states, deltas against the baseline a
+// lagging client acknowledged while pawns move, fireballs come and go and walls turn into path tiles,
+// and frames that must be refused (truncated, or a delta against the wrong baseline). Exits with 1
+// when a check fails.
+//
+// usage: snapshot_codec_check [seed] [ticks]
+
+#include "network/SnapshotCodec.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+    constexpr uint32_t WALL = 10040;
+    constexpr uint32_t PATH = 10048;
+    constexpr uint32_t FIREBALL = 10110;
+    constexpr size_t TILES = 2500;
+    constexpr size_t PAWNS = 4;
+    constexpr uint32_t MAX_ACK_LAG = 12; // ticks, well inside SnapshotHistory::CAPACITY
+
+    int failures = 0;
+
+    void check(bool passed, const char *what) {
+        std::printf("%s  %s\n", passed ? "ok  " : "FAIL", what);
+        if (!passed) ++failures;
+    }
+
+    // A lobby as Lobby::captureSnapshot sees it, changed a little every tick.
+    class World {
+    public:
+        explicit World(uint32_t seed) : random(seed) {
+            for (size_t i = 0; i < TILES; ++i) {
+                EntitySnapshot tile;
+                tile.networkId = nextId++;
+                tile.tileCode = i % 3 == 0 ? WALL : PATH;
+                tile.setPosition({static_cast<float>(i % 50) * 100.0f - 2450.0f, static_cast<float>(i / 50) * 100.0f - 2450.0f, 5.0f});
+                tile.setScale({100.0f, 100.0f});
+                tile.hasRigidbody = tile.tileCode == WALL;
+                tile.isSolid = tile.hasRigidbody;
+                entities.push_back(tile);
+            }
+            for (size_t i = 0; i < PAWNS; ++i) {
+                EntitySnapshot pawn;
+                pawn.networkId = nextId++;
+                pawn.tileCode = 10000;
+                pawn.setPosition({-2400.0f + 1600.0f * static_cast<float>(i), 2400.0f, 0.0f});
+                pawn.setScale({100.0f, 100.0f});
+                pawn.hasPawn = true;
+                pawn.playerId = 100 + i;
+                entities.push_back(pawn);
+            }
+        }
+
+        void step() {
+            std::uniform_real_distribution<float> move(-30.0f, 30.0f);
+            std::uniform_int_distribution<int> percent(0, 99);
+
+            for (auto &entity : entities) {
+                if (entity.hasPawn) {
+                    const glm::vec3 position = entity.getPosition();
+                    entity.setPosition({position.x + move(random), position.y + move(random), position.z});
+                    entity.pawnFlags = static_cast<uint8_t>(percent(random) & 0x1F);
+                    entity.aimRotation = static_cast<uint16_t>(entity.aimRotation + percent(random) * 97);
+                    entity.lastInputSequence += 1 + percent(random) % 3;
+                } else if (entity.tileCode == FIREBALL) {
+                    const glm::vec3 position = entity.getPosition();
+                    entity.setPosition({position.x + 10.0f, position.y - 10.0f, 3.0f});
+                }
+            }
+
+            // a wall destroyed now and then, fireballs hit something and new ones are shot
+            if (percent(random) < 20) {
+                auto &tile = entities[std::uniform_int_distribution<size_t>(0, TILES - 1)(random)];
+                if (tile.tileCode == WALL) {
+                    tile.tileCode = PATH;
+                    tile.isSolid = false;
+                }
+            }
+            std::erase_if(entities, [&](const EntitySnapshot &entity) {
+                return entity.tileCode == FIREBALL && percent(random) < 10;
+            });
+            for (int shots = percent(random) % 3; shots > 0; --shots) {
+                EntitySnapshot fireball;
+                fireball.networkId = nextId++;
+                fireball.tileCode = FIREBALL;
+                fireball.setPosition({move(random) * 50.0f, move(random) * 50.0f, 3.0f});
+                fireball.rotation = EntitySnapshot::quantizeAngle(move(random) * 0.1f);
+                fireball.setScale({100.0f, 100.0f});
+                entities.push_back(fireball);
+            }
+        }
+
+        void capture(Snapshot &snapshot) const {
+            snapshot.entities = entities;
+            snapshot.sort();
+        }
+
+    private:
+        std::mt19937 random;
+        std::vector<EntitySnapshot> entities;
+        uint64_t nextId = 1;
+    };
+
+    bool roundTrips(const Snapshot &snapshot, const Snapshot *baseline, const Snapshot *clientBaseline, std::string &frame) {
+        SnapshotCodec::encode(snapshot, baseline, frame);
+        Snapshot decoded;
+        return SnapshotCodec::decode(frame, clientBaseline, decoded) && decoded.tick == snapshot.tick &&
+               decoded.entities == snapshot.entities;
+    }
+
+    bool anyPrefixDecodes(const std::string &frame, const Snapshot *baseline) {
+        Snapshot decoded;
+        for (size_t length = 0; length < frame.size(); ++length) {
+            if (SnapshotCodec::decode(std::string_view(frame).substr(0, length), baseline, decoded)) return true;
+        }
+        return false;
+    }
+}
+
+int main(int argc, char **argv) {
+    const auto seed = static_cast<uint32_t>(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1);
+    const uint32_t ticks = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 600;
+
+    World world(seed);
+    std::mt19937 random(seed + 1);
+    std::string frame;
+
+    // full state
+    Snapshot first;
+    first.tick = 1;
+    world.capture(first);
+    check(roundTrips(first, nullptr, nullptr, frame), "full state round trips");
+    check(!anyPrefixDecodes(frame, nullptr), "truncated full state is refused");
+
+    // deltas, the client decodes against its own copy of the snapshot it acknowledged
+    SnapshotHistory server;
+    SnapshotHistory client;
+    server.store(first);
+    {
+        Snapshot decoded;
+        SnapshotCodec::decode(frame, nullptr, decoded);
+        client.store(decoded);
+    }
+
+    uint32_t acknowledged = 1;
+    uint32_t deltasOk = 0, deltaFrames = 0, deletions = 0, fullFrames = 0;
+    size_t deltaBytes = 0, fullBytes = 0;
+    Snapshot current;
+    for (uint32_t tick = 2; tick <= ticks + 1; ++tick) {
+        world.step();
+        current.tick = tick;
+        world.capture(current);
+
+        const Snapshot *baseline = server.find(acknowledged);
+        SnapshotCodec::encode(current, baseline, frame);
+
+        SnapshotCodec::Header header;
+        SnapshotCodec::readHeader(frame, header);
+        deletions += header.deletedCount;
+        if (baseline) {
+            ++deltaFrames;
+            deltaBytes += frame.size();
+        } else {
+            ++fullFrames;
+            fullBytes += frame.size();
+        }
+
+        Snapshot decoded;
+        if (SnapshotCodec::decode(frame, client.find(header.baseTick), decoded) && decoded.tick == tick &&
+            decoded.entities == current.entities) {
+            ++deltasOk;
+        }
+
+        server.store(current);
+        client.store(decoded);
+
+        // acks arrive late and out of order, sometimes the client falls back to a full state
+        const uint32_t lag = std::uniform_int_distribution<uint32_t>(1, MAX_ACK_LAG)(random);
+        if (tick > lag && tick - lag > acknowledged) acknowledged = tick - lag;
+        if (tick % 200 == 0) acknowledged = 0;
+    }
+    check(deltasOk == ticks, "every delta decodes to the server's snapshot");
+    check(deletions > 0, "deleted fireballs are carried in the frames");
+    check(deltaFrames > 0 && fullFrames > 0 && deltaBytes / deltaFrames < fullBytes / fullFrames,
+          "deltas are smaller than full states");
+    std::printf("      %u deltas of %zu bytes and %u full states of %zu bytes on average\n", deltaFrames,
+                deltaFrames ? deltaBytes / deltaFrames : 0, fullFrames, fullFrames ? fullBytes / fullFrames : 0);
+
+    // a deleted entity is gone from the decoded snapshot, and the unchanged rest is not resent
+    {
+        const Snapshot *baseline = server.find(ticks + 1);
+        Snapshot shrunk;
+        shrunk.tick = ticks + 2;
+        shrunk.entities = baseline->entities;
+        const uint64_t removed = shrunk.entities[shrunk.entities.size() / 2].networkId;
+        shrunk.entities.erase(shrunk.entities.begin() + static_cast<std::ptrdiff_t>(shrunk.entities.size() / 2));
+
+        SnapshotCodec::encode(shrunk, baseline, frame);
+        SnapshotCodec::Header header;
+        Snapshot decoded;
+        check(SnapshotCodec::readHeader(frame, header) && header.deletedCount == 1 && header.entityCount == 0,
+              "a deletion alone sends one id and no entity");
+        check(SnapshotCodec::decode(frame, client.find(ticks + 1), decoded) && decoded.entities == shrunk.entities &&
+              std::ranges::find(decoded.entities, removed, &EntitySnapshot::networkId) == decoded.entities.end(),
+              "the deleted entity is dropped on decode");
+        check(!anyPrefixDecodes(frame, client.find(ticks + 1)), "truncated delta is refused");
+
+        Snapshot unchanged = *baseline;
+        unchanged.tick = ticks + 2;
+        SnapshotCodec::encode(unchanged, baseline, frame);
+        check(frame.size() == SnapshotCodec::HEADER_SIZE, "an unchanged state is a bare header");
+    }
+
+    // a delta only decodes against the baseline it was encoded against
+    {
+        SnapshotCodec::encode(current, server.find(ticks), frame);
+        Snapshot decoded;
+        check(!SnapshotCodec::decode(frame, nullptr, decoded), "delta without a baseline is refused");
+        check(!SnapshotCodec::decode(frame, client.find(ticks - 1), decoded), "delta against another baseline is refused");
+
+        std::string corrupted = frame;
+        corrupted[0] ^= 0x01;
+        check(!SnapshotCodec::decode(corrupted, server.find(ticks), decoded), "frame with a bad magic is refused");
+    }
+
+    if (failures > 0) {
+        std::printf("%d checks failed (seed %u)\n", failures, seed);
+        return 1;
+    }
+    return 0;
+}
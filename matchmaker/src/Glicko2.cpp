@@ -1,6 +1,10 @@
 #include "Glicko2.hpp"
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
 namespace {
     constexpr double PI = 3.14159265358979323846;
     constexpr double GLICKO2_CONVERSION_FACTOR = 173.7178;
@@ -18,6 +22,78 @@ namespace {
     double convertToGlicko2Deviation(double deviation) {
         return deviation / GLICKO2_CONVERSION_FACTOR;
     }
+
+    // exp without calls or branches so the batch loops below vectorize. Cody-Waite reduction to
+    // |r| <= ln2/2 and a degree 13 Taylor polynomial, within a couple of ulp of std::exp.
+    inline double batchExp(double x) {
+        constexpr double LOG2E = 1.4426950408889634;
+        constexpr double LN2_HI = 6.93147180369123816490e-01;
+        constexpr double LN2_LO = 1.90821492927058770002e-10;
+        constexpr double ROUNDING = 6755399441055744.0; // 1.5 * 2^52, adding it rounds to an integer
+
+        x = x < -708.0 ? -708.0 : x;
+        x = x > 709.0 ? 709.0 : x;
+
+        const double shifted = x * LOG2E + ROUNDING;
+        const double k = shifted - ROUNDING;
+        const double r = (x - k * LN2_HI) - k * LN2_LO;
+
+        double p = 1.0 / 6227020800.0;
+        p = p * r + 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+
+        // the low mantissa bits of shifted hold k, move it into the exponent of 2^k
+        uint64_t kBits;
+        uint64_t roundingBits;
+        std::memcpy(&kBits, &shifted, sizeof(kBits));
+        std::memcpy(&roundingBits, &ROUNDING, sizeof(roundingBits));
+        const uint64_t scaleBits = (kBits - roundingBits + 1023) << 52;
+        double scale;
+        std::memcpy(&scale, &scaleBits, sizeof(scale));
+        return p * scale;
+    }
+
+    inline double batchG(double phi) {
+        return 1.0 / std::sqrt(1.0 + (3.0 * phi * phi) / (PI * PI));
+    }
+
+    inline double batchE(double mu, double opponentMu, double opponentG) {
+        return 1.0 / (1.0 + batchExp(-opponentG * (mu - opponentMu)));
+    }
+
+    template<typename Func>
+    void runOnThreads(int playerCount, int threadCount, Func&& func) {
+        if (threadCount <= 0) {
+            threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        // small periods are not worth a thread each
+        threadCount = std::max(1, std::min(threadCount, playerCount / 4096));
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        const int chunk = (playerCount + threadCount - 1) / threadCount;
+        for (int t = 1; t < threadCount; ++t) {
+            const int begin = std::min(playerCount, t * chunk);
+            const int end = std::min(playerCount, begin + chunk);
+            threads.emplace_back([&func, begin, end] { func(begin, end); });
+        }
+        func(0, std::min(playerCount, chunk));
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
 }
 
 Glicko2::Rating Glicko2::updateRating(const Rating& oldRating,
@@ -71,6 +147,151 @@ Glicko2::Rating Glicko2::updateRating(const Rating& oldRating,
     return newRating;
 }
 
+void Glicko2::updateRatingPeriod(const RatingPeriod& period, int threadCount) {
+    const int playerCount = period.playerCount;
+    if (playerCount <= 0) {
+        return;
+    }
+
+    // Pass 1: every player's mu and g(phi), read by all threads as opponent data.
+    std::vector<double> mu(playerCount);
+    std::vector<double> gPhi(playerCount);
+    runOnThreads(playerCount, threadCount, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            mu[i] = toGlicko2Scale(period.rating[i]);
+            gPhi[i] = batchG(convertToGlicko2Deviation(period.deviation[i]));
+        }
+    });
+
+    // Pass 2: each thread takes a range of players through the remaining steps.
+    runOnThreads(playerCount, threadCount, [&](int begin, int end) {
+        const int count = end - begin;
+        const int firstResult = period.resultOffsets[begin];
+        const int resultCount = period.resultOffsets[end] - firstResult;
+
+        // per result terms, flat over all results of the range
+        std::vector<double> varianceTerm(resultCount);
+        std::vector<double> deltaTerm(resultCount);
+        for (int i = begin; i < end; ++i) {
+            const double playerMu = mu[i];
+            for (int r = period.resultOffsets[i]; r < period.resultOffsets[i + 1]; ++r) {
+                const int opponent = period.opponents[r];
+                const double g = gPhi[opponent];
+                const double e = batchE(playerMu, mu[opponent], g);
+                varianceTerm[r - firstResult] = g * g * e * (1.0 - e);
+                deltaTerm[r - firstResult] = g * (period.scores[r] - e);
+            }
+        }
+
+        // Steps 1 and 2, v and delta per player
+        std::vector<double> v(count);
+        std::vector<double> deltaSum(count);
+        std::vector<double> phi2(count);
+        std::vector<double> logSigma2(count);
+        for (int i = 0; i < count; ++i) {
+            double varianceSum = 0.0;
+            double sum = 0.0;
+            for (int r = period.resultOffsets[begin + i]; r < period.resultOffsets[begin + i + 1]; ++r) {
+                varianceSum += varianceTerm[r - firstResult];
+                sum += deltaTerm[r - firstResult];
+            }
+            v[i] = varianceSum > 0.0 ? 1.0 / varianceSum : 999999.0;
+            deltaSum[i] = sum;
+
+            const double phi = convertToGlicko2Deviation(period.deviation[begin + i]);
+            const double sigma = period.volatility[begin + i];
+            phi2[i] = phi * phi;
+            logSigma2[i] = std::log(sigma * sigma);
+        }
+
+        // Step 3, Illinois solve. A player whose bracket is already below EPSILON keeps its values
+        // like the scalar loop exits.
+        std::vector<double> A(count), B(count), fA(count), fB(count), deltaSquared(count);
+        const auto f = [](double x, double d2, double p2, double variance, double logS2) {
+            const double ex = batchExp(x);
+            const double denominator = p2 + ex;
+            return ex * (d2 - p2 - variance - ex) / (2.0 * denominator * denominator) - (x - logS2) / (TAU * TAU);
+        };
+        for (int i = 0; i < count; ++i) {
+            const double delta = v[i] * deltaSum[i];
+            deltaSquared[i] = delta * delta;
+            A[i] = logSigma2[i];
+            fA[i] = f(A[i], deltaSquared[i], phi2[i], v[i], logSigma2[i]);
+            if (deltaSquared[i] > phi2[i] + v[i]) {
+                B[i] = std::log(deltaSquared[i] - phi2[i] - v[i]);
+                fB[i] = f(B[i], deltaSquared[i], phi2[i], v[i], logSigma2[i]);
+            } else {
+                int k = 1;
+                while ((fB[i] = f(A[i] - k * TAU, deltaSquared[i], phi2[i], v[i], logSigma2[i])) < 0) {
+                    ++k;
+                }
+                B[i] = A[i] - k * TAU;
+            }
+        }
+        // A few sweeps over every player settle most of them, the rest are finished one by one.
+        // Written as plain selects so the sweeps vectorize. A settled player keeps A and B, only its
+        // unused fA drifts, and A only moves to B if f(B) is exactly 0.
+        const auto step = [&](int i) {
+            const double a = A[i], b = B[i], fa = fA[i], fb = fB[i];
+            const double C = a + (a - b) * fa / (fb - fa);
+            const double fC = f(C, deltaSquared[i], phi2[i], v[i], logSigma2[i]);
+
+            const bool active = std::abs(b - a) > EPSILON;
+            const double nextFB = active ? fC : fb;
+            const double nextB = active ? C : b;
+            const bool crossed = nextFB * fb <= 0;
+            const double nextA = crossed ? b : a;
+            const double nextFA = crossed ? fb : fa * 0.5;
+
+            A[i] = nextA;
+            fA[i] = nextFA;
+            B[i] = nextB;
+            fB[i] = nextFB;
+        };
+        for (int sweep = 0; sweep < BATCH_SWEEPS; ++sweep) {
+            for (int i = 0; i < count; ++i) {
+                step(i);
+            }
+        }
+        for (int i = 0; i < count; ++i) {
+            for (int iteration = BATCH_SWEEPS; iteration < MAX_ITERATIONS && std::abs(B[i] - A[i]) > EPSILON; ++iteration) {
+                step(i);
+            }
+        }
+
+        // Steps 4 and 5, new deviation and rating
+        for (int i = 0; i < count; ++i) {
+            const int player = begin + i;
+            const int results = period.resultOffsets[player + 1] - period.resultOffsets[player];
+            if (results == 0) {
+                period.newRating[player] = period.rating[player];
+                period.newDeviation[player] = period.deviation[player];
+                period.newVolatility[player] = period.volatility[player];
+                continue;
+            }
+
+            const double newSigma = std::exp(A[i] / 2.0);
+            const double phiStar2 = phi2[i] + newSigma * newSigma;
+            const double newPhi = 1.0 / std::sqrt(1.0 / phiStar2 + 1.0 / v[i]);
+
+            period.newRating[player] = fromGlicko2Scale(mu[player] + newPhi * newPhi * deltaSum[i]);
+            period.newDeviation[player] = newPhi * GLICKO2_CONVERSION_FACTOR;
+            period.newVolatility[player] = newSigma;
+        }
+
+        for (int player = begin; player < end; ++player) {
+            int wins = period.wins[player];
+            int losses = period.losses[player];
+            for (int r = period.resultOffsets[player]; r < period.resultOffsets[player + 1]; ++r) {
+                wins += period.scores[r] > 0.6;
+                losses += period.scores[r] < 0.4;
+            }
+            period.newWins[player] = wins;
+            period.newLosses[player] = losses;
+        }
+    });
+}
+
 double Glicko2::calculateMatchQuality(const Rating& player1, const Rating& player2) {
     // Calculate match quality based on:
     // 1. Rating difference
@@ -140,9 +361,17 @@ double Glicko2::updateVolatility(const Rating& rating,
 
     double a = std::log(sigma * sigma);
     double A = a;
-    double B = delta * delta > phi2 + variance ?
-               std::log(delta * delta - phi2 - variance) :
-               a - TAU;
+    double B;
+    if (delta * delta > phi2 + variance) {
+        B = std::log(delta * delta - phi2 - variance);
+    } else {
+        // step down until f changes sign, otherwise the root is not bracketed
+        int k = 1;
+        while (f(a - k * TAU) < 0) {
+            ++k;
+        }
+        B = a - k * TAU;
+    }
     double fA = f(A);
     double fB = f(B);
 
@@ -150,7 +379,7 @@ double Glicko2::updateVolatility(const Rating& rating,
     for (int i = 0; i < MAX_ITERATIONS && std::abs(B - A) > EPSILON; ++i) {
         double C = A + (A - B) * fA / (fB - fA);
         double fC = f(C);
-        if (fC * fB < 0) {
+        if (fC * fB <= 0) { // <= so an exact root at B ends up in A
             A = B;
             fA = fB;
         } else {
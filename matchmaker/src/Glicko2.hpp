@@ -27,10 +27,37 @@ public:
         double score{};  // 1.0 for win, 0.5 for draw, 0.0 for loss
     };
 
+    // One rating period for many players as structure of arrays. The results of player i are
+    // resultOffsets[i] .. resultOffsets[i + 1] in opponents and scores, and opponents index the
+    // same player arrays. The new* outputs must not alias the inputs, every update reads the
+    // ratings from before the period.
+    struct RatingPeriod {
+        int playerCount;
+        const double* rating;
+        const double* deviation;
+        const double* volatility;
+        const int* wins;
+        const int* losses;
+
+        const int* resultOffsets; // playerCount + 1 entries
+        const int* opponents;
+        const double* scores;
+
+        double* newRating;
+        double* newDeviation;
+        double* newVolatility;
+        int* newWins;
+        int* newLosses;
+    };
+
     // Core functions
     static Rating getDefaultRating() { return {}; }
     static Rating updateRating(const Rating& oldRating, const std::vector<MatchResult>& results);
 
+    // Same result as updateRating for every player of the period, within floating point tolerance.
+    // The players are split across threadCount threads (0 picks the hardware concurrency).
+    static void updateRatingPeriod(const RatingPeriod& period, int threadCount);
+
     // Scale conversions
     static double toGlicko2Scale(double rating) { return (rating - 1500.0) / 173.7178; }
     static double fromGlicko2Scale(double rating) { return (rating * 173.7178) + 1500.0; }
@@ -43,6 +70,7 @@ private:
     static constexpr double TAU = 0.5;         // System constant
     static constexpr double EPSILON = 0.000001; // Convergence tolerance
     static constexpr int MAX_ITERATIONS = 100;  // Maximum iterations
+    static constexpr int BATCH_SWEEPS = 4;      // branch free Illinois steps over all players in updateRatingPeriod
 
     static double computeVariance(const std::vector<MatchResult>& results, const Rating& player);
     static double computeDelta(const std::vector<MatchResult>& results, const Rating& player, double variance);
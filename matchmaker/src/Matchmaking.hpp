@@ -1,11 +1,17 @@
 #ifndef MATCHMAKING_DLL_HPP
 #define MATCHMAKING_DLL_HPP
 
+#if defined(MATCHMAKER_STATIC)
+#define MATCHMAKING_API
+#elif defined(_WIN32)
 #ifdef MATCHMAKER_EXPORTS
 #define MATCHMAKING_API __declspec(dllexport)
 #else
 #define MATCHMAKING_API __declspec(dllimport)
 #endif
+#else
+#define MATCHMAKING_API __attribute__((visibility("default")))
+#endif
 
 struct Rating {
     double rating;
@@ -15,6 +21,26 @@ struct Rating {
     int losses;
 };
 
+// A rating period for many players at once, see updateRatingPeriod.
+struct RatingPeriodTable {
+    int playerCount;
+    const double* rating;
+    const double* deviation;
+    const double* volatility;
+    const int* wins;
+    const int* losses;
+
+    const int* resultOffsets; // playerCount + 1 entries, player i owns results [resultOffsets[i], resultOffsets[i + 1])
+    const int* opponents;     // index of the opponent in the player arrays
+    const double* scores;     // 1.0 win, 0.5 draw, 0.0 loss
+
+    double* newRating;
+    double* newDeviation;
+    double* newVolatility;
+    int* newWins;
+    int* newLosses;
+};
+
 struct MatchQuality {
     bool isValid;
     char reason[256];
@@ -25,6 +51,16 @@ struct MatchQuality {
 extern "C" {
     MATCHMAKING_API void getDefaultRating(Rating* rating);
     MATCHMAKING_API void evaluateMatch(const Rating* players, int numPlayers, MatchQuality* result);
+    // Scores groupCount groups of groupSize players each. groupIndices holds groupCount * groupSize
+    // indices into pool. qualityOut[i] gets the same quality evaluateMatch gives group i, or 0 when
+    // that group is not a valid match. No reasons are produced; call evaluateMatch for one group
+    // to get its reason.
+    MATCHMAKING_API void evaluateMatchesBatch(const Rating* pool,
+                                              int poolSize,
+                                              const int* groupIndices,
+                                              int groupSize,
+                                              int groupCount,
+                                              float* qualityOut);
     MATCHMAKING_API bool canPlayerJoin(const Rating* newPlayer,
                                        const Rating* existingPlayers,
                                        int numExistingPlayers,
@@ -44,6 +80,12 @@ extern "C" {
                                        bool* success,
                                        char* errorMsg,
                                        int errorMsgSize);
+    // Glicko-2 update of every player in the table from the ratings before the period. The outputs
+    // must not alias the inputs. threadCount 0 uses every hardware thread.
+    MATCHMAKING_API bool updateRatingPeriod(const RatingPeriodTable* period,
+                                            int threadCount,
+                                            char* errorMsg,
+                                            int errorMsgSize);
 }
 
 #endif // MATCHMAKING_DLL_HPP
@@ -1,9 +1,13 @@
 #include "Matchmaking.hpp"
-#include <Windows.h>
+#include "Glicko2.hpp"
+#include <cstdio>
 #include <cstring>
 #include <algorithm>
 #include <cmath>
 
+#if defined(_WIN32) && !defined(MATCHMAKER_STATIC)
+#include <Windows.h>
+
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserved) {
     switch (ul_reason_for_call) {
         case DLL_PROCESS_ATTACH:
@@ -14,6 +18,68 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
     }
     return TRUE;
 }
+#endif
+
+// portable replacement for strncpy_s(..., _TRUNCATE), always null terminated
+static void copyMessage(char* destination, int size, const char* message) {
+    if (destination && size > 0) {
+        std::snprintf(destination, static_cast<size_t>(size), "%s", message);
+    }
+}
+
+static constexpr double MAX_SKILL_SPREAD = 600.0;     // largest distance from the group mean that is still a valid match
+static constexpr double QUALITY_SPREAD_SCALE = 800.0; // quality falls linearly with the spread, to 0 at this distance
+static constexpr int BATCH_LANES = 16;                // groups scored together in one structure of arrays block
+
+// Scores groups of GroupSize in blocks of BATCH_LANES. The ratings are gathered into one array per
+// seat first so the arithmetic runs across groups without branches and the compiler can vectorize it.
+template<int GroupSize>
+static void scoreGroups(const Rating* pool, int poolSize, const int* groupIndices, int groupCount, float* qualityOut) {
+    double ratings[GroupSize][BATCH_LANES];
+    double quality[BATCH_LANES];
+    bool inRange[BATCH_LANES];
+
+    for (int first = 0; first < groupCount; first += BATCH_LANES) {
+        const int lanes = std::min(BATCH_LANES, groupCount - first);
+        const int* indices = groupIndices + static_cast<size_t>(first) * GroupSize;
+
+        for (int lane = 0; lane < BATCH_LANES; ++lane) {
+            inRange[lane] = lane < lanes;
+            for (int seat = 0; seat < GroupSize; ++seat) {
+                double rating = 0.0;
+                if (lane < lanes) {
+                    const int index = indices[lane * GroupSize + seat];
+                    if (index >= 0 && index < poolSize) {
+                        rating = pool[index].rating;
+                    } else {
+                        inRange[lane] = false;
+                    }
+                }
+                ratings[seat][lane] = rating;
+            }
+        }
+
+        // same arithmetic, in the same order, as evaluateMatch
+        for (int lane = 0; lane < BATCH_LANES; ++lane) {
+            double average = 0.0;
+            for (int seat = 0; seat < GroupSize; ++seat) {
+                average += ratings[seat][lane];
+            }
+            average /= GroupSize;
+
+            double maxSpread = 0.0;
+            for (int seat = 0; seat < GroupSize; ++seat) {
+                maxSpread = std::max(maxSpread, std::abs(ratings[seat][lane] - average));
+            }
+
+            quality[lane] = maxSpread < MAX_SKILL_SPREAD ? 1.0 - maxSpread / QUALITY_SPREAD_SCALE : 0.0;
+        }
+
+        for (int lane = 0; lane < lanes; ++lane) {
+            qualityOut[first + lane] = inRange[lane] ? static_cast<float>(quality[lane]) : 0.0f;
+        }
+    }
+}
 
 extern "C" {
     MATCHMAKING_API void getDefaultRating(Rating* rating) {
@@ -29,7 +95,7 @@ extern "C" {
     MATCHMAKING_API void evaluateMatch(const Rating* players, int numPlayers, MatchQuality* result) {
         if (!players || !result || numPlayers < 2 || numPlayers > 4) {
             result->isValid = false;
-            strcpy_s(result->reason, "Invalid parameters or player count");
+            copyMessage(result->reason, sizeof(result->reason), "Invalid parameters or player count");
             return;
         }
 
@@ -47,11 +113,34 @@ extern "C" {
         }
 
         result->skillSpread = maxSpread;
-        result->quality = 1.0 - (maxSpread / 800.0);
-        result->isValid = maxSpread < 600.0;
+        result->quality = 1.0 - (maxSpread / QUALITY_SPREAD_SCALE);
+        result->isValid = maxSpread < MAX_SKILL_SPREAD;
 
         if (!result->isValid) {
-            strcpy_s(result->reason, "Skill spread too high");
+            copyMessage(result->reason, sizeof(result->reason), "Skill spread too high");
+        }
+    }
+
+    MATCHMAKING_API void evaluateMatchesBatch(const Rating* pool,
+                                              int poolSize,
+                                              const int* groupIndices,
+                                              int groupSize,
+                                              int groupCount,
+                                              float* qualityOut) {
+        if (!qualityOut || groupCount <= 0) {
+            return;
+        }
+
+        if (!pool || !groupIndices) {
+            std::fill(qualityOut, qualityOut + groupCount, 0.0f);
+            return;
+        }
+
+        switch (groupSize) {
+            case 2: scoreGroups<2>(pool, poolSize, groupIndices, groupCount, qualityOut); break;
+            case 3: scoreGroups<3>(pool, poolSize, groupIndices, groupCount, qualityOut); break;
+            case 4: scoreGroups<4>(pool, poolSize, groupIndices, groupCount, qualityOut); break;
+            default: std::fill(qualityOut, qualityOut + groupCount, 0.0f); break;
         }
     }
 
@@ -61,12 +150,12 @@ extern "C" {
                                        char* reason,
                                        int reasonSize) {
         if (!newPlayer || !existingPlayers || numExistingPlayers < 1) {
-            strncpy_s(reason, reasonSize, "Invalid parameters", _TRUNCATE);
+            copyMessage(reason, reasonSize, "Invalid parameters");
             return false;
         }
 
         if (numExistingPlayers >= 4) {
-            strncpy_s(reason, reasonSize, "Lobby is full", _TRUNCATE);
+            copyMessage(reason, reasonSize, "Lobby is full");
             return false;
         }
 
@@ -78,7 +167,7 @@ extern "C" {
 
         double ratingDiff = std::abs(newPlayer->rating - avgRating);
         if (ratingDiff > 600.0) {
-            strncpy_s(reason, reasonSize, "Rating difference too high", _TRUNCATE);
+            copyMessage(reason, reasonSize, "Rating difference too high");
             return false;
         }
 
@@ -94,7 +183,7 @@ extern "C" {
                                              int reasonSize) {
         if (!existingPlayers || !minRating || !maxRating || numExistingPlayers < 1) {
             *success = false;
-            strncpy_s(reason, reasonSize, "Invalid parameters", _TRUNCATE);
+            copyMessage(reason, reasonSize, "Invalid parameters");
             return;
         }
 
@@ -118,7 +207,7 @@ extern "C" {
                                        int errorMsgSize) {
         if (!currentRating || !opponents || !results || numOpponents < 1) {
             *success = false;
-            strncpy_s(errorMsg, errorMsgSize, "Invalid parameters", _TRUNCATE);
+            copyMessage(errorMsg, errorMsgSize, "Invalid parameters");
             return;
         }
 
@@ -137,4 +226,55 @@ extern "C" {
 
         *success = true;
     }
+
+    MATCHMAKING_API bool updateRatingPeriod(const RatingPeriodTable* period,
+                                            int threadCount,
+                                            char* errorMsg,
+                                            int errorMsgSize) {
+        if (!period || period->playerCount < 0 || !period->resultOffsets) {
+            copyMessage(errorMsg, errorMsgSize, "Invalid parameters");
+            return false;
+        }
+        if (period->playerCount == 0) {
+            return true;
+        }
+        if (!period->rating || !period->deviation || !period->volatility || !period->wins || !period->losses ||
+            !period->newRating || !period->newDeviation || !period->newVolatility || !period->newWins || !period->newLosses) {
+            copyMessage(errorMsg, errorMsgSize, "Missing player column");
+            return false;
+        }
+
+        const int* offsets = period->resultOffsets;
+        if (offsets[0] != 0) {
+            copyMessage(errorMsg, errorMsgSize, "Result offsets must start at 0");
+            return false;
+        }
+        for (int i = 0; i < period->playerCount; i++) {
+            if (offsets[i + 1] < offsets[i]) {
+                copyMessage(errorMsg, errorMsgSize, "Result offsets must not decrease");
+                return false;
+            }
+        }
+
+        const int resultCount = offsets[period->playerCount];
+        if (resultCount > 0 && (!period->opponents || !period->scores)) {
+            copyMessage(errorMsg, errorMsgSize, "Missing result column");
+            return false;
+        }
+        for (int r = 0; r < resultCount; r++) {
+            if (period->opponents[r] < 0 || period->opponents[r] >= period->playerCount) {
+                copyMessage(errorMsg, errorMsgSize, "Opponent index out of range");
+                return false;
+            }
+        }
+
+        Glicko2::RatingPeriod glickoPeriod{
+            period->playerCount,
+            period->rating, period->deviation, period->volatility, period->wins, period->losses,
+            period->resultOffsets, period->opponents, period->scores,
+            period->newRating, period->newDeviation, period->newVolatility, period->newWins, period->newLosses
+        };
+        Glicko2::updateRatingPeriod(glickoPeriod, threadCount);
+        return true;
+    }
 }
@@ -0,0 +1,84 @@
+// Scores 1M candidate pairs (and as many groups of 4) from a queue sized pool, once through one
+// evaluateMatch call per group and once through a single evaluateMatchesBatch call. Reports nanoseconds per group and exits with 1 when a batch quality
+// differs from the one evaluateMatch gives.
+//
+// usage: match_batch_bench [groups] [pool size]
+
+#include "Matchmaking.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+    struct Result {
+        double scalarNs;
+        double batchNs;
+        size_t valid;
+        size_t mismatches;
+    };
+
+    Result run(const std::vector<Rating> &pool, const std::vector<int> &groupIndices, int groupSize) {
+        const size_t groupCount = groupIndices.size() / groupSize;
+        std::vector<float> scalarQuality(groupCount);
+        std::vector<float> batchQuality(groupCount);
+
+        const auto scalarStart = std::chrono::steady_clock::now();
+        Rating group[4];
+        MatchQuality quality;
+        for (size_t g = 0; g < groupCount; ++g) {
+            for (int seat = 0; seat < groupSize; ++seat) {
+                group[seat] = pool[groupIndices[g * groupSize + seat]];
+            }
+            evaluateMatch(group, groupSize, &quality);
+            scalarQuality[g] = quality.isValid ? static_cast<float>(quality.quality) : 0.0f;
+        }
+        const auto scalarEnd = std::chrono::steady_clock::now();
+
+        evaluateMatchesBatch(pool.data(), static_cast<int>(pool.size()), groupIndices.data(), groupSize,
+                             static_cast<int>(groupCount), batchQuality.data());
+        const auto batchEnd = std::chrono::steady_clock::now();
+
+        Result result{};
+        result.scalarNs = std::chrono::duration<double, std::nano>(scalarEnd - scalarStart).count() / static_cast<double>(groupCount);
+        result.batchNs = std::chrono::duration<double, std::nano>(batchEnd - scalarEnd).count() / static_cast<double>(groupCount);
+        for (size_t g = 0; g < groupCount; ++g) {
+            if (batchQuality[g] > 0.0f) ++result.valid;
+            if (std::abs(batchQuality[g] - scalarQuality[g]) > 1e-6f) ++result.mismatches;
+        }
+        return result;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t groups = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t poolSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+
+    std::mt19937_64 random(42);
+    std::normal_distribution<double> ratingDistribution(1500.0, 300.0);
+    std::uniform_real_distribution<double> deviationDistribution(50.0, 350.0);
+    std::uniform_int_distribution<int> pick(0, static_cast<int>(poolSize) - 1);
+
+    std::vector<Rating> pool(poolSize);
+    for (auto &rating: pool) {
+        rating = {ratingDistribution(random), deviationDistribution(random), 0.06, 0, 0};
+    }
+
+    int failures = 0;
+    for (const int groupSize: {2, 4}) {
+        std::vector<int> groupIndices(groups * groupSize);
+        for (int &index: groupIndices) index = pick(random);
+
+        const Result result = run(pool, groupIndices, groupSize);
+        std::printf("%zu groups of %d from %zu players  evaluateMatch %6.1f ns/group   batch %5.1f ns/group   %5.1fx   %zu valid\n",
+                    groups, groupSize, poolSize, result.scalarNs, result.batchNs, result.scalarNs / result.batchNs, result.valid);
+        if (result.mismatches > 0) {
+            std::printf("FAIL  %zu groups of %d score differently in the batch\n", result.mismatches, groupSize);
+            ++failures;
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+// Runs one Glicko-2 rating period over 1M synthetic players, once player by player through
+// Glicko2::updateRating and once through the exported updateRatingPeriod on 1 and on every hardware
+// thread. Reports the time of each and exits with 1 when a batch result is further from the scalar
+// one than the tolerances below.
+//
+// usage: rating_period_bench [players] [results per player]
+
+#include "Glicko2.hpp"
+#include "Matchmaking.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr double RATING_TOLERANCE = 1e-3;     // rating points
+    constexpr double DEVIATION_TOLERANCE = 1e-3;  // rating points
+    constexpr double VOLATILITY_TOLERANCE = 1e-6;
+
+    struct Period {
+        std::vector<double> rating, deviation, volatility;
+        std::vector<int> wins, losses;
+        std::vector<int> resultOffsets, opponents;
+        std::vector<double> scores;
+    };
+
+    struct Updated {
+        std::vector<double> rating, deviation, volatility;
+        std::vector<int> wins, losses;
+
+        explicit Updated(size_t players)
+            : rating(players), deviation(players), volatility(players), wins(players), losses(players) {}
+    };
+
+    Period makePeriod(size_t players, int resultsPerPlayer) {
+        std::mt19937_64 random(42);
+        std::normal_distribution<double> ratingDistribution(1500.0, 300.0);
+        std::uniform_real_distribution<double> deviationDistribution(30.0, 350.0);
+        std::uniform_real_distribution<double> volatilityDistribution(0.04, 0.09);
+        std::uniform_int_distribution<int> opponentDistribution(0, static_cast<int>(players) - 1);
+        std::uniform_int_distribution<int> scoreDistribution(0, 2);
+
+        Period period;
+        period.resultOffsets.reserve(players + 1);
+        for (size_t i = 0; i < players; ++i) {
+            period.rating.push_back(ratingDistribution(random));
+            period.deviation.push_back(deviationDistribution(random));
+            period.volatility.push_back(volatilityDistribution(random));
+            period.wins.push_back(0);
+            period.losses.push_back(0);
+
+            period.resultOffsets.push_back(static_cast<int>(period.opponents.size()));
+            for (int r = 0; r < resultsPerPlayer; ++r) {
+                int opponent = opponentDistribution(random);
+                if (opponent == static_cast<int>(i)) opponent = (opponent + 1) % static_cast<int>(players);
+                period.opponents.push_back(opponent);
+                period.scores.push_back(0.5 * scoreDistribution(random));
+            }
+        }
+        period.resultOffsets.push_back(static_cast<int>(period.opponents.size()));
+        return period;
+    }
+
+    double scalar(const Period &period, Updated &out) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<Glicko2::MatchResult> results;
+        for (size_t i = 0; i < period.rating.size(); ++i) {
+            results.clear();
+            for (int r = period.resultOffsets[i]; r < period.resultOffsets[i + 1]; ++r) {
+                const int opponent = period.opponents[r];
+                results.push_back({{period.rating[opponent], period.deviation[opponent], period.volatility[opponent]}, period.scores[r]});
+            }
+
+            Glicko2::Rating player(period.rating[i], period.deviation[i], period.volatility[i]);
+            player.wins = period.wins[i];
+            player.losses = period.losses[i];
+            const Glicko2::Rating updated = Glicko2::updateRating(player, results);
+            out.rating[i] = updated.rating;
+            out.deviation[i] = updated.deviation;
+            out.volatility[i] = updated.volatility;
+            out.wins[i] = updated.wins;
+            out.losses[i] = updated.losses;
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double batch(const Period &period, Updated &out, int threadCount) {
+        const RatingPeriodTable table{
+            static_cast<int>(period.rating.size()),
+            period.rating.data(), period.deviation.data(), period.volatility.data(), period.wins.data(), period.losses.data(),
+            period.resultOffsets.data(), period.opponents.data(), period.scores.data(),
+            out.rating.data(), out.deviation.data(), out.volatility.data(), out.wins.data(), out.losses.data()
+        };
+
+        char errorMsg[256];
+        const auto start = std::chrono::steady_clock::now();
+        if (!updateRatingPeriod(&table, threadCount, errorMsg, sizeof(errorMsg))) {
+            std::printf("FAIL  updateRatingPeriod: %s\n", errorMsg);
+            std::exit(1);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Returns false when a player is outside the tolerances.
+    bool compare(const Updated &expected, const Updated &actual) {
+        double ratingError = 0.0, deviationError = 0.0, volatilityError = 0.0;
+        size_t recordMismatches = 0;
+        for (size_t i = 0; i < expected.rating.size(); ++i) {
+            ratingError = std::max(ratingError, std::abs(expected.rating[i] - actual.rating[i]));
+            deviationError = std::max(deviationError, std::abs(expected.deviation[i] - actual.deviation[i]));
+            volatilityError = std::max(volatilityError, std::abs(expected.volatility[i] - actual.volatility[i]));
+            if (expected.wins[i] != actual.wins[i] || expected.losses[i] != actual.losses[i]) ++recordMismatches;
+        }
+
+        const bool passed = ratingError <= RATING_TOLERANCE && deviationError <= DEVIATION_TOLERANCE &&
+                            volatilityError <= VOLATILITY_TOLERANCE && recordMismatches == 0;
+        std::printf("%s  largest difference to scalar: rating %.2e, deviation %.2e, volatility %.2e, %zu win/loss mismatches\n",
+                    passed ? "ok  " : "FAIL", ratingError, deviationError, volatilityError, recordMismatches);
+        return passed;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t players = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int resultsPerPlayer = argc > 2 ? std::atoi(argv[2]) : 4;
+    const int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    const Period period = makePeriod(players, resultsPerPlayer);
+    std::printf("%zu players, %zu results\n", players, period.opponents.size());
+
+    Updated expected(players);
+    const double scalarSeconds = scalar(period, expected);
+    std::printf("scalar updateRating            %7.3fs\n", scalarSeconds);
+
+    int failures = 0;
+    std::vector<int> threadCounts{1};
+    if (hardwareThreads > 1) threadCounts.push_back(hardwareThreads);
+
+    for (const int threads: threadCounts) {
+        Updated actual(players);
+        const double seconds = batch(period, actual, threads);
+        std::printf("updateRatingPeriod, threads %2d %7.3fs  %5.1fx\n", threads, seconds, scalarSeconds / seconds);
+        if (!compare(expected, actual)) ++failures;
+    }
+    return failures > 0 ? 1 : 0;
+}
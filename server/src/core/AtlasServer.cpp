@@ -1,6 +1,7 @@
 #include "AtlasServer.hpp"
 
 #include "data/DatabaseManager.hpp"
+#include "data/PersistenceQueue.hpp"
 
 
 void AtlasServer::run() {
@@ -26,6 +27,12 @@ void AtlasServer::run() {
         auto dataPath = this->serverConfig["database_path"].toString();
         DatabaseManager::init(dataPath);
         AT_INFO("Database filepath is {0}.", dataPath);
+
+        // "batched" trades the last batch on a crash for one sync per batch, "synchronous" waits for every commit
+        const auto durability = this->serverConfig["database_durability"].toString("batched") == "synchronous"
+                                    ? PersistenceQueue::Durability::Synchronous
+                                    : PersistenceQueue::Durability::Batched;
+        PersistenceQueue::start(std::chrono::milliseconds(this->serverConfig["database_batch_ms"].toInt(50)), durability);
     } catch (const std::exception &e) {
         AT_ERROR("Failed to load database: {0}", e.what());
     };
@@ -34,5 +41,8 @@ void AtlasServer::run() {
 
     this->serverManager.start(this->serverConfig["server_port"].toInt());
 
+    // the server has stopped, write whatever is still queued
+    PersistenceQueue::stop();
+
     AT_INFO("Server finished loading...");
 }
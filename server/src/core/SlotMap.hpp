@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * Pool of T addressed by generational handles. Elements live in fixed pages that are never moved, so
+ * pointers and references stay valid until the element itself is erased, however many are added
+ * after it. Erased slots are reused; the generation in the handle makes a stale handle miss instead
+ * of finding the slot's new occupant. Lookup, emplace and erase are O(1).
+ */
+template<typename T, size_t PageSize = 64>
+class SlotMap {
+public:
+    struct Handle {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool operator==(const Handle &) const = default;
+    };
+
+    SlotMap() = default;
+    SlotMap(const SlotMap &) = delete;
+    SlotMap &operator=(const SlotMap &) = delete;
+
+    template<typename... Args>
+    Handle emplace(Args &&... args) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            index = static_cast<uint32_t>(capacity());
+            pages.push_back(std::make_unique<Slot[]>(PageSize));
+            for (size_t i = PageSize - 1; i > 0; --i) {
+                freeSlots.push_back(index + static_cast<uint32_t>(i));
+            }
+        }
+
+        Slot &slot = getSlot(index);
+        slot.value.emplace(std::forward<Args>(args)...);
+        ++count;
+        return {index, slot.generation};
+    }
+
+    bool erase(Handle handle) {
+        if (!get(handle)) return false;
+
+        Slot &slot = getSlot(handle.index);
+        slot.value.reset();
+        ++slot.generation;
+        freeSlots.push_back(handle.index);
+        --count;
+        return true;
+    }
+
+    T *get(Handle handle) {
+        if (handle.index >= capacity()) return nullptr;
+
+        Slot &slot = getSlot(handle.index);
+        return slot.generation == handle.generation && slot.value ? &*slot.value : nullptr;
+    }
+
+    bool contains(Handle handle) { return get(handle) != nullptr; }
+
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+    // Visits the live elements in slot order, skipping free slots.
+    template<bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T *, T *>;
+        using reference = std::conditional_t<Const, const T &, T &>;
+        using Owner = std::conditional_t<Const, const SlotMap, SlotMap>;
+
+        Iterator() = default;
+
+        Iterator(Owner *owner, size_t index) : owner(owner), index(index) { skipFree(); }
+
+        reference operator*() const { return *owner->getSlot(index).value; }
+        pointer operator->() const { return &**this; }
+
+        Iterator &operator++() {
+            ++index;
+            skipFree();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator &other) const { return index == other.index; }
+
+    private:
+        Owner *owner = nullptr;
+        size_t index = 0;
+
+        void skipFree() {
+            while (index < owner->capacity() && !owner->getSlot(index).value) ++index;
+        }
+    };
+
+    Iterator<false> begin() { return {this, 0}; }
+    Iterator<false> end() { return {this, capacity()}; }
+    Iterator<true> begin() const { return {this, 0}; }
+    Iterator<true> end() const { return {this, capacity()}; }
+
+private:
+    struct Slot {
+        std::optional<T> value;
+        uint32_t generation = 0;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> pages;
+    std::vector<uint32_t> freeSlots; // reused last in, first out
+    size_t count = 0;
+
+    size_t capacity() const { return pages.size() * PageSize; }
+
+    Slot &getSlot(size_t index) { return pages[index / PageSize][index % PageSize]; }
+    const Slot &getSlot(size_t index) const { return pages[index / PageSize][index % PageSize]; }
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Atlas.hpp>
+
+/**
+ * Fixed bucket histogram of tick durations. Bucket i counts ticks up to 0.25ms * 2^i,
+ * the last bucket takes everything slower than that.
+ */
+class TickHistogram {
+public:
+    static constexpr size_t BUCKETS = 12;
+    static constexpr double FIRST_BUCKET_MS = 0.25;
+
+    void record(double milliseconds) {
+        size_t bucket = 0;
+        while (bucket < BUCKETS - 1 && milliseconds > bucketUpperBound(bucket)) {
+            ++bucket;
+        }
+
+        ++buckets[bucket];
+        ++count;
+        totalMs += milliseconds;
+        maxMs = std::max(maxMs, milliseconds);
+    }
+
+    // Upper bound of the bucket the given percentile (0-1) falls in.
+    double percentile(double p) const {
+        if (count == 0) return 0.0;
+
+        const auto target = static_cast<uint64_t>(std::ceil(p * static_cast<double>(count)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS - 1; ++i) {
+            seen += buckets[i];
+            if (seen >= target) return bucketUpperBound(i);
+        }
+        return maxMs;
+    }
+
+    static double bucketUpperBound(size_t bucket) {
+        return FIRST_BUCKET_MS * static_cast<double>(1ull << bucket);
+    }
+
+    const std::array<uint64_t, BUCKETS> &getBuckets() const { return buckets; }
+    uint64_t getCount() const { return count; }
+    double getMean() const { return count ? totalMs / static_cast<double>(count) : 0.0; }
+    double getMax() const { return maxMs; }
+
+private:
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+};
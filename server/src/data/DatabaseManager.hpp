@@ -1,6 +1,10 @@
 #pragma once
 
 #include <sqlite_orm/sqlite_orm.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include "Player.hpp"
 #include "Match.hpp"
 
@@ -9,6 +13,7 @@ namespace sql= sqlite_orm ;
 inline auto createStorage(const std::string &dbFile) {
     return sql::make_storage(
         dbFile,
+        sql::make_unique_index("idx_players_username", &Player::getUsername),
         sql::make_table(
             "Players",
             sql::make_column("id", &Player::getId, &Player::setId, sql::primary_key().autoincrement()),
@@ -33,47 +38,118 @@ inline auto createStorage(const std::string &dbFile) {
 
 using Storage = decltype(createStorage(""));
 
+// Login and register look players up by name on every request, the statement is compiled once.
+inline auto prepareFindPlayerByUsername(Storage &storage) {
+    return storage.prepare(sql::get_all<Player>(sql::where(sql::c(&Player::getUsername) == std::string()), sql::limit(1)));
+}
+
+using FindPlayerByUsernameStatement = decltype(prepareFindPlayerByUsername(std::declval<Storage &>()));
+
 template <typename T>
 concept DatabaseType = std::same_as<T, Player> || std::same_as<T, Match>;
 
 class DatabaseManager {
 public:
+    // Nothing is published until every step succeeded, a failed init leaves both pointers null instead of
+    // a storage without its statement.
     static void init(const std::string &dbFile) {
-        m_storage = new Storage(createStorage(dbFile));
-        m_storage->sync_schema();
+        std::unique_ptr<Storage> opened(new Storage(createStorage(dbFile)));
+        // prepared statements need the connection to stay open
+        opened->open_forever();
+        opened->pragma.journal_mode(sql::journal_mode::WAL);
+        opened->sync_schema();
+
+        std::unique_ptr<FindPlayerByUsernameStatement> prepared(
+            new FindPlayerByUsernameStatement(prepareFindPlayerByUsername(*opened)));
+
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        m_storage = opened.release();
+        m_findPlayerByUsername = prepared.release();
     }
 
     static void shutdown() {
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        delete m_findPlayerByUsername;
+        m_findPlayerByUsername = nullptr;
         delete m_storage;
+        m_storage = nullptr;
+    }
+
+    // Uses the unique index on Players.username instead of scanning the table.
+    static std::optional<Player> findPlayerByUsername(const std::string &username) {
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+
+        if (!m_findPlayerByUsername) {
+            throw std::runtime_error("Database is not initialized");
+        }
+        sql::get<0>(*m_findPlayerByUsername) = username;
+        auto players = storage().execute(*m_findPlayerByUsername);
+        if (players.empty()) {
+            return std::nullopt;
+        }
+        return std::move(players.front());
+    }
+
+    // FULL syncs the WAL on every commit, NORMAL only at checkpoints and may lose the last commits on power loss.
+    static void setSynchronous(bool full) {
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        storage().pragma.synchronous(full ? 2 : 1);
+    }
+
+    // Runs func in one transaction, rolled back if it throws.
+    template <typename Func>
+    static void transaction(Func &&func) {
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        storage().transaction([&] {
+            func();
+            return true;
+        });
     }
 
     template <DatabaseType T>
     static void create(const T &entity) {
-        m_storage->insert(entity);
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        storage().insert(entity);
     }
 
     template <DatabaseType T, typename... Args>
     static T emplace_create(Args&&... args) {
         T entity(std::forward<Args>(args)...);
-        m_storage->insert(entity);
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        storage().insert(entity);
         return entity;
     }
 
     template <DatabaseType T>
     static std::vector<T> getAll() {
-        return m_storage->get_all<T>();
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        return storage().get_all<T>();
     }
 
     template <DatabaseType T>
     static void update(const T &entity) {
-        m_storage->update(entity);
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        storage().update(entity);
     }
 
     template <DatabaseType T>
     static void remove(const T &entity) {
-        m_storage->remove<T>(entity.getId());
+        std::lock_guard<std::recursive_mutex> lock(m_statementMutex);
+        storage().remove<T>(entity.getId());
     }
 
 private:
+    // Throws when init failed, the route answers with an error instead of dereferencing null.
+    static Storage &storage() {
+        if (!m_storage) {
+            throw std::runtime_error("Database is not initialized");
+        }
+        return *m_storage;
+    }
+
     inline static Storage* m_storage = nullptr;
+    inline static FindPlayerByUsernameStatement* m_findPlayerByUsername = nullptr;
+    // Every statement goes through the one open connection, so nothing can land inside another thread's
+    // transaction. Recursive because transaction() bodies call the accessors.
+    inline static std::recursive_mutex m_statementMutex;
 };
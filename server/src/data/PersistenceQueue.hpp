@@ -0,0 +1,203 @@
+#pragma once
+
+#include <Atlas.hpp>
+
+#include "DatabaseManager.hpp"
+
+struct PersistenceStats {
+    size_t queueDepth = 0;
+    size_t maxQueueDepth = 0;
+    uint64_t batchesCommitted = 0;
+    uint64_t writesCommitted = 0;
+    uint64_t writesCoalesced = 0; // player updates replaced by a newer one before they were written
+    double lastBatchMs = 0.0;
+};
+
+/**
+ * Write-behind queue in front of DatabaseManager. Callers only enqueue; a worker thread commits
+ * everything queued during the last interval in one transaction, so SQLite syncs once per batch
+ * instead of once per row. Several updates of the same player in one batch collapse into the last.
+ *
+ * Batched durability returns right away and may lose the last interval on a crash. Synchronous
+ * durability makes every write wait until its batch is committed with synchronous=FULL.
+ */
+class PersistenceQueue {
+public:
+    enum class Durability {
+        Batched,
+        Synchronous
+    };
+
+    static void start(std::chrono::milliseconds interval = std::chrono::milliseconds(50),
+                      Durability durability = Durability::Batched) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) return;
+
+        m_interval = interval;
+        m_durability = durability;
+        DatabaseManager::setSynchronous(durability == Durability::Synchronous);
+
+        m_running = true;
+        m_worker = std::thread(&PersistenceQueue::workerLoop);
+        AT_INFO("Persistence queue started, {}ms batches, {} durability.", interval.count(),
+                durability == Durability::Synchronous ? "synchronous" : "batched");
+    }
+
+    // Writes everything still queued and stops the worker.
+    static void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running) return;
+            m_running = false;
+        }
+        m_condition.notify_all();
+
+        if (m_worker.joinable()) {
+            m_worker.join();
+        }
+        AT_INFO("Persistence queue stopped, {} writes in {} batches.", m_stats.writesCommitted, m_stats.batchesCommitted);
+    }
+
+    static void update(const Player &player) {
+        enqueue([&] {
+            if (auto it = m_pendingPlayers.find(player.getId()); it != m_pendingPlayers.end()) {
+                m_pending[it->second] = player;
+                ++m_stats.writesCoalesced;
+                return;
+            }
+            m_pendingPlayers[player.getId()] = m_pending.size();
+            m_pending.emplace_back(player);
+        });
+    }
+
+    static void create(const Match &match) {
+        enqueue([&] {
+            m_pending.emplace_back(match);
+        });
+    }
+
+    // Blocks until everything queued before the call is committed.
+    static void flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+
+        const uint64_t target = m_enqueued;
+        waitForCommit(lock, target);
+    }
+
+    static PersistenceStats getStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto stats = m_stats;
+        stats.queueDepth = m_pending.size();
+        return stats;
+    }
+
+private:
+    using Write = std::variant<Player, Match>;
+
+    inline static std::mutex m_mutex;
+    inline static std::condition_variable m_condition;
+    inline static std::condition_variable m_committedCondition;
+    inline static std::thread m_worker;
+    inline static bool m_running = false;
+
+    inline static std::chrono::milliseconds m_interval{50};
+    inline static Durability m_durability = Durability::Batched;
+
+    inline static std::vector<Write> m_pending;
+    inline static std::unordered_map<int, size_t> m_pendingPlayers; // player id -> index in m_pending
+    inline static uint64_t m_enqueued = 0;
+    inline static uint64_t m_committed = 0;
+    inline static uint64_t m_flushTarget = 0;
+    inline static PersistenceStats m_stats;
+
+    template<typename Func>
+    static void enqueue(Func &&push) {
+        uint64_t ticket;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running) {
+                // not started or already shut down, write through
+                push();
+                commit(m_pending);
+                m_pending.clear();
+                m_pendingPlayers.clear();
+                return;
+            }
+
+            push();
+            ticket = ++m_enqueued;
+            m_stats.maxQueueDepth = std::max(m_stats.maxQueueDepth, m_pending.size());
+        }
+
+        if (m_durability == Durability::Synchronous) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            waitForCommit(lock, ticket);
+        }
+    }
+
+    // Wakes the worker early instead of letting the caller sit out the rest of the interval.
+    static void waitForCommit(std::unique_lock<std::mutex> &lock, uint64_t ticket) {
+        m_flushTarget = std::max(m_flushTarget, ticket);
+        m_condition.notify_all();
+        m_committedCondition.wait(lock, [&] { return m_committed >= ticket; });
+    }
+
+    static void workerLoop() {
+        std::vector<Write> batch;
+
+        while (true) {
+            uint64_t batchEnd;
+            bool running;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait_for(lock, m_interval, [] { return !m_running || m_flushTarget > m_committed; });
+
+                running = m_running;
+                batchEnd = m_enqueued;
+                batch.swap(m_pending);
+                m_pendingPlayers.clear();
+            }
+
+            if (!batch.empty()) {
+                const auto batchStart = std::chrono::steady_clock::now();
+                commit(batch);
+                const double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_stats.batchesCommitted;
+                m_stats.writesCommitted += batch.size();
+                m_stats.lastBatchMs = batchMs;
+                batch.clear();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_committed = batchEnd;
+            }
+            m_committedCondition.notify_all();
+
+            if (!running) {
+                return;
+            }
+        }
+    }
+
+    static void commit(const std::vector<Write> &batch) {
+        try {
+            DatabaseManager::transaction([&] {
+                for (const auto &write: batch) {
+                    std::visit([]<typename T>(const T &entity) {
+                        if constexpr (std::same_as<T, Player>) {
+                            DatabaseManager::update(entity);
+                        } else {
+                            DatabaseManager::create(entity);
+                        }
+                    }, write);
+                }
+            });
+        } catch (const std::exception &e) {
+            AT_ERROR("Failed to commit {} queued database writes: {}", batch.size(), e.what());
+        }
+    }
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Atlas.hpp>
+#include <entt/entt.hpp>
+
+/**
+ * Uniform grid laid over the lobby map, one cell per tile.
+ *
+ * Solid walls are stored one per cell and only change when a wall is turned into a path tile.
+ * Moving bodies (pawns and fireballs) are bucketed by the cell their center falls in and are
+ * rebuilt every tick. No collider in the game is wider than a tile, so an overlap query only
+ * has to look at the 3x3 cells around a position.
+ */
+class CollisionGrid {
+public:
+    CollisionGrid() = default;
+
+    CollisionGrid(int width, int height, const glm::vec2 &tileSize)
+        : width(width),
+          height(height),
+          tileSize(tileSize),
+          origin(-(width * tileSize.x) / 2.0f, -(height * tileSize.y) / 2.0f),
+          walls(width * height, entt::null),
+          bodies(width * height) {
+    }
+
+    void setWall(const glm::vec3 &position, entt::entity wall) {
+        if (isEmpty()) return;
+        walls[cellIndex(position)] = wall;
+    }
+
+    void clearWall(const glm::vec3 &position, entt::entity wall) {
+        if (isEmpty()) return;
+        if (auto &cell = walls[cellIndex(position)]; cell == wall) {
+            cell = entt::null;
+        }
+    }
+
+    // Drops every moving body but keeps the bucket capacity, so a rebuild does not allocate.
+    void clearBodies() {
+        for (auto &cell: bodies) {
+            cell.clear();
+        }
+    }
+
+    void insertBody(entt::entity entity, const glm::vec3 &position) {
+        if (isEmpty()) return;
+        bodies[cellIndex(position)].push_back(entity);
+    }
+
+    void removeBody(entt::entity entity, const glm::vec3 &position) {
+        if (isEmpty()) return;
+        auto &cell = bodies[cellIndex(position)];
+        if (auto it = std::ranges::find(cell, entity); it != cell.end()) {
+            *it = cell.back();
+            cell.pop_back();
+        }
+    }
+
+    void moveBody(entt::entity entity, const glm::vec3 &from, const glm::vec3 &to) {
+        if (isEmpty() || cellIndex(from) == cellIndex(to)) return;
+        removeBody(entity, from);
+        insertBody(entity, to);
+    }
+
+    // Calls func(wall) for the solid walls around position until it returns true.
+    template<typename Func>
+    bool anyWall(const glm::vec3 &position, Func &&func) const {
+        return forEachNeighbour(position, [&](size_t index) {
+            return walls[index] != entt::null && func(walls[index]);
+        });
+    }
+
+    // Calls func(entity) for the moving bodies around position until it returns true.
+    template<typename Func>
+    bool anyBody(const glm::vec3 &position, Func &&func) const {
+        return forEachNeighbour(position, [&](size_t index) {
+            for (const auto entity: bodies[index]) {
+                if (func(entity)) return true;
+            }
+            return false;
+        });
+    }
+
+    bool isEmpty() const { return width == 0 || height == 0; }
+
+private:
+    int width = 0;
+    int height = 0;
+    glm::vec2 tileSize{0.0f};
+    glm::vec2 origin{0.0f};
+
+    std::vector<entt::entity> walls;
+    std::vector<std::vector<entt::entity>> bodies;
+
+    // Positions outside the map are clamped to the border cells. Clamping never pulls two
+    // overlapping colliders more than one cell apart, so the 3x3 query stays exact.
+    int column(float x) const {
+        return std::clamp(static_cast<int>(std::floor((x - origin.x) / tileSize.x)), 0, width - 1);
+    }
+
+    int row(float y) const {
+        return std::clamp(static_cast<int>(std::floor((y - origin.y) / tileSize.y)), 0, height - 1);
+    }
+
+    size_t cellIndex(const glm::vec3 &position) const {
+        return static_cast<size_t>(row(position.y)) * width + column(position.x);
+    }
+
+    template<typename Func>
+    bool forEachNeighbour(const glm::vec3 &position, Func &&func) const {
+        if (isEmpty()) return false;
+
+        const int centerColumn = column(position.x);
+        const int centerRow = row(position.y);
+
+        for (int r = std::max(centerRow - 1, 0); r <= std::min(centerRow + 1, height - 1); ++r) {
+            for (int c = std::max(centerColumn - 1, 0); c <= std::min(centerColumn + 1, width - 1); ++c) {
+                if (func(static_cast<size_t>(r) * width + c)) return true;
+            }
+        }
+        return false;
+    }
+};
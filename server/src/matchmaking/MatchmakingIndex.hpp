@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+struct MatchmakingWindow {
+    double baseWidth = 100.0;      // rating points either side of the anchor when it just queued
+    double deviationFactor = 0.5;  // uncertain ratings search wider, per point of rating deviation
+    double growthPerSecond = 25.0; // widening per second spent in the queue
+    double maxWidth = 600.0;       // the matchmaker rejects groups spread wider than this anyway
+};
+
+/**
+ * Queued players of one game mode ordered by Glicko rating, plus their arrival order.
+ *
+ * A matchmaking pass walks the players from the longest waiting one. Each of them anchors a search
+ * window around its own rating which widens the longer it waits; the closest players inside the
+ * window are found by stepping outwards from the anchor's position in the rating order, so a
+ * candidate group costs O(group size) instead of a scan over the whole queue. The candidates of a
+ * pass are collected first so they can be scored together. Insert and erase are O(log n).
+ */
+class MatchmakingIndex {
+public:
+    using Clock = std::chrono::system_clock;
+
+    static constexpr size_t MAX_GROUP_SIZE = 4;
+
+    explicit MatchmakingIndex(MatchmakingWindow settings = {}) : settings(settings) {}
+
+    bool insert(uint64_t playerId, double rating, double deviation, Clock::time_point queueTime) {
+        if (entries.contains(playerId)) {
+            return false;
+        }
+
+        const uint64_t sequence = nextSequence++;
+        const auto position = byRating.insert({rating, playerId}).first;
+        arrivals.emplace(sequence, playerId);
+        entries.emplace(playerId, Entry{deviation, queueTime, sequence, position});
+        return true;
+    }
+
+    bool erase(uint64_t playerId) {
+        const auto it = entries.find(playerId);
+        if (it == entries.end()) {
+            return false;
+        }
+
+        byRating.erase(it->second.position);
+        arrivals.erase(it->second.sequence);
+        entries.erase(it);
+        return true;
+    }
+
+    bool contains(uint64_t playerId) const { return entries.contains(playerId); }
+
+    size_t size() const { return entries.size(); }
+
+    bool empty() const { return entries.empty(); }
+
+    // Half width of the rating window a player searches after waiting `waited`.
+    double getWindow(double deviation, Clock::duration waited) const {
+        const double seconds = std::chrono::duration<double>(waited).count();
+        const double width = settings.baseWidth + settings.deviationFactor * deviation + settings.growthPerSecond * seconds;
+        return std::min(width, settings.maxWidth);
+    }
+
+    /**
+     * Candidate groups of one matchmaking pass, nobody is removed. For every anchor, longest waiting first,
+     * the groupSize closest players inside its window are appended to groups, anchor first; anchors without
+     * a full group add nothing. Groups of different anchors overlap, the caller keeps the first group it
+     * accepts for every player. Returns the number of groups appended.
+     */
+    size_t collectCandidates(size_t groupSize, Clock::time_point now, std::vector<uint64_t> &groups) const {
+        if (groupSize < 2 || groupSize > MAX_GROUP_SIZE || entries.size() < groupSize) {
+            return 0;
+        }
+
+        size_t count = 0;
+        for (const auto &[anchorSequence, anchorId]: arrivals) {
+            const Entry &anchor = entries.at(anchorId);
+            const double anchorRating = anchor.position->rating;
+            const double window = getWindow(anchor.deviation, now - anchor.queueTime);
+
+            const size_t first = groups.size();
+            groups.push_back(anchorId);
+
+            // step outwards from the anchor, always taking the closer of the two neighbours
+            auto below = anchor.position;
+            auto above = std::next(anchor.position);
+            while (groups.size() - first < groupSize) {
+                const bool hasBelow = below != byRating.begin();
+                const bool hasAbove = above != byRating.end();
+                if (!hasBelow && !hasAbove) break;
+
+                const double belowDistance = hasBelow ? anchorRating - std::prev(below)->rating : window + 1.0;
+                const double aboveDistance = hasAbove ? above->rating - anchorRating : window + 1.0;
+                if (std::min(belowDistance, aboveDistance) > window) break;
+
+                if (belowDistance <= aboveDistance) {
+                    --below;
+                    groups.push_back(below->playerId);
+                } else {
+                    groups.push_back(above->playerId);
+                    ++above;
+                }
+            }
+
+            if (groups.size() - first == groupSize) {
+                ++count;
+            } else {
+                groups.resize(first);
+            }
+        }
+
+        return count;
+    }
+
+private:
+    struct RatingKey {
+        double rating;
+        uint64_t playerId;
+
+        bool operator<(const RatingKey &other) const {
+            return rating < other.rating || (rating == other.rating && playerId < other.playerId);
+        }
+    };
+
+    struct Entry {
+        double deviation;
+        Clock::time_point queueTime;
+        uint64_t sequence;
+        std::set<RatingKey>::iterator position;
+    };
+
+    MatchmakingWindow settings;
+    uint64_t nextSequence = 0;
+
+    std::set<RatingKey> byRating;
+    std::map<uint64_t, uint64_t> arrivals; // arrival sequence -> player id
+    std::unordered_map<uint64_t, Entry> entries;
+};
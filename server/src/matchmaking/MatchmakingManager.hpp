@@ -1,12 +1,27 @@
 #pragma once
 
 #include <Atlas.hpp>
-#include <Windows.h>
 #include "../data/DatabaseManager.hpp"
+#include "../data/PersistenceQueue.hpp"
 #include "../data/Player.hpp"
 
+#include <span>
+
+#if defined(ATLAS_STATIC_MATCHMAKER)
+#include <Matchmaking.hpp>
+#elif defined(_WIN32)
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
 class MatchmakingManager {
 public:
+#ifdef ATLAS_STATIC_MATCHMAKER
+    using Rating = ::Rating;
+    using MatchQuality = ::MatchQuality;
+    using RatingPeriodTable = ::RatingPeriodTable;
+#else
     // DLL structs matching the binary interface
     struct Rating {
         double rating;
@@ -23,52 +38,95 @@ public:
         double quality;
     };
 
+    struct RatingPeriodTable {
+        int playerCount;
+        const double* rating;
+        const double* deviation;
+        const double* volatility;
+        const int* wins;
+        const int* losses;
+
+        const int* resultOffsets;
+        const int* opponents;
+        const double* scores;
+
+        double* newRating;
+        double* newDeviation;
+        double* newVolatility;
+        int* newWins;
+        int* newLosses;
+    };
+#endif
+
     static void init() {
-#ifdef WIN32
-        hDLL = LoadLibrary("matchmaker.dll");
+#ifdef ATLAS_STATIC_MATCHMAKER
+        getDefaultRatingFunc = &::getDefaultRating;
+        evaluateMatchFunc = &::evaluateMatch;
+        evaluateMatchesBatchFunc = &::evaluateMatchesBatch;
+        canPlayerJoinFunc = &::canPlayerJoin;
+        getValidRatingRangeFunc = &::getValidRatingRange;
+        updateRatingsFunc = &::updateRatings;
+        updateRatingPeriodFunc = &::updateRatingPeriod;
+#else
+        hDLL = openLibrary();
         if (!hDLL) {
-            AT_FATAL("Failed to load matchmaker.dll");
+            AT_FATAL("Failed to load {}", LIBRARY_NAME);
             return;
         }
 
         // Load core functions
-        getDefaultRatingFunc = (GetDefaultRatingFunc)GetProcAddress(hDLL, "getDefaultRating");
-        evaluateMatchFunc = (EvaluateMatchFunc)GetProcAddress(hDLL, "evaluateMatch");
-        canPlayerJoinFunc = (CanPlayerJoinFunc)GetProcAddress(hDLL, "canPlayerJoin");
-        getValidRatingRangeFunc = (GetValidRatingRangeFunc)GetProcAddress(hDLL, "getValidRatingRange");
-        updateRatingsFunc = (UpdateRatingsFunc)GetProcAddress(hDLL, "updateRatings");
-
-        if (!getDefaultRatingFunc || !evaluateMatchFunc || !canPlayerJoinFunc ||
-            !getValidRatingRangeFunc || !updateRatingsFunc) {
+        getDefaultRatingFunc = loadSymbol<GetDefaultRatingFunc>("getDefaultRating");
+        evaluateMatchFunc = loadSymbol<EvaluateMatchFunc>("evaluateMatch");
+        evaluateMatchesBatchFunc = loadSymbol<EvaluateMatchesBatchFunc>("evaluateMatchesBatch");
+        canPlayerJoinFunc = loadSymbol<CanPlayerJoinFunc>("canPlayerJoin");
+        getValidRatingRangeFunc = loadSymbol<GetValidRatingRangeFunc>("getValidRatingRange");
+        updateRatingsFunc = loadSymbol<UpdateRatingsFunc>("updateRatings");
+        updateRatingPeriodFunc = loadSymbol<UpdateRatingPeriodFunc>("updateRatingPeriod");
+
+        if (!getDefaultRatingFunc || !evaluateMatchFunc || !evaluateMatchesBatchFunc || !canPlayerJoinFunc ||
+            !getValidRatingRangeFunc || !updateRatingsFunc || !updateRatingPeriodFunc) {
             shutdown();
-            AT_ERROR("Failed to load core functions from matchmaker.dll");
+            AT_ERROR("Failed to load core functions from {}", LIBRARY_NAME);
         }
 #endif
     }
 
     static void shutdown() {
-#ifdef WIN32
+#ifndef ATLAS_STATIC_MATCHMAKER
         if (hDLL) {
-            FreeLibrary(hDLL);
+            closeLibrary(hDLL);
             hDLL = nullptr;
         }
 #endif
+        getDefaultRatingFunc = nullptr;
+        evaluateMatchFunc = nullptr;
+        evaluateMatchesBatchFunc = nullptr;
+        canPlayerJoinFunc = nullptr;
+        getValidRatingRangeFunc = nullptr;
+        updateRatingsFunc = nullptr;
+        updateRatingPeriodFunc = nullptr;
     }
 
     static void getDefaultRating(Player& player) {
-#ifdef WIN32
-        Rating rating;
-        getDefaultRatingFunc(&rating);
-
-        player.setMmr(1500); // Default MMR
-        player.setGlickoRating(rating.rating);
-        player.setRatingDeviation(rating.deviation);
-        player.setVolatility(rating.volatility);
-#endif
+        if (getDefaultRatingFunc) {
+            Rating rating;
+            getDefaultRatingFunc(&rating);
+
+            player.setMmr(1500); // Default MMR
+            player.setGlickoRating(rating.rating);
+            player.setRatingDeviation(rating.deviation);
+            player.setVolatility(rating.volatility);
+        }
     }
 
     static MatchQuality evaluateMatch(const std::vector<Player>& players) {
-#ifdef WIN32
+        if (!evaluateMatchFunc) {
+            MatchQuality quality = {};
+            quality.isValid = false;
+            std::snprintf(quality.reason, sizeof(quality.reason), "%s", "Matchmaker not loaded");
+            return quality;
+        }
+
         std::vector<Rating> ratings;
         for (const auto& player : players) {
             ratings.push_back({
@@ -83,16 +141,32 @@ public:
         MatchQuality quality;
         evaluateMatchFunc(ratings.data(), static_cast<int>(ratings.size()), &quality);
         return quality;
-#else
-        MatchQuality quality = {};
-        quality.isValid = false;
-        strcpy_s(quality.reason, "DLL not loaded");
-        return quality;
-#endif
+    }
+
+    static Rating toRating(const Player& player) {
+        return {player.getGlickoRating(), player.getRatingDeviation(), player.getVolatility(), 0, 0};
+    }
+
+    // Quality of every group of groupSize indices into pool, 0 for groups that are not valid matches.
+    // Unlike evaluateMatch no reason is produced, use it in loops over candidate groups.
+    static void evaluateMatchesBatch(std::span<const Rating> pool, std::span<const int> groupIndices,
+                                     int groupSize, std::span<float> qualityOut) {
+        const int groupCount = groupSize > 0 ? static_cast<int>(groupIndices.size()) / groupSize : 0;
+        if (!evaluateMatchesBatchFunc || static_cast<int>(qualityOut.size()) < groupCount) {
+            std::fill(qualityOut.begin(), qualityOut.end(), 0.0f);
+            return;
+        }
+
+        evaluateMatchesBatchFunc(pool.data(), static_cast<int>(pool.size()), groupIndices.data(),
+                                 groupSize, groupCount, qualityOut.data());
     }
 
     static bool canPlayerJoin(const Player& newPlayer, const std::vector<Player>& existingPlayers, std::string& reason) {
-#ifdef WIN32
+        if (!canPlayerJoinFunc) {
+            reason = "Matchmaker not loaded";
+            return false;
+        }
+
         Rating newRating{
             newPlayer.getGlickoRating(),
             newPlayer.getRatingDeviation(),
@@ -116,14 +190,14 @@ public:
                                        reasonBuffer, sizeof(reasonBuffer));
         reason = reasonBuffer;
         return canJoin;
-#else
-        reason = "DLL not loaded";
-        return false;
-#endif
     }
 
     static void updateRatings(const std::vector<Player>& players, const Player& winner) {
-#ifdef WIN32
+        if (!updateRatingsFunc) {
+            AT_ERROR("Matchmaker not loaded, ratings were not updated");
+            return;
+        }
+
         for (const auto& currentPlayer : players) {
             std::vector<Rating> opponentRatings;
             std::vector<double> results;
@@ -166,29 +240,76 @@ public:
                 updatedPlayer.setGlickoRating(currentRating.rating);
                 updatedPlayer.setRatingDeviation(currentRating.deviation);
                 updatedPlayer.setVolatility(currentRating.volatility);
-                DatabaseManager::update(updatedPlayer);
+                PersistenceQueue::update(updatedPlayer);
             } else {
                 AT_ERROR("Failed to update ratings for player {0}: {1}",
                         currentPlayer.getUsername(), errorMsg);
             }
         }
-#endif
+    }
+
+    // Glicko-2 update of a whole rating period in one call, e.g. a recomputation over every player.
+    // Fills the table's new* columns, see RatingPeriodTable in the matchmaker's Matchmaking.hpp.
+    static bool updateRatingPeriod(const RatingPeriodTable& period, int threadCount, std::string& error) {
+        if (!updateRatingPeriodFunc) {
+            error = "Matchmaker not loaded";
+            return false;
+        }
+
+        char errorMsg[256];
+        if (!updateRatingPeriodFunc(&period, threadCount, errorMsg, sizeof(errorMsg))) {
+            error = errorMsg;
+            return false;
+        }
+        return true;
     }
 
 private:
-#ifdef WIN32
     // Function pointer types
     typedef void (*GetDefaultRatingFunc)(Rating*);
     typedef void (*EvaluateMatchFunc)(const Rating*, int, MatchQuality*);
+    typedef void (*EvaluateMatchesBatchFunc)(const Rating*, int, const int*, int, int, float*);
     typedef bool (*CanPlayerJoinFunc)(const Rating*, const Rating*, int, char*, int);
     typedef void (*GetValidRatingRangeFunc)(const Rating*, int, double*, double*, bool*, char*, int);
     typedef void (*UpdateRatingsFunc)(Rating*, const Rating*, const double*, int, bool*, char*, int);
+    typedef bool (*UpdateRatingPeriodFunc)(const RatingPeriodTable*, int, char*, int);
+
+#ifndef ATLAS_STATIC_MATCHMAKER
+#ifdef _WIN32
+    using LibraryHandle = HMODULE;
+    static constexpr const char* LIBRARY_NAME = "matchmaker.dll";
+
+    static LibraryHandle openLibrary() { return LoadLibraryA(LIBRARY_NAME); }
+    static void closeLibrary(LibraryHandle library) { FreeLibrary(library); }
+
+    template<typename Func>
+    static Func loadSymbol(const char* name) { return reinterpret_cast<Func>(GetProcAddress(hDLL, name)); }
+#else
+    using LibraryHandle = void*;
+    static constexpr const char* LIBRARY_NAME = "libmatchmaker.so"; // found through the server's $ORIGIN rpath
+
+    static LibraryHandle openLibrary() {
+        LibraryHandle library = dlopen(LIBRARY_NAME, RTLD_NOW | RTLD_LOCAL);
+        if (!library) {
+            AT_ERROR("dlopen: {}", dlerror());
+        }
+        return library;
+    }
+
+    static void closeLibrary(LibraryHandle library) { dlclose(library); }
+
+    template<typename Func>
+    static Func loadSymbol(const char* name) { return reinterpret_cast<Func>(dlsym(hDLL, name)); }
+#endif
+
+    inline static LibraryHandle hDLL = nullptr;
+#endif
 
-    inline static HMODULE hDLL = nullptr;
     inline static GetDefaultRatingFunc getDefaultRatingFunc = nullptr;
     inline static EvaluateMatchFunc evaluateMatchFunc = nullptr;
+    inline static EvaluateMatchesBatchFunc evaluateMatchesBatchFunc = nullptr;
     inline static CanPlayerJoinFunc canPlayerJoinFunc = nullptr;
     inline static GetValidRatingRangeFunc getValidRatingRangeFunc = nullptr;
     inline static UpdateRatingsFunc updateRatingsFunc = nullptr;
-#endif
+    inline static UpdateRatingPeriodFunc updateRatingPeriodFunc = nullptr;
 };
\ No newline at end of file
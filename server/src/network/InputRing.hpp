@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "entity/PawnMovement.hpp"
+
+/**
+ * Inputs of one player connection in arrival order, a fixed single producer single consumer ring.
+ * The connection pushes, the lobby tick drains; neither allocates nor waits. Every connection gets a
+ * ring of its own, so a second connection for the same player (a reconnect before the old one
+ * closed) cannot interleave its stream with the first; the lobby closes the old ring, which refuses
+ * further pushes, and drains it once more. Inputs that are not newer than the last pushed one are
+ * refused. A full ring refuses the input, at 64 records that is several ticks of a client that
+ * stopped being drained.
+ */
+class InputRing {
+public:
+    static constexpr size_t CAPACITY = 64; // power of two
+
+    // Producer side, only ever called by the connection that owns the ring.
+    bool push(const PlayerInput &input) {
+        if (closed.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (input.sequence == 0 || input.sequence <= lastPushed) {
+            return false;
+        }
+
+        const uint64_t tail = tailPosition.load(std::memory_order_relaxed);
+        if (tail - headPosition.load(std::memory_order_acquire) == CAPACITY) {
+            return false;
+        }
+
+        records[tail & (CAPACITY - 1)] = input;
+        tailPosition.store(tail + 1, std::memory_order_release);
+        lastPushed = input.sequence;
+        return true;
+    }
+
+    // Refuses every later push, a push already past the check still lands and is drained.
+    void close() { closed.store(true, std::memory_order_relaxed); }
+
+    // Consumer side. Calls func(const PlayerInput &) for every queued input, oldest first, and
+    // returns how many there were.
+    template<typename Func>
+    size_t drain(Func &&func) {
+        const uint64_t head = headPosition.load(std::memory_order_relaxed);
+        const uint64_t tail = tailPosition.load(std::memory_order_acquire);
+
+        for (uint64_t position = head; position != tail; ++position) {
+            func(records[position & (CAPACITY - 1)]);
+        }
+
+        headPosition.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+private:
+    std::array<PlayerInput, CAPACITY> records;
+    alignas(64) std::atomic<uint64_t> headPosition{0};
+    alignas(64) std::atomic<uint64_t> tailPosition{0};
+    std::atomic<bool> closed{false};
+    uint32_t lastPushed = 0; // producer only
+};
@@ -1,14 +1,18 @@
 #include "Lobby.hpp"
 #include "map/MapGenerator.hpp"
 
-Lobby::Lobby() {
+Lobby::Lobby(uint64_t id) : lobbyId(id) {
 }
 
 Lobby::Lobby(Lobby &&other) noexcept
     : registry(std::move(other.registry)),
       players(std::move(other.players)),
       playerSpawnPoints(std::move(other.playerSpawnPoints)),
-      entId(other.entId) {
+      lobbyId(other.lobbyId),
+      entId(other.entId),
+      collisionGrid(std::move(other.collisionGrid)),
+      snapshots(std::move(other.snapshots)),
+      currentTick(other.currentTick) {
 }
 
 Lobby &Lobby::operator=(Lobby &&other) noexcept {
@@ -17,7 +21,11 @@ Lobby &Lobby::operator=(Lobby &&other) noexcept {
         registry = std::move(other.registry);
         players = std::move(other.players);
         playerSpawnPoints = std::move(other.playerSpawnPoints);
+        lobbyId = other.lobbyId;
         entId = other.entId;
+        collisionGrid = std::move(other.collisionGrid);
+        snapshots = std::move(other.snapshots);
+        currentTick = other.currentTick;
     }
     return *this;
 }
@@ -30,28 +38,58 @@ uint64_t Lobby::nextId() {
     return entId++;
 }
 
-bool Lobby::isPositionInsideFireball(const glm::vec3& spawnPosition) {
-    auto fireballView = registry.view<FireballComponent, TransformComponent>();
+void Lobby::applyInput(entt::entity entity, TransformComponent &transform, PawnComponent &pawn, const PlayerInput &input, float step) {
+    pawn.moveForward = input.moveForward;
+    pawn.moveBackwards = input.moveBackwards;
+    pawn.moveLeft = input.moveLeft;
+    pawn.moveRight = input.moveRight;
+    pawn.aimRotation = input.aimRotation;
+    pawn.isShooting = input.isShooting;
+
+    float currentTime = Time::now().toSeconds();
+    if (pawn.isShooting && canPlayerShoot(pawn.playerId, currentTime)) {
+        updatePlayerLastShotTime(pawn.playerId, currentTime);
+
+        glm::vec3 fireballDirection = FireballComponent::directionFor(input.aimRotation);
+        glm::vec3 spawnOffset = glm::vec3(fireballDirection.x, fireballDirection.y, 3.0f) * 400.0f;
+        glm::vec3 spawnPosition = transform.position;
+        spawnPosition.x += spawnOffset.x;
+        spawnPosition.y += spawnOffset.y;
+
+        if (!isPositionInsideFireball(spawnPosition)) {
+            auto fireballEntity = registry.create();
+            AT_INFO("Creating fireball for player {}", pawn.playerId);
+
+            registry.emplace<NetworkComponent>(fireballEntity, nextId(), TILE_CODE+110, transform.position, true);
+            registry.emplace<FireballComponent>(fireballEntity, spawnPosition, fireballDirection, 800.0f, pawn.playerId);
+            registry.emplace<TransformComponent>(fireballEntity, spawnPosition, input.aimRotation, glm::vec2(100.0f,100.0f));
+            collisionGrid.insertBody(fireballEntity, spawnPosition);
+        } else {
+            AT_INFO("Fireball spawn blocked: Position inside another fireball");
+        }
+    }
 
-    for (auto otherEntity : fireballView) {
-        const auto &otherTransform = fireballView.get<TransformComponent>(otherEntity);
+    PawnMovement::move(transform.position, input, step, [&](const glm::vec3 &position) {
+        return collidesWithWall(position, transform.scale);
+    });
+}
 
-        float spawnLeft = spawnPosition.x - 50.0f;
-        float spawnRight = spawnPosition.x + 50.0f;
-        float spawnTop = spawnPosition.y + 50.0f;
-        float spawnBottom = spawnPosition.y - 50.0f;
+bool Lobby::isPositionInsideFireball(const glm::vec3& spawnPosition) {
+    return collisionGrid.anyBody(spawnPosition, [&](entt::entity otherEntity) {
+        if (!registry.all_of<FireballComponent>(otherEntity)) {
+            return false;
+        }
 
-        float otherLeft = otherTransform.position.x - 50.0f;
-        float otherRight = otherTransform.position.x + 50.0f;
-        float otherTop = otherTransform.position.y + 50.0f;
-        float otherBottom = otherTransform.position.y - 50.0f;
+        const auto &otherTransform = registry.get<TransformComponent>(otherEntity);
+        return PawnMovement::intersects(spawnPosition, glm::vec2(50.0f), otherTransform.position, glm::vec2(50.0f));
+    });
+}
 
-        if (spawnRight > otherLeft && spawnLeft < otherRight &&
-            spawnTop > otherBottom && spawnBottom < otherTop) {
-            return true;  // Collision detected
-        }
-    }
-    return false;  // No collision
+bool Lobby::collidesWithWall(const glm::vec3 &position, const glm::vec2 &scale) {
+    return collisionGrid.anyWall(position, [&](entt::entity wall) {
+        const auto &wallTransform = registry.get<TransformComponent>(wall);
+        return PawnMovement::hitsWall(position, scale, wallTransform.position, wallTransform.scale);
+    });
 }
 
 void Lobby::start() {
@@ -59,6 +97,9 @@ void Lobby::start() {
     DIRTY_COMPONENT(PawnComponent);
     DIRTY_COMPONENT(FireballComponent);
 
+    registry.on_construct<RigidbodyComponent>().connect<&Lobby::updateCollisionGrid>(*this);
+    registry.on_update<RigidbodyComponent>().connect<&Lobby::updateCollisionGrid>(*this);
+
     constexpr glm::vec2 tileSize = {100.0f, 100.0f};
 
     auto map = MapGenerator(50, 50).getMap();
@@ -66,6 +107,9 @@ void Lobby::start() {
     int width = map[0].size();
     int height = map.size();
 
+    // walls register themselves through the RigidbodyComponent signals above
+    collisionGrid = CollisionGrid(width, height, tileSize);
+
     float offsetX = -(width * tileSize.x) / 2.0f + tileSize.x / 2.0f;
     float offsetY = -(height * tileSize.y) / 2.0f + tileSize.y / 2.0f;
 
@@ -93,12 +137,9 @@ void Lobby::start() {
     this->started = true;
 }
 
-void Lobby::setPlayerInput(uint64_t playerId, const PlayerInput &input) {
-    std::lock_guard<std::mutex> lock(inputMutex);
-    inputQueue[playerId] = input;
-}
-
 void Lobby::update(float deltaTime) {
+    AT_PROFILE_SCOPE("lobby.update");
+
     auto view = registry.view<TransformComponent, NetworkComponent>();
 
     for (const auto entity : view) {
@@ -116,28 +157,35 @@ void Lobby::update(float deltaTime) {
         }
     }
 
-    std::unordered_map<uint64_t, PlayerInput> latestInputs;
+    // Moving bodies are re-bucketed every tick, walls stay in the grid until they are destroyed
     {
-        std::lock_guard<std::mutex> lock(inputMutex);
-        latestInputs = std::move(inputQueue);
-        inputQueue.clear();
+        AT_PROFILE_SCOPE("lobby.grid");
+        collisionGrid.clearBodies();
+        for (const auto entity : registry.view<PawnComponent, TransformComponent>()) {
+            collisionGrid.insertBody(entity, registry.get<TransformComponent>(entity).position);
+        }
+        for (const auto entity : registry.view<FireballComponent, TransformComponent>()) {
+            collisionGrid.insertBody(entity, registry.get<TransformComponent>(entity).position);
+        }
     }
 
     // Collect entities to destroy outside the main loop
     std::vector<entt::entity> entitiesToDestroy;
 
+    // the phases interleave per entity, each is summed over the loop and recorded once
+    AT_PROFILE_PHASE(movementPhase, "lobby.movement");
+    AT_PROFILE_PHASE(fireballPhase, "lobby.fireball");
+    AT_PROFILE_PHASE(collisionPhase, "lobby.collision");
+
     for (const auto entity : view) {
         auto &transform = view.get<TransformComponent>(entity);
         const auto &network = view.get<NetworkComponent>(entity);
 
         if (auto pawn = registry.try_get<PawnComponent>(entity)) {
-            uint64_t playerId = pawn->playerId;
-            if (playerLives[playerId] < 1) {
-                // Log the player status for debugging
+            AT_PROFILE_PHASE_SCOPE(movementPhase);
 
-                continue; // Skip input processing and movement for this player
-            }
-            glm::vec3 originalPos = transform.position;
+            const bool alive = playerLives[pawn->playerId] >= 1;
+            const glm::vec3 originalPos = transform.position;
 
             pawn->moveForward = false;
             pawn->moveBackwards = false;
@@ -146,107 +194,37 @@ void Lobby::update(float deltaTime) {
             pawn->aimRotation = 0.0f;
             pawn->isShooting = false;
 
-            auto it = latestInputs.find(pawn->playerId);
-            if (it != latestInputs.end()) {
-                const auto &input = it->second;
-
-                pawn->moveForward = input.moveForward;
-                pawn->moveBackwards = input.moveBackwards;
-                pawn->moveLeft = input.moveLeft;
-                pawn->moveRight = input.moveRight;
-                pawn->aimRotation = input.aimRotation;
-                pawn->isShooting = input.isShooting;
-
-                float currentTime = Time::now().toSeconds();
-                if (pawn->isShooting && canPlayerShoot(pawn->playerId, currentTime)) {
-                    updatePlayerLastShotTime(pawn->playerId, currentTime);
-
-                    glm::vec3 fireballDirection = glm::vec3(glm::cos(input.aimRotation), -glm::sin(input.aimRotation), 3.0f);
-                    fireballDirection = normalize(fireballDirection);
-                    glm::vec3 spawnOffset = glm::vec3(fireballDirection.x, fireballDirection.y, 3.0f) * 400.0f;
-                    glm::vec3 spawnPosition = transform.position;
-                    spawnPosition.x += spawnOffset.x;
-                    spawnPosition.y += spawnOffset.y;
-
-                    if (!isPositionInsideFireball(spawnPosition)) {
-                        auto fireballEntity = registry.create();
-                        AT_INFO("Creating fireball for player {}", pawn->playerId);
-
-                        registry.emplace<NetworkComponent>(fireballEntity, nextId(), TILE_CODE+110, transform.position, true);
-                        registry.emplace<FireballComponent>(fireballEntity, spawnPosition, fireballDirection, 800.0f, pawn->playerId);
-                        registry.emplace<TransformComponent>(fireballEntity, spawnPosition, input.aimRotation, glm::vec2(100.0f,100.0f));
-                    } else {
-                        AT_INFO("Fireball spawn blocked: Position inside another fireball");
-                    }
-                }
-
-                if (input.moveLeft) transform.position.x -= this->baseSpeed * deltaTime;
-                if (input.moveRight) transform.position.x += this->baseSpeed * deltaTime;
-
-                bool xCollision = false;
-                auto view2 = registry.view<RigidbodyComponent, TransformComponent>();
-
-                for (auto wall : view2) {
-                    const auto& wallTransform = view2.get<TransformComponent>(wall);
-                    const auto& rigidbody = view2.get<RigidbodyComponent>(wall);
-
-                    if (!rigidbody.isSolid || entity == wall) {
-                        continue;
+            // every input since the last tick in order, so a short tap of shoot is not lost between two ticks
+            const size_t seat = getSeat(pawn->playerId);
+            size_t processed = 0;
+            if (seat < players.size()) {
+                float &budget = inputTime[seat];
+                budget = std::min(budget + deltaTime, MAX_INPUT_BURST);
+                const auto apply = [&](const PlayerInput &input) {
+                    pawn->lastInputSequence = input.sequence;
+                    if (!alive) {
+                        return; // Skip input processing and movement for this player
                     }
 
-                    float playerLeft = transform.position.x - (transform.scale.x * 0.4f);
-                    float playerRight = transform.position.x + (transform.scale.x * 0.4f);
-                    float wallLeft = wallTransform.position.x - (wallTransform.scale.x * 0.5f);
-                    float wallRight = wallTransform.position.x + (wallTransform.scale.x * 0.5f);
-                    float playerTop = transform.position.y + (transform.scale.y * 0.4f);
-                    float playerBottom = transform.position.y - (transform.scale.y * 0.4f);
-                    float wallTop = wallTransform.position.y + (wallTransform.scale.y * 0.5f);
-                    float wallBottom = wallTransform.position.y - (wallTransform.scale.y * 0.5f);
-
-                    if (playerRight > wallLeft && playerLeft < wallRight &&
-                        playerTop > wallBottom && playerBottom < wallTop) {
-                        xCollision = true;
-                        break;
-                    }
-                }
+                    const float step = std::min(std::max(input.deltaTime, 0.0f), budget);
+                    budget -= step;
+                    applyInput(entity, transform, *pawn, input, step);
+                };
 
-                if (xCollision) {
-                    transform.position.x = originalPos.x;
+                // what a replaced connection sent before it was closed comes first
+                for (auto &[closedSeat, ring] : closedInputRings) {
+                    if (closedSeat == seat) processed += ring->drain(apply);
                 }
-
-                if (input.moveForward) transform.position.y += this->baseSpeed * deltaTime;
-                if (input.moveBackwards) transform.position.y -= this->baseSpeed * deltaTime;
-
-                bool yCollision = false;
-                for (auto wall : view2) {
-                    const auto& wallTransform = view2.get<TransformComponent>(wall);
-                    const auto& rigidbody = view2.get<RigidbodyComponent>(wall);
-
-                    if (!rigidbody.isSolid || entity == wall) {
-                        continue;
-                    }
-
-                    float playerLeft = transform.position.x - (transform.scale.x * 0.4f);
-                    float playerRight = transform.position.x + (transform.scale.x * 0.4f);
-                    float wallLeft = wallTransform.position.x - (wallTransform.scale.x * 0.5f);
-                    float wallRight = wallTransform.position.x + (wallTransform.scale.x * 0.5f);
-                    float playerTop = transform.position.y + (transform.scale.y * 0.4f);
-                    float playerBottom = transform.position.y - (transform.scale.y * 0.4f);
-                    float wallTop = wallTransform.position.y + (wallTransform.scale.y * 0.5f);
-                    float wallBottom = wallTransform.position.y - (wallTransform.scale.y * 0.5f);
-
-                    if (playerRight > wallLeft && playerLeft < wallRight &&
-                        playerTop > wallBottom && playerBottom < wallTop) {
-                        yCollision = true;
-                        break;
-                    }
+                if (inputRings[seat]) {
+                    processed += inputRings[seat]->drain(apply);
                 }
+            }
 
-                if (yCollision) {
-                    transform.position.y = originalPos.y;
+            if (processed > 0) {
+                if (alive) {
+                    collisionGrid.moveBody(entity, originalPos, transform.position);
+                    transform.rotation = 0.0f;
                 }
-
-                transform.rotation = 0.0f;
                 network.dirtyFlag = true;
             }
         }
@@ -258,161 +236,148 @@ void Lobby::update(float deltaTime) {
             }
 
             glm::vec3 newPosition = fireball->position;
-            newPosition.x += fireball->direction.x * fireball->speed * deltaTime;
-            newPosition.y += fireball->direction.y * fireball->speed * deltaTime;
-            newPosition.z = 3.0f;
-
-            fireball->position = newPosition;
-            transform.position = newPosition;
-            auto &network = view.get<NetworkComponent>(entity);
-            network.dirtyFlag = true;
+            {
+                AT_PROFILE_PHASE_SCOPE(fireballPhase);
+                newPosition.x += fireball->direction.x * fireball->speed * deltaTime;
+                newPosition.y += fireball->direction.y * fireball->speed * deltaTime;
+                newPosition.z = 3.0f;
+
+                collisionGrid.moveBody(entity, transform.position, newPosition);
+                fireball->position = newPosition;
+                transform.position = newPosition;
+                network.dirtyFlag = true;
+            }
 
+            AT_PROFILE_PHASE_SCOPE(collisionPhase);
             bool collisionDetected = false;
 
             // Check collision with walls
-            auto wallView = registry.view<RigidbodyComponent, TransformComponent, NetworkComponent>();
-            for (auto wall : wallView) {
-                const auto &wallTransform = wallView.get<TransformComponent>(wall);
-                const auto &rigidbody = wallView.get<RigidbodyComponent>(wall);
-                const auto &wallNetwork = wallView.get<NetworkComponent>(wall);
-
-                if (!rigidbody.isSolid || entity == wall) continue;
-
-                float fireballLeft = newPosition.x - 50.0f;
-                float fireballRight = newPosition.x + 50.0f;
-                float fireballTop = newPosition.y + 50.0f;
-                float fireballBottom = newPosition.y - 50.0f;
-
-                float wallLeft = wallTransform.position.x - (wallTransform.scale.x * 0.5f);
-                float wallRight = wallTransform.position.x + (wallTransform.scale.x * 0.5f);
-                float wallTop = wallTransform.position.y + (wallTransform.scale.y * 0.5f);
-                float wallBottom = wallTransform.position.y - (wallTransform.scale.y * 0.5f);
-
-                if (fireballRight > wallLeft && fireballLeft < wallRight &&
-                    fireballTop > wallBottom && fireballBottom < wallTop) {
-                    if (wallNetwork.tileCode == TILE_CODE + 63) {
-                        // Replace destructible wall with a path tile
-                        registry.emplace_or_replace<NetworkComponent>(wall, wallNetwork.networkId, TILE_CODE + 48, wallTransform.position, true);
-                        registry.emplace_or_replace<TransformComponent>(wall, wallTransform.position, wallTransform.rotation, wallTransform.scale);
-                        registry.emplace_or_replace<RigidbodyComponent>(wall, RigidbodyComponent{false});
-                        AT_INFO("Destructible wall replaced with path tile.");
-                    } else if (wallNetwork.tileCode == TILE_CODE + 64) {
-                        // Bomb explosion logic
-                        float explosionRadius = 500.0f;
-                        auto blastView = registry.view<TransformComponent, NetworkComponent, RigidbodyComponent>();
-                        for (auto target : blastView) {
-                            const auto &targetTransform = blastView.get<TransformComponent>(target);
-                            auto &targetNetwork = blastView.get<NetworkComponent>(target);
-
-                            float distance = glm::distance(targetTransform.position, wallTransform.position);
-                            if (distance <= explosionRadius) {
-                                if (targetNetwork.tileCode == TILE_CODE + 63 || // Destructible wall
-                                    targetNetwork.tileCode == TILE_CODE + 64 || // Bomb
-                                    targetNetwork.tileCode == TILE_CODE + 40) { // Other wall types
-                                    registry.emplace_or_replace<NetworkComponent>(target, targetNetwork.networkId, TILE_CODE + 48, targetTransform.position, true);
-                                    registry.emplace_or_replace<TransformComponent>(target, targetTransform.position, targetTransform.rotation, targetTransform.scale);
-                                    registry.emplace_or_replace<RigidbodyComponent>(target, RigidbodyComponent{false});
-                                    AT_INFO("Object within blast radius replaced with path.");
-                                } else if (auto playerPawn = registry.try_get<PawnComponent>(target)) {
-                                    // Respawn player to original position
-                                    auto spawnPointIt = playerSpawnPoints.find(playerPawn->playerId);
-                                    if (spawnPointIt != playerSpawnPoints.end()) {
-                                        auto &playerTransform = registry.get<TransformComponent>(target);
-                                        playerTransform.position = spawnPointIt->second.position;
-                                        if (auto *playerNetwork = registry.try_get<NetworkComponent>(target)) {
-                                            playerNetwork->dirtyFlag = true;
-                                        }
-                                        AT_INFO("Player {} hit by bomb! Respawning at original position.", playerPawn->playerId);
+            entt::entity hitWall = entt::null;
+            collisionGrid.anyWall(newPosition, [&](entt::entity wall) {
+                const auto &wallTransform = registry.get<TransformComponent>(wall);
+                if (PawnMovement::intersects(newPosition, glm::vec2(50.0f), wallTransform.position, wallTransform.scale * PawnMovement::WALL_EXTENT)) {
+                    hitWall = wall;
+                    return true;
+                }
+                return false;
+            });
+
+            if (hitWall != entt::null) {
+                const auto wall = hitWall;
+                const auto &wallTransform = registry.get<TransformComponent>(wall);
+                const auto &wallNetwork = registry.get<NetworkComponent>(wall);
+
+                if (wallNetwork.tileCode == TILE_CODE + 63) {
+                    // Replace destructible wall with a path tile
+                    registry.emplace_or_replace<NetworkComponent>(wall, wallNetwork.networkId, TILE_CODE + 48, wallTransform.position, true);
+                    registry.emplace_or_replace<TransformComponent>(wall, wallTransform.position, wallTransform.rotation, wallTransform.scale);
+                    registry.emplace_or_replace<RigidbodyComponent>(wall, RigidbodyComponent{false});
+                    AT_INFO("Destructible wall replaced with path tile.");
+                } else if (wallNetwork.tileCode == TILE_CODE + 64) {
+                    // Bomb explosion logic
+                    float explosionRadius = 500.0f;
+                    auto blastView = registry.view<TransformComponent, NetworkComponent, RigidbodyComponent>();
+                    for (auto target : blastView) {
+                        const auto &targetTransform = blastView.get<TransformComponent>(target);
+                        auto &targetNetwork = blastView.get<NetworkComponent>(target);
+
+                        float distance = glm::distance(targetTransform.position, wallTransform.position);
+                        if (distance <= explosionRadius) {
+                            if (targetNetwork.tileCode == TILE_CODE + 63 || // Destructible wall
+                                targetNetwork.tileCode == TILE_CODE + 64 || // Bomb
+                                targetNetwork.tileCode == TILE_CODE + 40) { // Other wall types
+                                registry.emplace_or_replace<NetworkComponent>(target, targetNetwork.networkId, TILE_CODE + 48, targetTransform.position, true);
+                                registry.emplace_or_replace<TransformComponent>(target, targetTransform.position, targetTransform.rotation, targetTransform.scale);
+                                registry.emplace_or_replace<RigidbodyComponent>(target, RigidbodyComponent{false});
+                                AT_INFO("Object within blast radius replaced with path.");
+                            } else if (auto playerPawn = registry.try_get<PawnComponent>(target)) {
+                                // Respawn player to original position
+                                auto spawnPointIt = playerSpawnPoints.find(playerPawn->playerId);
+                                if (spawnPointIt != playerSpawnPoints.end()) {
+                                    auto &playerTransform = registry.get<TransformComponent>(target);
+                                    collisionGrid.moveBody(target, playerTransform.position, spawnPointIt->second.position);
+                                    playerTransform.position = spawnPointIt->second.position;
+                                    if (auto *playerNetwork = registry.try_get<NetworkComponent>(target)) {
+                                        playerNetwork->dirtyFlag = true;
                                     }
+                                    AT_INFO("Player {} hit by bomb! Respawning at original position.", playerPawn->playerId);
                                 }
                             }
                         }
-
-                        // Replace the bomb itself with a path tile
-                        registry.emplace_or_replace<NetworkComponent>(wall, wallNetwork.networkId, TILE_CODE + 48, wallTransform.position, true);
-                        registry.emplace_or_replace<TransformComponent>(wall, wallTransform.position, wallTransform.rotation, wallTransform.scale);
-                        registry.emplace_or_replace<RigidbodyComponent>(wall, RigidbodyComponent{false});
-                        AT_INFO("Bomb exploded and replaced with path.");
                     }
 
-                    collisionDetected = true;
-                    entitiesToDestroy.push_back(entity);
-                    break;
+                    // Replace the bomb itself with a path tile
+                    registry.emplace_or_replace<NetworkComponent>(wall, wallNetwork.networkId, TILE_CODE + 48, wallTransform.position, true);
+                    registry.emplace_or_replace<TransformComponent>(wall, wallTransform.position, wallTransform.rotation, wallTransform.scale);
+                    registry.emplace_or_replace<RigidbodyComponent>(wall, RigidbodyComponent{false});
+                    AT_INFO("Bomb exploded and replaced with path.");
                 }
+
+                collisionDetected = true;
+                entitiesToDestroy.push_back(entity);
             }
 
             // Check collision with other fireballs
             if (!collisionDetected) {
-                auto fireballView = registry.view<FireballComponent, TransformComponent>();
-                for (auto otherEntity : fireballView) {
-                    if (entity == otherEntity ||
+                collisionGrid.anyBody(newPosition, [&](entt::entity otherEntity) {
+                    if (entity == otherEntity || !registry.all_of<FireballComponent>(otherEntity) ||
                         std::ranges::find(entitiesToDestroy, otherEntity) != entitiesToDestroy.end()) {
-                        continue;
+                        return false;
                     }
 
-                    const auto &otherTransform = fireballView.get<TransformComponent>(otherEntity);
+                    const auto &otherTransform = registry.get<TransformComponent>(otherEntity);
 
-                    float fireballLeft = newPosition.x - 50.0f;
-                    float fireballRight = newPosition.x + 50.0f;
-                    float fireballTop = newPosition.y + 50.0f;
-                    float fireballBottom = newPosition.y - 50.0f;
-
-                    float otherLeft = otherTransform.position.x - 50.0f;
-                    float otherRight = otherTransform.position.x + 50.0f;
-                    float otherTop = otherTransform.position.y + 50.0f;
-                    float otherBottom = otherTransform.position.y - 50.0f;
-
-                    if (fireballRight > otherLeft && fireballLeft < otherRight &&
-                        fireballTop > otherBottom && fireballBottom < otherTop) {
+                    if (PawnMovement::intersects(newPosition, glm::vec2(50.0f), otherTransform.position, glm::vec2(50.0f))) {
                         collisionDetected = true;
                         entitiesToDestroy.push_back(entity);
                         entitiesToDestroy.push_back(otherEntity);
-                        break;
+                        return true;
                     }
-                }
+                    return false;
+                });
             }
 
             // Check collision with players
             if (!collisionDetected) {
-                auto playerView = registry.view<PawnComponent, TransformComponent>();
-                for (auto playerEntity : playerView) {
-                    auto &playerTransform = registry.get<TransformComponent>(playerEntity);
-                    auto &pawn = registry.get<PawnComponent>(playerEntity);
-
-                    float fireballLeft = newPosition.x - 50.0f;
-                    float fireballRight = newPosition.x + 50.0f;
-                    float fireballTop = newPosition.y + 50.0f;
-                    float fireballBottom = newPosition.y - 50.0f;
-
-                    float playerLeft = playerTransform.position.x - (playerTransform.scale.x * 0.4f);
-                    float playerRight = playerTransform.position.x + (playerTransform.scale.x * 0.4f);
-                    float playerTop = playerTransform.position.y + (playerTransform.scale.y * 0.4f);
-                    float playerBottom = playerTransform.position.y - (playerTransform.scale.y * 0.4f);
-
-                    if (fireballRight > playerLeft && fireballLeft < playerRight &&
-                        fireballTop > playerBottom && fireballBottom < playerTop) {
-                        // Find the spawn point for this player
-                        auto spawnPointIt = playerSpawnPoints.find(pawn.playerId);
-                        if (spawnPointIt != playerSpawnPoints.end()) {
-                            // Set player position back to spawn point
-                            playerTransform.position = spawnPointIt->second.position;
-                            if (auto* network = registry.try_get<NetworkComponent>(playerEntity)) {
-                                network->dirtyFlag = true;
-                            }
+                entt::entity hitPlayer = entt::null;
+                collisionGrid.anyBody(newPosition, [&](entt::entity playerEntity) {
+                    if (!registry.all_of<PawnComponent>(playerEntity)) {
+                        return false;
+                    }
 
-                            if (playerLives.find(pawn.playerId) != playerLives.end()) {
-                                if ( playerLives[pawn.playerId]>0)
-                                playerLives[pawn.playerId]--;
+                    const auto &playerTransform = registry.get<TransformComponent>(playerEntity);
+                    if (PawnMovement::intersects(newPosition, glm::vec2(50.0f), playerTransform.position, playerTransform.scale * PawnMovement::BODY_EXTENT)) {
+                        hitPlayer = playerEntity;
+                        return true;
+                    }
+                    return false;
+                });
+
+                if (hitPlayer != entt::null) {
+                    auto &playerTransform = registry.get<TransformComponent>(hitPlayer);
+                    auto &pawn = registry.get<PawnComponent>(hitPlayer);
+
+                    // Find the spawn point for this player
+                    auto spawnPointIt = playerSpawnPoints.find(pawn.playerId);
+                    if (spawnPointIt != playerSpawnPoints.end()) {
+                        // Set player position back to spawn point
+                        collisionGrid.moveBody(hitPlayer, playerTransform.position, spawnPointIt->second.position);
+                        playerTransform.position = spawnPointIt->second.position;
+                        if (auto* network = registry.try_get<NetworkComponent>(hitPlayer)) {
+                            network->dirtyFlag = true;
+                        }
 
+                        if (playerLives.find(pawn.playerId) != playerLives.end()) {
+                            if ( playerLives[pawn.playerId]>0)
+                            playerLives[pawn.playerId]--;
 
-                            }
-                            AT_INFO("Player {} hit by fireball! Respawning at original position.", pawn.playerId, playerLives[pawn.playerId]);
-                        }
 
-                        collisionDetected = true;
-                        entitiesToDestroy.push_back(entity); // Destroy the fireball
-                        break;
+                        }
+                        AT_INFO("Player {} hit by fireball! Respawning at original position.", pawn.playerId, playerLives[pawn.playerId]);
                     }
+
+                    collisionDetected = true;
+                    entitiesToDestroy.push_back(entity); // Destroy the fireball
                 }
             }
 
@@ -423,81 +388,123 @@ void Lobby::update(float deltaTime) {
         }
     }
 
+    closedInputRings.clear();
+
     // Remove duplicate entities from destruction list
     auto last = std::ranges::unique(entitiesToDestroy).begin();
     entitiesToDestroy.erase(last, entitiesToDestroy.end());
 
-    // Destroy entities after updating
-    for (const auto destroyEntity : entitiesToDestroy) {
-        if (registry.valid(destroyEntity)) {
-            markDeleted(registry, destroyEntity);
-            registry.destroy(destroyEntity);
+    // Destroy entities after updating, clients learn about it from the snapshot diff
+    {
+        AT_PROFILE_SCOPE("lobby.destroy");
+        for (const auto destroyEntity : entitiesToDestroy) {
+            if (registry.valid(destroyEntity)) {
+                registry.destroy(destroyEntity);
+            }
         }
     }
 
-    nlohmann::json gameState;
-    gameState["entities"] = nlohmann::json::array();
-
-    gameState["deletedEntities"] = this->deletedEntities;
-    this->deletedEntities.clear();
-
     try {
-        for (auto entity : view) {
-            const auto &network = view.get<NetworkComponent>(entity);
-
-            if (!network.dirtyFlag && this->synced) {
-                continue;
+        AT_PROFILE_SCOPE("lobby.broadcast");
+        auto &snapshot = snapshots.record(++currentTick);
+        captureSnapshot(snapshot);
+
+        // broadcast the game state to all connected clients, as a delta against what each one acknowledged
+        std::lock_guard<std::mutex> lock(playersMutex);
+        encodedFrames.clear();
+        for (const auto &[playerId, conn] : playerConnections) {
+            if (conn) {
+                const auto &frame = encodeFrame(snapshot, snapshots.find(acknowledgedTicks[playerId]));
+                conn->send_binary(*frame.data);
+                networkStats.bytesSent += frame.data->size();
             }
+        }
+        ++networkStats.ticks;
+    } catch (const std::exception &e) {
+        AT_ERROR("Error serializing or sending game state: {}", e.what());
+    }
 
-            network.dirtyFlag = false;
-
-            const auto &transform = registry.get<TransformComponent>(entity);
-
-            nlohmann::json entityJson;
-            entityJson["id"] = static_cast<int>(entity);
-            entityJson["networkId"] = network.networkId;
-            entityJson["tile-code"] = static_cast<int>(network.tileCode);
-
-            entityJson["TransformComponent"] = {
-                {"position", {transform.position.x, transform.position.y, transform.position.z}},
-                {"rotation", transform.rotation},
-                {"scale", {transform.scale.x, transform.scale.y}}
-            };
-
-            if (auto pawn = registry.try_get<PawnComponent>(entity)) {
-                entityJson["PawnComponent"] = {
-                    {"playerId", pawn->playerId},
-                    {"moveForward", pawn->moveForward},
-                    {"moveBackwards", pawn->moveBackwards},
-                    {"moveLeft", pawn->moveLeft},
-                    {"moveRight", pawn->moveRight},
-                    {"aimRotation", pawn->aimRotation},
-                    {"isShooting", pawn->isShooting}
-                };
-            }
+    if (currentTick % 300 == 0) {
+        std::lock_guard<std::mutex> lock(playersMutex);
+        AT_TRACE("Lobby {}: {} frames encoded, {} shared, {} bytes and {:.3f}ms of encoding saved",
+                 lobbyId, networkStats.framesEncoded, networkStats.framesShared,
+                 networkStats.bytesSaved, networkStats.encodeMsSaved);
+    }
+}
 
-            if (auto rigidbody = registry.try_get<RigidbodyComponent>(entity)) {
-                entityJson["RigidbodyComponent"] = {
-                    {"isSolid", rigidbody->isSolid}
-                };
-            }
+const Lobby::EncodedFrame &Lobby::encodeFrame(const Snapshot &snapshot, const Snapshot *baseline) {
+    const uint32_t baseTick = baseline ? baseline->tick : 0;
 
-            gameState["entities"].push_back(entityJson);
+    // clients that acknowledged the same tick get the very same frame
+    for (const auto &frame : encodedFrames) {
+        if (frame.baseTick == baseTick) {
+            ++networkStats.framesShared;
+            networkStats.bytesSaved += frame.data->size();
+            networkStats.encodeMsSaved += frame.encodeMs;
+            return frame;
         }
+    }
 
-        this->synced = true;
+    const auto encodeStart = std::chrono::steady_clock::now();
 
-        // broadcast the game state to all connected clients
-        {
-            std::lock_guard<std::mutex> lock(playersMutex);
-            for (const auto &conn : playerConnections | std::views::values) {
-                if (conn) {
-                    conn->send_text(gameState.dump());
-                }
-            }
+    std::string buffer;
+    SnapshotCodec::encode(snapshot, baseline, buffer);
+
+    const double encodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - encodeStart).count();
+    ++networkStats.framesEncoded;
+    networkStats.encodeMs += encodeMs;
+
+    return encodedFrames.emplace_back(baseTick, CreateRef<const std::string>(std::move(buffer)), encodeMs);
+}
+
+LobbyNetworkStats Lobby::getNetworkStats() {
+    std::lock_guard<std::mutex> lock(playersMutex);
+    return networkStats;
+}
+
+void Lobby::captureSnapshot(Snapshot &snapshot) {
+    auto view = registry.view<TransformComponent, NetworkComponent>();
+
+    for (auto entity : view) {
+        const auto &transform = view.get<TransformComponent>(entity);
+        const auto &network = view.get<NetworkComponent>(entity);
+
+        auto &state = snapshot.entities.emplace_back();
+        state.networkId = network.networkId;
+        state.tileCode = network.tileCode;
+        state.setPosition(transform.position);
+        state.rotation = EntitySnapshot::quantizeAngle(transform.rotation);
+        state.setScale(transform.scale);
+
+        if (auto pawn = registry.try_get<PawnComponent>(entity)) {
+            state.hasPawn = true;
+            state.playerId = pawn->playerId;
+            state.aimRotation = EntitySnapshot::quantizeAngle(pawn->aimRotation);
+            state.lastInputSequence = pawn->lastInputSequence;
+            if (pawn->moveForward) state.pawnFlags |= EntitySnapshot::MOVE_FORWARD;
+            if (pawn->moveBackwards) state.pawnFlags |= EntitySnapshot::MOVE_BACKWARDS;
+            if (pawn->moveLeft) state.pawnFlags |= EntitySnapshot::MOVE_LEFT;
+            if (pawn->moveRight) state.pawnFlags |= EntitySnapshot::MOVE_RIGHT;
+            if (pawn->isShooting) state.pawnFlags |= EntitySnapshot::SHOOTING;
         }
-    } catch (const std::exception &e) {
-        AT_ERROR("Error serializing or sending game state: ", e.what());
+
+        if (auto rigidbody = registry.try_get<RigidbodyComponent>(entity)) {
+            state.hasRigidbody = true;
+            state.isSolid = rigidbody->isSolid;
+        }
+    }
+
+    snapshot.sort();
+}
+
+void Lobby::acknowledgeSnapshot(uint64_t playerId, const crow::websocket::connection *conn, uint32_t tick) {
+    std::lock_guard<std::mutex> lock(playersMutex);
+    // a replaced connection acknowledges frames the current one never got
+    if (auto current = playerConnections.find(playerId); current == playerConnections.end() || current->second != conn) {
+        return;
+    }
+    if (auto it = acknowledgedTicks.find(playerId); it != acknowledgedTicks.end() && tick > it->second) {
+        it->second = tick;
     }
 }
 
@@ -507,8 +514,12 @@ void Lobby::markDirty(entt::registry &registry, entt::entity entity) {
     }
 }
 
-void Lobby::markDeleted(entt::registry &registry, entt::entity entity) {
-    if (auto network = registry.try_get<NetworkComponent>(entity)) {
-        this->deletedEntities.push_back(network->networkId);
+void Lobby::updateCollisionGrid(entt::registry &registry, entt::entity entity) {
+    const auto &transform = registry.get<TransformComponent>(entity);
+
+    if (registry.get<RigidbodyComponent>(entity).isSolid) {
+        collisionGrid.setWall(transform.position, entity);
+    } else {
+        collisionGrid.clearWall(transform.position, entity);
     }
-}
\ No newline at end of file
+}
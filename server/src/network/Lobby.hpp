@@ -3,13 +3,19 @@
 #include <Atlas.hpp>
 #include <crow/websocket.h>
 
-struct PlayerInput {
-    bool moveForward = false;
-    bool moveBackwards = false;
-    bool moveLeft = false;
-    bool moveRight = false;
-    float aimRotation = 0.0f;
-    bool isShooting = false;
+#include "InputRing.hpp"
+#include "core/TickHistogram.hpp"
+#include "map/CollisionGrid.hpp"
+
+// Counters of the snapshot broadcast, the "saved" values come from frames shared between connections.
+struct LobbyNetworkStats {
+    uint64_t ticks = 0;
+    uint64_t framesEncoded = 0;
+    uint64_t framesShared = 0;
+    uint64_t bytesSent = 0;
+    uint64_t bytesSaved = 0;
+    double encodeMs = 0.0;
+    double encodeMsSaved = 0.0;
 };
 
 struct PlayerSpawnPoint {
@@ -19,7 +25,9 @@ struct PlayerSpawnPoint {
 
 class Lobby {
 public:
-    Lobby();
+    static constexpr size_t MAX_PLAYERS = 4;
+
+    explicit Lobby(uint64_t id = 0);
     Lobby(const Lobby &) = delete;
     Lobby &operator=(const Lobby &) = delete;
     Lobby(Lobby &&other) noexcept;
@@ -31,14 +39,30 @@ public:
     void update(float deltaTime);
 
     void markDirty(entt::registry &registry, entt::entity entity);
-    void markDeleted(entt::registry &registry, entt::entity entity);
-    void setPlayerInput(uint64_t playerId, const PlayerInput &input);
+    void updateCollisionGrid(entt::registry &registry, entt::entity entity);
+    // Acks of any connection but the player's current one are dropped.
+    void acknowledgeSnapshot(uint64_t playerId, const crow::websocket::connection *conn, uint32_t tick);
+    LobbyNetworkStats getNetworkStats();
+
+    void recordTickDuration(double milliseconds) {
+        std::lock_guard<std::mutex> lock(playersMutex);
+        tickHistogram.record(milliseconds);
+    }
+
+    TickHistogram getTickHistogram() {
+        std::lock_guard<std::mutex> lock(playersMutex);
+        return tickHistogram;
+    }
 
     entt::registry &getRegistry() { return registry; }
     std::mutex &getRegistryMutex() { return registryMutex; }
     const std::vector<uint64_t> &getPlayerList() const { return players; }
 
     void addPlayer(uint64_t playerId) {
+        if (players.size() == MAX_PLAYERS) {
+            AT_ERROR("Lobby {} is full, player {} not added.", lobbyId, playerId);
+            return;
+        }
         players.push_back(playerId);
 
         if (playerLives.find(playerId) == playerLives.end()) {
@@ -87,22 +111,37 @@ public:
     }
 
     int getPlayersSize() { return this->players.size(); }
-    uint64_t getId() const { return entId; }
+    uint64_t getId() const { return lobbyId; }
     bool hasStarted() const { return started; }
 
-    void addConnection(uint64_t playerId, crow::websocket::connection *conn) {
+    // A second connection for the same player replaces the first, which gets no more frames and
+    // whose inputs are refused from then on. Returns the ring the connection pushes its inputs to,
+    // without a lobby lock; nullptr if the player has no seat. Called under the registry mutex.
+    std::shared_ptr<InputRing> addConnection(uint64_t playerId, crow::websocket::connection *conn) {
         std::lock_guard<std::mutex> lock(playersMutex);
-        this->synced = false;
         playerConnections[playerId] = conn;
+        acknowledgedTicks[playerId] = 0; // a new connection starts from a full state
+
+        const size_t seat = getSeat(playerId);
+        if (seat >= players.size()) {
+            return nullptr;
+        }
+        closeInputRing(seat);
+        inputRings[seat] = std::make_shared<InputRing>();
+        return inputRings[seat];
     }
 
-    void removeConnection(uint64_t playerId) {
+    // Only removes conn if it is still the player's current connection. Called under the registry mutex.
+    void removeConnection(uint64_t playerId, const crow::websocket::connection *conn) {
         std::lock_guard<std::mutex> lock(playersMutex);
+        if (auto it = playerConnections.find(playerId); it == playerConnections.end() || it->second != conn) {
+            return;
+        }
         playerConnections.erase(playerId);
-    }
-
-    void markUnSynced() {
-        this->synced = false;
+        acknowledgedTicks.erase(playerId);
+        if (const size_t seat = getSeat(playerId); seat < players.size()) {
+            closeInputRing(seat);
+        }
     }
 
     // Fixed respawnPlayer function to correctly handle const references
@@ -126,12 +165,28 @@ public:
     }
 
 private:
-    const float baseSpeed = 100.0f;
     const float shootCooldown = 0.5f;  // 500ms cooldown between shots
     std::unordered_map<uint64_t, float> lastShotTimes;
     std::unordered_map<uint64_t, PlayerSpawnPoint> playerSpawnPoints;
     std::unordered_map<uint64_t, int> playerLives;
+    // Client input time a seat can bank, in seconds. Every tick adds its duration and every input spends
+    // its dt, so a late batch of inputs can catch up but a client never moves faster than real time for
+    // longer than this.
+    static constexpr float MAX_INPUT_BURST = 0.2f;
+
     bool isPositionInsideFireball(const glm::vec3& spawnPosition);
+    void applyInput(entt::entity entity, TransformComponent &transform, PawnComponent &pawn, const PlayerInput &input, float step);
+    bool collidesWithWall(const glm::vec3 &position, const glm::vec2 &scale);
+    void captureSnapshot(Snapshot &snapshot);
+
+    // One encoded frame per distinct baseline in the current tick, immutable once built.
+    struct EncodedFrame {
+        uint32_t baseTick;
+        Ref<const std::string> data;
+        double encodeMs;
+    };
+
+    const EncodedFrame &encodeFrame(const Snapshot &snapshot, const Snapshot *baseline);
 
     bool canPlayerShoot(uint64_t playerId, float currentTime) {
         auto it = lastShotTimes.find(playerId);
@@ -148,19 +203,37 @@ private:
     entt::registry registry;
     std::mutex registryMutex;
     std::vector<uint64_t> players;
+    uint64_t lobbyId = 0; // also the match id the clients see
     uint64_t entId = 0;
 
     bool started = false;
 
-    std::unordered_map<uint64_t, PlayerInput> inputQueue;
-    std::mutex inputMutex;
+    // By seat, the player's index in players: the current connection's ring. A replaced ring is closed
+    // and drained once more on the next tick. Both guarded by the registry mutex.
+    std::array<std::shared_ptr<InputRing>, MAX_PLAYERS> inputRings;
+    std::vector<std::pair<size_t, std::shared_ptr<InputRing>>> closedInputRings;
+    std::array<float, MAX_PLAYERS> inputTime{};     // by seat, banked input seconds, tick thread only
+
+    size_t getSeat(uint64_t playerId) const { return std::ranges::find(players, playerId) - players.begin(); }
+
+    void closeInputRing(size_t seat) {
+        if (inputRings[seat]) {
+            inputRings[seat]->close();
+            closedInputRings.emplace_back(seat, std::move(inputRings[seat]));
+        }
+    }
 
     std::unordered_map<uint64_t, crow::websocket::connection *> playerConnections;
     std::mutex playersMutex;
 
-    std::vector<uint64_t> deletedEntities;
+    CollisionGrid collisionGrid;
 
-    bool synced{true};
+    SnapshotHistory snapshots;
+    uint32_t currentTick = 0;
+    std::unordered_map<uint64_t, uint32_t> acknowledgedTicks; // guarded by playersMutex
+    std::vector<EncodedFrame> encodedFrames;
+    LobbyNetworkStats networkStats; // guarded by playersMutex
+    TickHistogram tickHistogram;    // guarded by playersMutex
 };
 
 #define DIRTY_COMPONENT(clazz) \
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Atlas.hpp>
+#include <crow.h>
+
+/**
+ * Parked /match_wait requests of queued players. Instead of answering right away the route hands
+ * its response to the registry; createMatch completes it the moment the player gets a lobby, and
+ * requests nobody completed are answered with matchFound false once their deadline passes so the
+ * client can simply ask again.
+ *
+ * Responses are ended outside of the registry lock, crow may write them out on the calling thread.
+ */
+class MatchWaitRegistry {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static std::string matchFoundBody(uint64_t matchId) {
+        return nlohmann::json{{"matchFound", true}, {"matchId", matchId}}.dump();
+    }
+
+    void wait(uint64_t playerId, crow::response &response, Clock::time_point deadline) {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiters[playerId].push_back({&response, deadline});
+    }
+
+    // The player got matchId, every request it has parked returns.
+    void notify(uint64_t playerId, uint64_t matchId) {
+        complete(take(playerId), 200, matchFoundBody(matchId));
+    }
+
+    // The player left the queue without a match.
+    void cancel(uint64_t playerId) {
+        complete(take(playerId), 404, R"({"error": "Player not found in queue or match"})");
+    }
+
+    // Answers the requests whose deadline passed, the clients reissue them.
+    void expire(Clock::time_point now) {
+        std::vector<Waiter> expired;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = waiters.begin(); it != waiters.end();) {
+                auto &pending = it->second;
+                std::erase_if(pending, [&](const Waiter &waiter) {
+                    if (waiter.deadline > now) return false;
+                    expired.push_back(waiter);
+                    return true;
+                });
+                it = pending.empty() ? waiters.erase(it) : std::next(it);
+            }
+        }
+        complete(expired, 200, R"({"matchFound": false})");
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = 0;
+        for (const auto &[playerId, pending]: waiters) count += pending.size();
+        return count;
+    }
+
+private:
+    struct Waiter {
+        crow::response *response;
+        Clock::time_point deadline;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<Waiter>> waiters; // player id -> parked requests
+
+    std::vector<Waiter> take(uint64_t playerId) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = waiters.find(playerId);
+        if (it == waiters.end()) return {};
+
+        auto pending = std::move(it->second);
+        waiters.erase(it);
+        return pending;
+    }
+
+    static void complete(const std::vector<Waiter> &pending, int code, const std::string &body) {
+        for (const Waiter &waiter: pending) {
+            waiter.response->code = code;
+            waiter.response->body = body;
+            waiter.response->end();
+        }
+    }
+};
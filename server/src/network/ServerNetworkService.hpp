@@ -4,12 +4,17 @@
 #include <crow.h>
 
 #include "Lobby.hpp"
+#include "MatchWaitRegistry.hpp"
+#include "SessionRegistry.hpp"
+#include "core/SlotMap.hpp"
 #include "data/DatabaseManager.hpp"
+#include "data/PersistenceQueue.hpp"
+#include "matchmaking/MatchmakingIndex.hpp"
 #include "matchmaking/MatchmakingManager.hpp"
 
 class ServerNetworkService {
 public:
-    ServerNetworkService() : running(false) {
+    ServerNetworkService() : running(false), tickExecutor(std::max(1u, std::thread::hardware_concurrency())) {
         MatchmakingManager::init();
     }
 
@@ -18,6 +23,10 @@ public:
         if (matchmakingThread.joinable()) {
             matchmakingThread.join();
         }
+        // the tick thread still hands work to tickExecutor, stop it before the executor goes away
+        if (tickThread.joinable()) {
+            tickThread.join();
+        }
         MatchmakingManager::shutdown();
     }
 
@@ -42,13 +51,7 @@ public:
                     return crow::response(400, std::string(R"({"requestStatus": false, "message" : "Invalid username. Must be at least 4 characters long and contain at least one number."})"));
                 }
 
-                auto players = DatabaseManager::getAll<Player>();
-
-                bool usernameExists = std::ranges::find_if(players, [&username](const Player &player) {
-                    return player.getUsername() == username;
-                }) != players.end();
-
-                if (usernameExists) {
+                if (DatabaseManager::findPlayerByUsername(username)) {
                     return crow::response(400, std::string(R"({"requestStatus": false, "message" : "Username already exists"})"));
                 }
 
@@ -67,24 +70,14 @@ public:
             auto username = requestBody["username"].get<std::string>();
             auto password = requestBody["password"].get<std::string>();
 
-            auto players = DatabaseManager::getAll<Player>();
-
-            const auto it = std::ranges::find_if(players, [&](const Player &player) {
-                return player.getUsername() == username;
-            });
+            const auto it = DatabaseManager::findPlayerByUsername(username);
 
-            if (it == players.end() || it->getPassword() != password) {
+            if (!it || it->getPassword() != password) {
                 return crow::response(400, std::string(R"({"requestStatus": false, "message" : "Wrong username or password"})"));
             }
 
-            for (const auto &[existingToken, loggedPlayer]: this->players) {
-                if (loggedPlayer.getUsername() == username) {
-                    return crow::response(200, std::format(R"({{"requestStatus": true, "authToken": {0}}})", existingToken));
-                }
-            }
-
-            const auto authToken = Uuid::randomUUID().getMostSignificantBits() & 0x7FFFFFFFFFFFFFF;
-            this->players[authToken] = *it;
+            // a second login of the same player gets the open session back
+            const auto authToken = sessions.open(*it);
 
             return crow::response(200, std::format(R"({{"requestStatus": true, "authToken": {0}}})", authToken));
         });
@@ -99,28 +92,27 @@ public:
                 AT_INFO("Received matchmaking request with auth token: {}", authToken);
 
                 // Find player using auth token
-                auto playerIt = players.find(authToken);
-                if (playerIt == players.end()) {
-                    AT_ERROR("Player with auth token {} not found in players map", authToken);
+                auto player = sessions.find(authToken);
+                if (!player) {
+                    AT_ERROR("Player with auth token {} not found in sessions", authToken);
                     return crow::response(400, "Player not found");
                 } {
                     std::lock_guard<std::mutex> lock(queueMutex);
 
                     // Check if player is already in queue using their auth token
-                    auto it = std::find_if(matchmakingQueue.begin(), matchmakingQueue.end(),
-                                           [authToken](const QueuedPlayer &qp) { return qp.playerId == authToken; });
-
-                    if (it != matchmakingQueue.end()) {
+                    if (matchmakingQueue.contains(authToken)) {
                         return crow::response(400, "Already in queue");
                     }
 
                     // Add to queue with full player object
-                    matchmakingQueue.push_back({
+                    const auto &queued = matchmakingQueue.emplace(authToken, QueuedPlayer{
                         authToken, // Use auth token as player ID for now
-                        playerIt->second, // Store the full Player object
+                        *player, // Store the full Player object
                         mode,
                         std::chrono::system_clock::now()
-                    });
+                    }).first->second;
+                    getQueueIndex(mode).insert(authToken, queued.player.getGlickoRating(),
+                                               queued.player.getRatingDeviation(), queued.queueTime);
 
                     AT_INFO("Player with auth token {} added to {} queue", authToken,
                             mode == GameMode::HEX_DUEL ? "HEX_DUEL" : "HEX_ARENA");
@@ -138,12 +130,13 @@ public:
                 uint64_t authToken = body["playerId"].i();
 
                 // Verify the auth token is valid
-                if (players.find(authToken) == players.end()) {
+                if (!sessions.contains(authToken)) {
                     return crow::response(400, "Invalid auth token");
                 } {
                     std::lock_guard<std::mutex> lock(queueMutex);
                     removeFromQueue({authToken});
                 }
+                matchWaits.cancel(authToken);
 
                 return crow::response(200, "Removed from queue");
             } catch (const std::exception &e) {
@@ -165,28 +158,14 @@ public:
 
                 uint64_t playerId = std::stoull(playerIdStr);
 
-                // Check if player is in any lobby
-                for (const auto &lobby: lobbies) {
-                    auto &playerList = lobby.getPlayerList();
-                    if (std::find(playerList.begin(), playerList.end(), playerId) != playerList.end()) {
-                        nlohmann::json response = {
-                            {"matchFound", true},
-                            {"matchId", lobby.getId()}
-                        };
-                        return crow::response(200, response.dump());
-                    }
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (auto lobby = findPlayerLobby(playerId)) {
+                    return crow::response(200, MatchWaitRegistry::matchFoundBody(lobby->lobbyId));
                 }
 
-                // Check if player is still in queue
-                {
-                    std::lock_guard<std::mutex> lock(queueMutex);
-                    auto it = std::find_if(matchmakingQueue.begin(), matchmakingQueue.end(),
-                                           [playerId](const QueuedPlayer &qp) { return qp.playerId == playerId; });
-
-                    if (it == matchmakingQueue.end()) {
-                        // Player is neither in queue nor in a match
-                        return crow::response(404, R"({"error": "Player not found in queue or match"})");
-                    }
+                if (!matchmakingQueue.contains(playerId)) {
+                    // Player is neither in queue nor in a match
+                    return crow::response(404, R"({"error": "Player not found in queue or match"})");
                 }
 
                 // Player is still in queue
@@ -197,62 +176,167 @@ public:
             }
         });
 
+        // Long poll version of /match_status, answers as soon as the player is matched or after timeoutMs.
+        CROW_ROUTE(app, "/match_wait").methods(crow::HTTPMethod::GET)([this](const crow::request &req, crow::response &res) {
+            try {
+                auto playerIdStr = req.url_params.get("playerId");
+                if (!playerIdStr) {
+                    res.code = 400;
+                    res.body = R"({"error": "Missing playerId parameter"})";
+                    res.end();
+                    return;
+                }
+
+                uint64_t playerId = std::stoull(playerIdStr);
+                auto timeout = MAX_MATCH_WAIT;
+                if (auto timeoutStr = req.url_params.get("timeoutMs")) {
+                    timeout = std::clamp(std::chrono::milliseconds(std::stoll(timeoutStr)), std::chrono::milliseconds(0), MAX_MATCH_WAIT);
+                }
+
+                // createMatch runs under queueMutex, the player cannot move from the queue to a lobby in between
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (auto lobby = findPlayerLobby(playerId)) {
+                    res.code = 200;
+                    res.body = MatchWaitRegistry::matchFoundBody(lobby->lobbyId);
+                } else if (!matchmakingQueue.contains(playerId)) {
+                    res.code = 404;
+                    res.body = R"({"error": "Player not found in queue or match"})";
+                } else {
+                    matchWaits.wait(playerId, res, MatchWaitRegistry::Clock::now() + timeout);
+                    return;
+                }
+                res.end();
+            } catch (const std::exception &e) {
+                res.code = 400;
+                res.body = nlohmann::json{{"error", std::string("Error: ") + e.what()}}.dump();
+                res.end();
+            }
+        });
+
         CROW_ROUTE(app, "/match_result").methods(crow::HTTPMethod::POST)([this](const crow::request &req) {
             try {
                 auto body = crow::json::load(req.body);
                 uint64_t matchId = body["matchId"].i();
                 uint64_t winnerId = body["winnerId"].i();
 
-                // Find the match lobby
-                auto lobbyIt = std::find_if(lobbies.begin(), lobbies.end(),
-                                            [matchId](const Lobby &lobby) {
-                                                return lobby.getId() == matchId;
-                                            });
+                std::vector<uint64_t> lobbyPlayers;
+                std::vector<Player> matchPlayers;
+                {
+                    auto &shard = getShard(matchId);
+                    std::unique_lock lock(shard.mutex);
 
-                if (lobbyIt == lobbies.end()) {
-                    return crow::response(404, "Match not found");
-                }
+                    // Find the match lobby
+                    auto lobbyIt = shard.lobbyIds.find(matchId);
+                    if (lobbyIt == shard.lobbyIds.end()) {
+                        return crow::response(404, "Match not found");
+                    }
+                    lobbyPlayers = shard.lobbies.get(lobbyIt->second)->getPlayerList();
 
-                // Get all players in the match
-                std::vector<Player> matchPlayers;
-                for (uint64_t playerId: lobbyIt->getPlayerList()) {
-                    auto playerIt = players.find(playerId);
-                    if (playerIt != players.end()) {
-                        matchPlayers.push_back(playerIt->second);
+                    // Get all players in the match
+                    for (uint64_t playerId: lobbyPlayers) {
+                        if (auto player = sessions.find(playerId)) {
+                            matchPlayers.push_back(*player);
+                        }
                     }
-                }
 
-                // Find winner
-                auto winnerIt = std::ranges::find_if(matchPlayers,
-                                                     [winnerId](const Player &p) { return p.getId() == winnerId; });
+                    if (std::ranges::none_of(matchPlayers, [winnerId](const Player &p) { return p.getId() == winnerId; })) {
+                        return crow::response(400, "Invalid winner ID");
+                    }
 
-                if (winnerIt == matchPlayers.end()) {
-                    return crow::response(400, "Invalid winner ID");
+                    // Clean up the lobby, the game loop erases it before the next tick
+                    shard.closedLobbies.push_back(lobbyIt->second);
+                    shard.lobbyIds.erase(lobbyIt);
                 }
+                forgetPlayerLobbies(lobbyPlayers, matchId);
 
                 // Update ratings
+                auto winnerIt = std::ranges::find_if(matchPlayers,
+                                                     [winnerId](const Player &p) { return p.getId() == winnerId; });
                 MatchmakingManager::updateRatings(matchPlayers, *winnerIt);
 
-                // Clean up the lobby
-                lobbies.erase(lobbyIt);
-
                 return crow::response(200, "Match results processed");
             } catch (const std::exception &e) {
                 return crow::response(400, std::string("Error: ") + e.what());
             }
         });
 
+        CROW_ROUTE(app, "/metrics")([this]() {
+            // rolling per-zone timings plus the per-lobby tick and broadcast counters
+            Profiler::collect();
+
+            nlohmann::json zones = nlohmann::json::array();
+            for (const auto &zone: Profiler::getZoneStats()) {
+                zones.push_back({
+                    {"name", zone.name},
+                    {"count", zone.count},
+                    {"p50", zone.p50Ms},
+                    {"p95", zone.p95Ms},
+                    {"p99", zone.p99Ms},
+                    {"max", zone.maxMs}
+                });
+            }
+
+            nlohmann::json lobbyMetrics = nlohmann::json::array();
+            for (auto &shard: lobbyShards) {
+                std::shared_lock lock(shard.mutex);
+                for (auto &lobby: shard.lobbies) {
+                    const auto histogram = lobby.getTickHistogram();
+                    const auto network = lobby.getNetworkStats();
+                    lobbyMetrics.push_back({
+                        {"id", lobby.getId()},
+                        {"tick", {
+                            {"count", histogram.getCount()},
+                            {"mean", histogram.getMean()},
+                            {"p50", histogram.percentile(0.50)},
+                            {"p95", histogram.percentile(0.95)},
+                            {"p99", histogram.percentile(0.99)},
+                            {"max", histogram.getMax()}
+                        }},
+                        {"network", {
+                            {"framesEncoded", network.framesEncoded},
+                            {"framesShared", network.framesShared},
+                            {"bytesSent", network.bytesSent},
+                            {"bytesSaved", network.bytesSaved},
+                            {"encodeMs", network.encodeMs},
+                            {"encodeMsSaved", network.encodeMsSaved}
+                        }}
+                    });
+                }
+            }
+
+            const auto persistence = PersistenceQueue::getStats();
+
+            nlohmann::json response = {
+                {"zones", zones},
+                {"droppedEvents", Profiler::getDroppedEvents()},
+                {"lobbies", lobbyMetrics},
+                {"matchWaits", matchWaits.size()},
+                {"sessions", sessions.size()},
+                {"persistence", {
+                    {"queueDepth", persistence.queueDepth},
+                    {"maxQueueDepth", persistence.maxQueueDepth},
+                    {"batchesCommitted", persistence.batchesCommitted},
+                    {"writesCommitted", persistence.writesCommitted},
+                    {"writesCoalesced", persistence.writesCoalesced},
+                    {"lastBatchMs", persistence.lastBatchMs}
+                }}
+            };
+            return crow::response(200, response.dump());
+        });
+
+        CROW_ROUTE(app, "/metrics/trace")([]() {
+            Profiler::collect();
+            return crow::response(200, Profiler::exportChromeTrace());
+        });
+
         CROW_WEBSOCKET_ROUTE(app, "/sync_entities_ws")
                 .onopen([&](crow::websocket::connection &conn) {
-                    std::lock_guard<std::mutex> lock(handlerMutex);
-
-                    // Initialize the client state
-                    clientStates[&conn] = WebsocketClientState{0, nullptr};
+                    // the state travels with the connection, messages need no shared lookup
+                    conn.userdata(new WebsocketClientState{});
                     AT_INFO("WebSocket connection opened with remote host {}.", conn.get_remote_ip());
                 })
                 .onmessage([&](crow::websocket::connection &conn, const std::string &message, bool is_binary) {
-                    std::lock_guard<std::mutex> lock(handlerMutex);
-                    auto &state = clientStates[&conn];
+                    auto &state = *static_cast<WebsocketClientState *>(conn.userdata());
 
                     try {
                         auto requestBody = nlohmann::json::parse(message);
@@ -265,52 +349,61 @@ public:
                                 return;
                             }
 
-                            state.playerId = requestBody["playerId"].get<uint64_t>();
-
-                            for (Lobby &lobby: lobbies) {
-                                if (lobby.containsPlayer(state.playerId)) {
-                                    state.lobby = &lobby;
-
-
+                            const uint64_t playerId = requestBody["playerId"].get<uint64_t>();
+                            const auto lobby = findPlayerLobby(playerId);
+                            const bool joined = lobby && withLobby(*lobby, [&](Lobby &joinedLobby) {
+                                std::lock_guard<std::mutex> lobbyLock(joinedLobby.getRegistryMutex());
+                                state.inputRing = joinedLobby.addConnection(playerId, &conn);
+                            });
 
-                                    std::lock_guard<std::mutex> lobbyLock(lobby.getRegistryMutex());
-                                    lobby.addConnection(state.playerId, &conn);
-                                    break;
-                                }
-                            }
-
-                            if (!state.lobby) {
+                            if (!joined) {
                                 conn.send_text(nlohmann::json({{"error", "No lobby found for the player"}}).dump());
                                 conn.close();
                                 return;
                             }
+
+                            state.playerId = playerId;
+                            state.lobby = *lobby;
                         }
 
-                        if (state.lobby) {
-                            PlayerInput input;
-                            input.moveForward = requestBody["input"].value("moveForward", false);
-                            input.moveBackwards = requestBody["input"].value("moveBackward", false);
-                            input.moveLeft = requestBody["input"].value("moveLeft", false);
-                            input.moveRight = requestBody["input"].value("moveRight", false);
-                            input.aimRotation = requestBody["input"].value("aimRotation", 0.0f);
-                            input.isShooting = requestBody["input"].value("isShooting", false);
+                        PlayerInput input;
+                        input.moveForward = requestBody["input"].value("moveForward", false);
+                        input.moveBackwards = requestBody["input"].value("moveBackward", false);
+                        input.moveLeft = requestBody["input"].value("moveLeft", false);
+                        input.moveRight = requestBody["input"].value("moveRight", false);
+                        input.aimRotation = requestBody["input"].value("aimRotation", 0.0f);
+                        input.isShooting = requestBody["input"].value("isShooting", false);
+                        input.sequence = requestBody.value("seq", 0u);
+                        input.deltaTime = requestBody.value("dt", 0.0f);
+
+                        // a finished lobby may already be gone, its late inputs are dropped
+                        withLobby(state.lobby, [&](Lobby &lobby) {
+                            // the connection's own ring, once replaced by a newer connection it refuses the input
+                            if (state.inputRing) {
+                                state.inputRing->push(input);
+                            }
 
-                            state.lobby->setPlayerInput(state.playerId, input);
-                        }
+                            // last snapshot the client applied, the next frames are deltas against it
+                            if (requestBody.contains("ack")) {
+                                lobby.acknowledgeSnapshot(state.playerId, &conn, requestBody.value("ack", 0u));
+                            }
+                        });
                     } catch (const std::exception &e) {
                         conn.send_text(nlohmann::json({{"error", std::string("Error: ") + e.what()}}).dump());
                     }
                 })
                 .onclose([&](crow::websocket::connection &conn, const std::string &reason) {
-                    std::lock_guard<std::mutex> lock(handlerMutex);
-                    auto &[playerId, lobby] = clientStates[&conn];
+                    auto *state = static_cast<WebsocketClientState *>(conn.userdata());
 
-                    if (lobby) {
-                        std::lock_guard<std::mutex> lobbyLock(lobby->getRegistryMutex());
-                        lobby->removeConnection(playerId);
+                    if (state->playerId != 0) {
+                        withLobby(state->lobby, [&](Lobby &lobby) {
+                            std::lock_guard<std::mutex> lobbyLock(lobby.getRegistryMutex());
+                            lobby.removeConnection(state->playerId, &conn);
+                        });
                     }
 
-                    clientStates.erase(&conn);
+                    delete state;
+                    conn.userdata(nullptr);
                     std::cout << "WebSocket connection closed: " << reason << std::endl;
                 });
 
@@ -336,29 +429,58 @@ private:
         std::chrono::system_clock::time_point queueTime;
     };
 
+    using LobbyHandle = SlotMap<Lobby>::Handle;
+
+    struct LobbyRef {
+        uint64_t lobbyId = 0;
+        LobbyHandle handle;
+    };
+
     struct WebsocketClientState {
-        uint64_t playerId;
-        Lobby *lobby;
+        uint64_t playerId = 0;
+        LobbyRef lobby;
+        std::shared_ptr<InputRing> inputRing; // this connection is its only producer
+    };
+
+    /**
+     * Lobbies are spread over the shards by lobby id and the player -> lobby directory by player id,
+     * so unrelated matches never wait on the same lock. Using a lobby, websocket input included,
+     * takes its shard's lock shared; only adding and erasing lobbies take it exclusively. Lobbies never
+     * move and are only erased by the game loop between ticks, a handle that still resolves under the
+     * shard lock is safe to use. No code path holds two shard locks at once.
+     */
+    struct LobbyShard {
+        std::shared_mutex mutex;
+        SlotMap<Lobby> lobbies;
+        std::unordered_map<uint64_t, LobbyHandle> lobbyIds;   // lobby id -> lobby
+        std::unordered_map<uint64_t, LobbyRef> playerLobbies; // player id -> lobby, for the players hashed here
+        std::vector<LobbyHandle> closedLobbies;               // erased at the start of the next tick
     };
 
+    static constexpr size_t LOBBY_SHARDS = 16;
+
     std::atomic_bool running;
-    std::mutex handlerMutex;
     std::mutex queueMutex;
     std::thread matchmakingThread;
     std::thread tickThread;
 
-    std::vector<Lobby> lobbies;
-    std::vector<QueuedPlayer> matchmakingQueue;
-    std::unordered_map<uint64_t, Player> players;
-    std::unordered_map<crow::websocket::connection *, WebsocketClientState> clientStates;
+    ExecutorService tickExecutor;
+    std::vector<std::future<void>> tickResults;
+
+    std::array<LobbyShard, LOBBY_SHARDS> lobbyShards;
+    MatchWaitRegistry matchWaits;
+    std::unordered_map<uint64_t, QueuedPlayer> matchmakingQueue; // guarded by queueMutex, as are the indexes
+    MatchmakingIndex duelIndex;
+    MatchmakingIndex arenaIndex;
+    SessionRegistry sessions;
 
     uint64_t generateUniqueId() {
-        static uint64_t idCounter = 1;
+        static std::atomic<uint64_t> idCounter = 1;
         return idCounter++;
     }
 
     void gameLoop() {
-        constexpr uint32_t ticksPerSec = 30;
+        constexpr uint32_t ticksPerSec = SnapshotCodec::TICK_RATE;
         constexpr float ticksPerMs = 1.0f / static_cast<float>(ticksPerSec);
         AT_INFO("Game loop started. Running at {} ticks per second.", ticksPerSec);
 
@@ -366,20 +488,42 @@ private:
         while (running) {
             while (nextLoop <= Time::now().toSeconds()) {
                 auto tickStart = Time::now().toSeconds();
+                AT_PROFILE_SCOPE("server.tick");
+
+                for (auto &shard: lobbyShards) {
+                    std::unique_lock lock(shard.mutex);
+                    for (const LobbyHandle handle: shard.closedLobbies) {
+                        shard.lobbies.erase(handle);
+                    }
+                    shard.closedLobbies.clear();
+
+                    for (auto &lobby: shard.lobbies) {
+                        if (!lobby.hasStarted() && lobby.getPlayerList().size() >= 2) {
+                            std::lock_guard<std::mutex> registryLock(lobby.getRegistryMutex());
+                            lobby.start();
+                        }
 
-                for (auto &lobby: lobbies) {
-                    if (!lobby.hasStarted() && lobby.getPlayerList().size() >= 2)
-                        lobby.start();
+                        if (lobby.hasStarted()) {
+                            tickResults.push_back(tickExecutor.submit(&ServerNetworkService::tickLobby, this, std::ref(lobby), ticksPerMs));
+                        }
+                    }
+                }
 
-                    if (lobby.hasStarted()) {
-                        lobby.update(ticksPerMs);
+                // barrier, every lobby finishes this tick before the next one starts
+                for (auto &result: tickResults) {
+                    try {
+                        result.get();
+                    } catch (const std::exception &e) {
+                        AT_ERROR("Lobby tick failed: {}", e.what());
                     }
                 }
+                tickResults.clear();
+                Profiler::collect();
 
                 const float tickEnd = Time::now().toSeconds();
 
                 if (float tickDuration = tickEnd - tickStart; tickDuration > ticksPerMs) {
-                   // AT_WARN("Server is running behind! Tick took {:.4f}s, which is {:.4f}s behind.", tickDuration, tickDuration - ticksPerMs);
+                    AT_WARN("Server is running behind! Tick took {:.4f}s, which is {:.4f}s behind.", tickDuration, tickDuration - ticksPerMs);
                 }
 
                 nextLoop += ticksPerMs;
@@ -391,69 +535,96 @@ private:
         }
     }
 
-    void matchmakingLoop() {
-        while (running) {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            tryMatchDuel();
-            tryMatchArena();
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    void tickLobby(Lobby &lobby, float deltaTime) {
+        const auto tickStart = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(lobby.getRegistryMutex());
+            lobby.update(deltaTime);
         }
-    }
+        const double tickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count();
 
-    void tryMatchDuel() {
-        auto duelPlayers = getPlayersInQueue(GameMode::HEX_DUEL);
+        lobby.recordTickDuration(tickMs);
+        if (const double budgetMs = deltaTime * 1000.0; tickMs > budgetMs) {
+            AT_WARN("Lobby {} tick took {:.2f}ms, over the {:.0f}ms budget.", lobby.getId(), tickMs, budgetMs);
+        }
+    }
 
-        // Early return if we don't have enough players
-        if (duelPlayers.size() < 2) return;
+    static constexpr auto MATCHMAKING_INTERVAL = std::chrono::milliseconds(250);
+    static constexpr auto MAX_MATCH_WAIT = std::chrono::milliseconds(25000);
 
-        for (size_t i = 0; i < duelPlayers.size(); i++) {
-            for (size_t j = i + 1; j < duelPlayers.size(); j++) {
-                // Create a vector with exactly 2 players for the duel
-                std::vector<Player> playerPair = {duelPlayers[i].player, duelPlayers[j].player};
-                auto quality = MatchmakingManager::evaluateMatch(playerPair);
+    // (player id, lobby id) of the players a pass matched
+    using MatchedWaits = std::vector<std::pair<uint64_t, uint64_t>>;
 
-                if (quality.isValid && quality.quality >= 0.7) {
-                    // Create a vector with exactly 2 QueuedPlayer objects
-                    std::vector<QueuedPlayer> matchedPair = {duelPlayers[i], duelPlayers[j]};
-                    createMatch(matchedPair, GameMode::HEX_DUEL);
+    void matchmakingLoop() {
+        MatchedWaits matched;
+        while (running) {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                tryMatchDuel(matched);
+                tryMatchArena(matched);
+            }
 
-                    // Remove only the matched players from queue
-                    std::vector<uint64_t> matchedIds = {duelPlayers[i].playerId, duelPlayers[j].playerId};
-                    removeFromQueue(matchedIds);
-                    return; // Exit after creating a match
-                }
+            // completing a parked /match_wait may write the response out, never under queueMutex
+            for (const auto &[playerId, lobbyId]: matched) {
+                matchWaits.notify(playerId, lobbyId);
             }
+            matched.clear();
+            matchWaits.expire(MatchWaitRegistry::Clock::now());
+            std::this_thread::sleep_for(MATCHMAKING_INTERVAL);
         }
     }
 
-    void tryMatchArena() {
-        auto arenaPlayers = getPlayersInQueue(GameMode::HEX_ARENA);
-
-        // Early return if we don't have enough players
-        if (arenaPlayers.size() < 4) return;
+    void tryMatchDuel(MatchedWaits &matchedWaits) {
+        tryMatchGroups(GameMode::HEX_DUEL, 2, 0.7, matchedWaits);
+    }
 
-        // Look for groups of exactly 4 players
-        for (size_t i = 0; i <= arenaPlayers.size() - 4; i++) {
-            // Take exactly 4 players for evaluation
-            std::vector<QueuedPlayer> potentialMatch(arenaPlayers.begin() + i, arenaPlayers.begin() + i + 4);
+    void tryMatchArena(MatchedWaits &matchedWaits) {
+        tryMatchGroups(GameMode::HEX_ARENA, 4, 0.6, matchedWaits);
+    }
 
-            std::vector<Player> playerGroup;
-            for (const auto &qp: potentialMatch) {
-                playerGroup.push_back(qp.player);
+    // Only the closest rated players around each waiting player are evaluated, see MatchmakingIndex. The
+    // candidate groups of the pass are scored in one batch call, then taken in anchor order; a group with a
+    // player that was already matched this pass is skipped and its anchor tries again next pass.
+    void tryMatchGroups(GameMode mode, size_t groupSize, double minQuality, MatchedWaits &matchedWaits) {
+        auto &index = getQueueIndex(mode);
+        if (index.size() < groupSize) return;
+
+        std::vector<uint64_t> candidates;
+        const size_t groupCount = index.collectCandidates(groupSize, std::chrono::system_clock::now(), candidates);
+        if (groupCount == 0) return;
+
+        // every candidate once in the pool, the groups refer to it by index
+        std::vector<MatchmakingManager::Rating> pool;
+        std::vector<int> groupIndices;
+        std::unordered_map<uint64_t, int> poolIndex;
+        groupIndices.reserve(candidates.size());
+        for (const uint64_t playerId: candidates) {
+            const auto [it, inserted] = poolIndex.try_emplace(playerId, static_cast<int>(pool.size()));
+            if (inserted) {
+                pool.push_back(MatchmakingManager::toRating(matchmakingQueue.at(playerId).player));
             }
+            groupIndices.push_back(it->second);
+        }
 
-            auto quality = MatchmakingManager::evaluateMatch(playerGroup);
+        std::vector<float> quality(groupCount);
+        MatchmakingManager::evaluateMatchesBatch(pool, groupIndices, static_cast<int>(groupSize), quality);
 
-            if (quality.isValid && quality.quality >= 0.6) {
-                createMatch(potentialMatch, GameMode::HEX_ARENA);
+        std::vector<QueuedPlayer> matched;
+        for (size_t g = 0; g < groupCount; ++g) {
+            if (quality[g] < minQuality) continue;
 
-                // Remove exactly these 4 players from queue
-                std::vector<uint64_t> playerIds;
-                for (const auto &player: potentialMatch) {
-                    playerIds.push_back(player.playerId);
-                }
-                removeFromQueue(playerIds);
-                return; // Exit after creating a match
+            const std::span<const uint64_t> group(candidates.data() + g * groupSize, groupSize);
+            if (!std::ranges::all_of(group, [&](uint64_t playerId) { return index.contains(playerId); })) continue;
+
+            matched.clear();
+            for (const uint64_t playerId: group) {
+                matched.push_back(matchmakingQueue.at(playerId));
+            }
+            createMatch(matched, mode, matchedWaits);
+
+            for (const uint64_t playerId: group) {
+                index.erase(playerId);
+                matchmakingQueue.erase(playerId);
             }
         }
     }
@@ -470,27 +641,22 @@ private:
         return true;
     }
 
-    std::vector<QueuedPlayer> getPlayersInQueue(GameMode mode) {
-        std::vector<QueuedPlayer> result;
-        std::copy_if(matchmakingQueue.begin(), matchmakingQueue.end(),
-                     std::back_inserter(result),
-                     [mode](const QueuedPlayer &player) { return player.mode == mode; });
-        return result;
+    MatchmakingIndex &getQueueIndex(GameMode mode) {
+        return mode == GameMode::HEX_DUEL ? duelIndex : arenaIndex;
     }
 
     void removeFromQueue(const std::vector<uint64_t> &playerIds) {
-        matchmakingQueue.erase(
-            std::remove_if(matchmakingQueue.begin(), matchmakingQueue.end(),
-                           [&](const QueuedPlayer &player) {
-                               return std::find(playerIds.begin(), playerIds.end(),
-                                                player.playerId) != playerIds.end();
-                           }),
-            matchmakingQueue.end());
+        for (const uint64_t playerId: playerIds) {
+            if (auto it = matchmakingQueue.find(playerId); it != matchmakingQueue.end()) {
+                getQueueIndex(it->second.mode).erase(playerId);
+                matchmakingQueue.erase(it);
+            }
+        }
     }
 
-    void createMatch(const std::vector<QueuedPlayer> &matchedPlayers, GameMode mode) {
-        std::lock_guard<std::mutex> lock(handlerMutex);
-
+    // Called with queueMutex held. The players' parked /match_wait requests are appended to matchedWaits,
+    // the caller completes them once it released queueMutex.
+    void createMatch(const std::vector<QueuedPlayer> &matchedPlayers, GameMode mode, MatchedWaits &matchedWaits) {
         // Verify correct number of players for game mode
         size_t expectedPlayers = (mode == GameMode::HEX_DUEL) ? 2 : 4;
         if (matchedPlayers.size() != expectedPlayers) {
@@ -500,12 +666,24 @@ private:
         }
 
         // Create lobby and add authorized players to its list
-        lobbies.emplace_back();
-        Lobby &lobby = lobbies.back();
+        const uint64_t lobbyId = generateUniqueId();
+        LobbyRef lobby{lobbyId};
+        {
+            auto &shard = getShard(lobbyId);
+            std::unique_lock lock(shard.mutex);
+            lobby.handle = shard.lobbies.emplace(lobbyId);
+
+            // Add all matched players to authorized list
+            for (const auto &player: matchedPlayers) {
+                shard.lobbies.get(lobby.handle)->addPlayer(player.playerId);
+            }
+            shard.lobbyIds.emplace(lobbyId, lobby.handle);
+        }
 
-        // Add all matched players to authorized list
         for (const auto &player: matchedPlayers) {
-            lobby.addPlayer(player.playerId);
+            auto &shard = getShard(player.playerId);
+            std::unique_lock lock(shard.mutex);
+            shard.playerLobbies[player.playerId] = lobby;
         }
 
         // Create match record
@@ -513,81 +691,123 @@ private:
         std::vector<int> playerIds;
         for (const auto &player: matchedPlayers) {
             Player updatedPlayer = player.player;
-            updatedPlayer.setMatchId(lobby.getId());
-            DatabaseManager::update(updatedPlayer);
+            updatedPlayer.setMatchId(lobbyId);
+            PersistenceQueue::update(updatedPlayer);
             playerIds.push_back(static_cast<int>(player.playerId));
         }
 
         matchRecord.setPlayerIds(playerIds);
-        DatabaseManager::create(matchRecord);
+        PersistenceQueue::create(matchRecord);
+
+        for (const auto &player: matchedPlayers) {
+            matchedWaits.emplace_back(player.playerId, lobbyId);
+        }
 
         AT_INFO("Created new {} lobby for {} players",
                 mode == GameMode::HEX_DUEL ? "HEX_DUEL" : "HEX_ARENA",
                 matchedPlayers.size());
     }
 
-    crow::response handleJoinMatch(const crow::request &req) {
-        std::lock_guard<std::mutex> lock(handlerMutex);
+    LobbyShard &getShard(uint64_t id) {
+        return lobbyShards[id % LOBBY_SHARDS];
+    }
 
+    std::optional<LobbyRef> findPlayerLobby(uint64_t playerId) {
+        auto &shard = getShard(playerId);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.playerLobbies.find(playerId);
+        if (it == shard.playerLobbies.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // Runs func(Lobby &) under the shard lock if the lobby still exists.
+    template<typename Func>
+    bool withLobby(const LobbyRef &ref, Func &&func) {
+        auto &shard = getShard(ref.lobbyId);
+        std::shared_lock lock(shard.mutex);
+        Lobby *lobby = shard.lobbies.get(ref.handle);
+        if (!lobby) {
+            return false;
+        }
+        func(*lobby);
+        return true;
+    }
+
+    void forgetPlayerLobbies(const std::vector<uint64_t> &playerIds, uint64_t lobbyId) {
+        for (const uint64_t playerId: playerIds) {
+            auto &shard = getShard(playerId);
+            std::unique_lock lock(shard.mutex);
+            // the player may already be in a newer lobby
+            if (auto it = shard.playerLobbies.find(playerId); it != shard.playerLobbies.end() && it->second.lobbyId == lobbyId) {
+                shard.playerLobbies.erase(it);
+            }
+        }
+    }
+
+    crow::response handleJoinMatch(const crow::request &req) {
         try {
             auto body = crow::json::load(req.body);
             uint64_t playerId = body["playerId"].i();
 
             // Find the lobby this player belongs to
-            for (auto &lobby: lobbies) {
-                if (lobby.containsPlayer(playerId)) {
-                    auto &playerList = lobby.getPlayerList();
-                    size_t playerIndex = std::find(playerList.begin(), playerList.end(), playerId) - playerList.begin();
-
-                    // Create player entity with position based on index
-                    Actor playerEntity = lobby.getRegistry().create();
-                    glm::vec3 position;
-
-                    // Position based on total expected players
-                    if (lobby.getPlayersSize() < 3) {
-                        // For 2 players - diagonal spawn
-                        switch (playerIndex) {
-                            case 0:
-                                position = glm::vec3(-2400, 2400, 0); // Top left
-                                break;
-                            case 1:
-                                position = glm::vec3(2400, -2400, 0); // Bottom right
-                                break;
-                            default:
-                                position = glm::vec3(0, 0, 0);
-                                break;
-                        }
-                    } else {
-                        // For 3-4 players - all corners
-                        switch (playerIndex) {
-                            case 0:
-                                position = glm::vec3(-2400, -2400, 0); // Bottom left
-                                break;
-                            case 1:
-                                position = glm::vec3(2400, -2400, 0); // Bottom right
-                                break;
-                            case 2:
-                                position = glm::vec3(-2400, 2400, 0); // Top left
-                                break;
-                            case 3:
-                                position = glm::vec3(2400, 2400, 0); // Top right
-                                break;
-                            default:
-                                position = glm::vec3(0, 0, 0);
-                                break;
-                        }
+            const auto playerLobby = findPlayerLobby(playerId);
+            const bool joined = playerLobby && withLobby(*playerLobby, [&](Lobby &lobby) {
+                std::lock_guard<std::mutex> registryLock(lobby.getRegistryMutex()); // the lobby may be ticking
+                auto &playerList = lobby.getPlayerList();
+                size_t playerIndex = std::find(playerList.begin(), playerList.end(), playerId) - playerList.begin();
+
+                // Create player entity with position based on index
+                Actor playerEntity = lobby.getRegistry().create();
+                glm::vec3 position;
+
+                // Position based on total expected players
+                if (lobby.getPlayersSize() < 3) {
+                    // For 2 players - diagonal spawn
+                    switch (playerIndex) {
+                        case 0:
+                            position = glm::vec3(-2400, 2400, 0); // Top left
+                            break;
+                        case 1:
+                            position = glm::vec3(2400, -2400, 0); // Bottom right
+                            break;
+                        default:
+                            position = glm::vec3(0, 0, 0);
+                            break;
+                    }
+                } else {
+                    // For 3-4 players - all corners
+                    switch (playerIndex) {
+                        case 0:
+                            position = glm::vec3(-2400, -2400, 0); // Bottom left
+                            break;
+                        case 1:
+                            position = glm::vec3(2400, -2400, 0); // Bottom right
+                            break;
+                        case 2:
+                            position = glm::vec3(-2400, 2400, 0); // Top left
+                            break;
+                        case 3:
+                            position = glm::vec3(2400, 2400, 0); // Top right
+                            break;
+                        default:
+                            position = glm::vec3(0, 0, 0);
+                            break;
                     }
-                    lobby.getRegistry().emplace<TransformComponent>(playerEntity, position, 0.0f, glm::vec2(100, 100));
-                    lobby.getRegistry().emplace<PawnComponent>(playerEntity, playerId);
-                    lobby.getRegistry().emplace<NetworkComponent>(playerEntity, lobby.nextId());
+                }
+                lobby.getRegistry().emplace<TransformComponent>(playerEntity, position, 0.0f, glm::vec2(100, 100));
+                lobby.getRegistry().emplace<PawnComponent>(playerEntity, playerId);
+                lobby.getRegistry().emplace<NetworkComponent>(playerEntity, lobby.nextId());
 
-                    //lobby.getRegistry().emplace<RigidbodyComponent>(playerEntity, RigidbodyComponent{true});
+                //lobby.getRegistry().emplace<RigidbodyComponent>(playerEntity, RigidbodyComponent{true});
+            });
 
-                    return crow::response(200, std::to_string(playerId));
-                }
+            if (!joined) {
+                return crow::response(404, "No matching lobby found for player");
             }
 
-            return crow::response(404, "No matching lobby found for player");
+            return crow::response(200, std::to_string(playerId));
         } catch (const std::exception &e) {
             return crow::response(400, std::string("Error: ") + e.what());
         }
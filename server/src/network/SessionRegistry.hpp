@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Atlas.hpp>
+#include <shared_mutex>
+
+#include "data/Player.hpp"
+
+/**
+ * Logged in players by auth token, with a second index by username so a repeated login finds the
+ * open session without scanning. Both maps change together under one lock.
+ */
+class SessionRegistry {
+public:
+    // Returns the token of the player's session, opening one if the player has none.
+    uint64_t open(const Player &player) {
+        std::unique_lock lock(mutex);
+        if (auto it = byUsername.find(player.getUsername()); it != byUsername.end()) {
+            return it->second;
+        }
+
+        uint64_t authToken;
+        do {
+            authToken = Uuid::randomUUID().getMostSignificantBits() & 0x7FFFFFFFFFFFFFF;
+        } while (authToken == 0 || sessions.contains(authToken));
+
+        sessions.emplace(authToken, player);
+        byUsername.emplace(player.getUsername(), authToken);
+        return authToken;
+    }
+
+    bool close(uint64_t authToken) {
+        std::unique_lock lock(mutex);
+        auto it = sessions.find(authToken);
+        if (it == sessions.end()) return false;
+
+        byUsername.erase(it->second.getUsername());
+        sessions.erase(it);
+        return true;
+    }
+
+    std::optional<Player> find(uint64_t authToken) const {
+        std::shared_lock lock(mutex);
+        auto it = sessions.find(authToken);
+        if (it == sessions.end()) return std::nullopt;
+        return it->second;
+    }
+
+    bool contains(uint64_t authToken) const {
+        std::shared_lock lock(mutex);
+        return sessions.contains(authToken);
+    }
+
+    size_t size() const {
+        std::shared_lock lock(mutex);
+        return sessions.size();
+    }
+
+private:
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint64_t, Player> sessions;       // auth token -> player
+    std::unordered_map<std::string, uint64_t> byUsername; // username -> auth token
+};
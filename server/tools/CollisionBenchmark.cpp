@@ -0,0 +1,288 @@
+// Runs the collision work of Lobby::update on one generated 50x50 map with 4 moving pawns and 200
+// fireballs, once with the previous scans over every wall, fireball and pawn and once through the
+// CollisionGrid, and reports ticks per second. Fireballs that hit something are relaunched from a
+// free tile, so the load stays the same; both runs see the same world and must count the same hits.
+//
+// usage: collision_bench [fireballs] [ticks]
+
+#include "map/CollisionGrid.hpp"
+#include "map/MapGenerator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+    constexpr float DELTA_TIME = 1.0f / 30.0f;
+    constexpr glm::vec2 TILE_SIZE = {100.0f, 100.0f};
+    constexpr glm::vec2 FIREBALL_EXTENT = {50.0f, 50.0f};
+    constexpr size_t PAWNS = 4;
+
+    using Map = std::vector<std::vector<int>>;
+
+    struct Hits {
+        uint64_t walls = 0;
+        uint64_t fireballs = 0;
+        uint64_t pawns = 0;
+
+        bool operator==(const Hits &) const = default;
+    };
+
+    // The lobby's registry as Lobby::start() builds it, plus the pawns and fireballs.
+    struct World {
+        entt::registry registry;
+        CollisionGrid grid;
+        std::vector<entt::entity> pawns;
+        std::vector<glm::vec3> freeTiles;
+        std::mt19937 random{7};
+
+        World(const Map &map, size_t fireballs) {
+            const int width = static_cast<int>(map[0].size());
+            const int height = static_cast<int>(map.size());
+            grid = CollisionGrid(width, height, TILE_SIZE);
+
+            const float offsetX = -(width * TILE_SIZE.x) / 2.0f + TILE_SIZE.x / 2.0f;
+            const float offsetY = -(height * TILE_SIZE.y) / 2.0f + TILE_SIZE.y / 2.0f;
+
+            for (int row = 0; row < height; ++row) {
+                for (int col = 0; col < width; ++col) {
+                    const int tileNumber = map[row][col];
+                    if (tileNumber < 0) continue;
+
+                    const glm::vec3 position(col * TILE_SIZE.x + offsetX, row * TILE_SIZE.y + offsetY, 5.0f);
+                    const auto tile = registry.create();
+                    registry.emplace<TransformComponent>(tile, position, 0.0f, TILE_SIZE);
+
+                    if (tileNumber == 40 || tileNumber == 63 || tileNumber == 64) {
+                        registry.emplace<RigidbodyComponent>(tile, RigidbodyComponent{true});
+                        grid.setWall(position, tile);
+                    } else {
+                        freeTiles.push_back(position);
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < PAWNS; ++i) {
+                const auto pawn = registry.create();
+                registry.emplace<PawnComponent>(pawn, PawnComponent{i + 1});
+                registry.emplace<TransformComponent>(pawn, freeTiles[i * freeTiles.size() / PAWNS], 0.0f, TILE_SIZE);
+                pawns.push_back(pawn);
+            }
+
+            for (size_t i = 0; i < fireballs; ++i) {
+                const auto fireball = registry.create();
+                registry.emplace<FireballComponent>(fireball, glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 0.0f, 0);
+                registry.emplace<TransformComponent>(fireball, glm::vec3(0.0f), 0.0f, TILE_SIZE);
+                relaunch(fireball);
+            }
+        }
+
+        void relaunch(entt::entity fireball) {
+            std::uniform_int_distribution<size_t> tile(0, freeTiles.size() - 1);
+            std::uniform_real_distribution<float> aim(0.0f, 6.2831853f);
+
+            const glm::vec3 position = freeTiles[tile(random)];
+            auto &component = registry.get<FireballComponent>(fireball);
+            component = FireballComponent(position, FireballComponent::directionFor(aim(random)), 0.0f, 0);
+            registry.get<TransformComponent>(fireball).position = position;
+        }
+
+        // Each pawn walks one direction for a second, then turns.
+        static PlayerInput inputFor(size_t pawn, size_t tick) {
+            PlayerInput input;
+            switch ((tick / 30 + pawn) % 4) {
+                case 0: input.moveForward = true; input.moveRight = true; break;
+                case 1: input.moveRight = true; break;
+                case 2: input.moveBackwards = true; input.moveLeft = true; break;
+                default: input.moveLeft = true; break;
+            }
+            return input;
+        }
+    };
+
+    // Lobby::update before the grid: every query looks at every wall, fireball or pawn.
+    struct ScanCollisions {
+        static void beginTick(World &) {}
+        static void moved(World &, entt::entity, const glm::vec3 &, const glm::vec3 &) {}
+
+        static bool pawnHitsWall(World &world, const glm::vec3 &position, const glm::vec2 &scale) {
+            auto walls = world.registry.view<RigidbodyComponent, TransformComponent>();
+            for (const auto wall : walls) {
+                const auto &wallTransform = walls.get<TransformComponent>(wall);
+                if (walls.get<RigidbodyComponent>(wall).isSolid &&
+                    PawnMovement::hitsWall(position, scale, wallTransform.position, wallTransform.scale)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static bool fireballHitsWall(World &world, const glm::vec3 &position) {
+            auto walls = world.registry.view<RigidbodyComponent, TransformComponent>();
+            for (const auto wall : walls) {
+                const auto &wallTransform = walls.get<TransformComponent>(wall);
+                if (walls.get<RigidbodyComponent>(wall).isSolid &&
+                    PawnMovement::intersects(position, FIREBALL_EXTENT, wallTransform.position, wallTransform.scale * PawnMovement::WALL_EXTENT)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static bool fireballHitsFireball(World &world, entt::entity self, const glm::vec3 &position) {
+            auto fireballs = world.registry.view<FireballComponent, TransformComponent>();
+            for (const auto other : fireballs) {
+                if (other != self &&
+                    PawnMovement::intersects(position, FIREBALL_EXTENT, fireballs.get<TransformComponent>(other).position, FIREBALL_EXTENT)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static bool fireballHitsPawn(World &world, const glm::vec3 &position) {
+            auto pawns = world.registry.view<PawnComponent, TransformComponent>();
+            for (const auto pawn : pawns) {
+                const auto &pawnTransform = pawns.get<TransformComponent>(pawn);
+                if (PawnMovement::intersects(position, FIREBALL_EXTENT, pawnTransform.position, pawnTransform.scale * PawnMovement::BODY_EXTENT)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    // Lobby::update now: bodies are bucketed once per tick and queries look at the 3x3 cells around them.
+    struct GridCollisions {
+        static void beginTick(World &world) {
+            world.grid.clearBodies();
+            for (const auto pawn : world.registry.view<PawnComponent, TransformComponent>()) {
+                world.grid.insertBody(pawn, world.registry.get<TransformComponent>(pawn).position);
+            }
+            for (const auto fireball : world.registry.view<FireballComponent, TransformComponent>()) {
+                world.grid.insertBody(fireball, world.registry.get<TransformComponent>(fireball).position);
+            }
+        }
+
+        static void moved(World &world, entt::entity entity, const glm::vec3 &from, const glm::vec3 &to) {
+            world.grid.moveBody(entity, from, to);
+        }
+
+        static bool pawnHitsWall(World &world, const glm::vec3 &position, const glm::vec2 &scale) {
+            return world.grid.anyWall(position, [&](entt::entity wall) {
+                const auto &wallTransform = world.registry.get<TransformComponent>(wall);
+                return PawnMovement::hitsWall(position, scale, wallTransform.position, wallTransform.scale);
+            });
+        }
+
+        static bool fireballHitsWall(World &world, const glm::vec3 &position) {
+            return world.grid.anyWall(position, [&](entt::entity wall) {
+                const auto &wallTransform = world.registry.get<TransformComponent>(wall);
+                return PawnMovement::intersects(position, FIREBALL_EXTENT, wallTransform.position, wallTransform.scale * PawnMovement::WALL_EXTENT);
+            });
+        }
+
+        static bool fireballHitsFireball(World &world, entt::entity self, const glm::vec3 &position) {
+            return world.grid.anyBody(position, [&](entt::entity other) {
+                return other != self && world.registry.all_of<FireballComponent>(other) &&
+                       PawnMovement::intersects(position, FIREBALL_EXTENT, world.registry.get<TransformComponent>(other).position, FIREBALL_EXTENT);
+            });
+        }
+
+        static bool fireballHitsPawn(World &world, const glm::vec3 &position) {
+            return world.grid.anyBody(position, [&](entt::entity pawn) {
+                if (!world.registry.all_of<PawnComponent>(pawn)) return false;
+                const auto &pawnTransform = world.registry.get<TransformComponent>(pawn);
+                return PawnMovement::intersects(position, FIREBALL_EXTENT, pawnTransform.position, pawnTransform.scale * PawnMovement::BODY_EXTENT);
+            });
+        }
+    };
+
+    template<typename Collisions>
+    Hits tick(World &world, size_t tickNumber, std::vector<entt::entity> &relaunched) {
+        Hits hits;
+        Collisions::beginTick(world);
+
+        for (size_t i = 0; i < world.pawns.size(); ++i) {
+            auto &transform = world.registry.get<TransformComponent>(world.pawns[i]);
+            const glm::vec3 from = transform.position;
+            PawnMovement::move(transform.position, World::inputFor(i, tickNumber), DELTA_TIME, [&](const glm::vec3 &position) {
+                return Collisions::pawnHitsWall(world, position, transform.scale);
+            });
+            Collisions::moved(world, world.pawns[i], from, transform.position);
+        }
+
+        relaunched.clear();
+        for (const auto fireball : world.registry.view<FireballComponent, TransformComponent>()) {
+            auto &component = world.registry.get<FireballComponent>(fireball);
+            auto &transform = world.registry.get<TransformComponent>(fireball);
+
+            glm::vec3 position = component.position;
+            position.x += component.direction.x * component.speed * DELTA_TIME;
+            position.y += component.direction.y * component.speed * DELTA_TIME;
+            position.z = 3.0f;
+
+            Collisions::moved(world, fireball, transform.position, position);
+            component.position = position;
+            transform.position = position;
+
+            if (Collisions::fireballHitsWall(world, position)) {
+                ++hits.walls;
+            } else if (Collisions::fireballHitsFireball(world, fireball, position)) {
+                ++hits.fireballs;
+            } else if (Collisions::fireballHitsPawn(world, position)) {
+                ++hits.pawns;
+            } else {
+                continue;
+            }
+            relaunched.push_back(fireball);
+        }
+
+        // like a destroyed fireball being replaced by a new shot, after the pass
+        for (const auto fireball : relaunched) {
+            const glm::vec3 from = world.registry.get<TransformComponent>(fireball).position;
+            world.relaunch(fireball);
+            Collisions::moved(world, fireball, from, world.registry.get<TransformComponent>(fireball).position);
+        }
+        return hits;
+    }
+
+    template<typename Collisions>
+    Hits run(const char *name, const Map &map, size_t fireballs, size_t ticks) {
+        World world(map, fireballs);
+        std::vector<entt::entity> relaunched;
+        Hits total;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ticks; ++i) {
+            const Hits hits = tick<Collisions>(world, i, relaunched);
+            total.walls += hits.walls;
+            total.fireballs += hits.fireballs;
+            total.pawns += hits.pawns;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%-5s %10.0f ticks/s  %8.3f ms/tick   hits: %llu walls, %llu fireballs, %llu pawns\n",
+                    name, static_cast<double>(ticks) / seconds, seconds * 1000.0 / static_cast<double>(ticks),
+                    static_cast<unsigned long long>(total.walls), static_cast<unsigned long long>(total.fireballs),
+                    static_cast<unsigned long long>(total.pawns));
+        return total;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t fireballs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    const size_t ticks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3000;
+
+    const Map map = MapGenerator(50, 50).getMap();
+    std::printf("%zux%zu map, %zu pawns, %zu fireballs, %zu ticks\n", map[0].size(), map.size(), PAWNS, fireballs, ticks);
+
+    const Hits scan = run<ScanCollisions>("scan", map, fireballs, ticks);
+    const Hits grid = run<GridCollisions>("grid", map, fireballs, ticks);
+    if (!(scan == grid)) {
+        std::printf("MISMATCH: the grid and the scans disagree on the hits\n");
+        return 1;
+    }
+    return 0;
+}
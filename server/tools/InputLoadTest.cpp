@@ -0,0 +1,186 @@
+// Drives websocket-style input from thousands of simulated clients through the old routing (one
+// handler mutex, a per-lobby input mutex and map) and the sharded routing (shard lock taken shared,
+// an InputRing per player), while a 30Hz tick drains every lobby. Reports messages per
+// second for a growing number of sender threads, the stand-in for crow's worker threads.
+//
+// usage: input_load_test [clients] [seconds per run] [max threads]
+
+#include "core/SlotMap.hpp"
+#include "network/InputRing.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr size_t PLAYERS_PER_LOBBY = 2;
+    constexpr size_t SHARDS = 16;
+    constexpr auto TICK = std::chrono::microseconds(33333);
+
+    // Lobby::setPlayerInput before the shards: the whole map is moved out every tick.
+    struct LockedLobby {
+        std::mutex inputMutex;
+        std::unordered_map<uint64_t, PlayerInput> inputQueue;
+    };
+
+    struct SlotLobby {
+        std::array<uint64_t, PLAYERS_PER_LOBBY> players{};
+        std::array<std::shared_ptr<InputRing>, PLAYERS_PER_LOBBY> inputRings;
+    };
+
+    struct Shard {
+        std::shared_mutex mutex;
+        SlotMap<SlotLobby> lobbies;
+    };
+
+    struct Client {
+        uint64_t playerId;
+        size_t lobby;
+        SlotMap<SlotLobby>::Handle handle;
+        std::shared_ptr<InputRing> inputRing; // what addConnection hands the connection
+    };
+
+    class GlobalRouting {
+    public:
+        explicit GlobalRouting(std::vector<Client> &clients) : lobbies(clients.size() / PLAYERS_PER_LOBBY) {
+            for (auto &client: clients) {
+                clientLobbies.emplace(client.playerId, &lobbies[client.lobby]);
+            }
+        }
+
+        void send(const Client &client, const PlayerInput &input) {
+            std::lock_guard<std::mutex> lock(handlerMutex);
+            LockedLobby *lobby = clientLobbies.at(client.playerId);
+            std::lock_guard<std::mutex> inputLock(lobby->inputMutex);
+            lobby->inputQueue[client.playerId] = input;
+        }
+
+        size_t tick() {
+            size_t inputs = 0;
+            for (auto &lobby: lobbies) {
+                std::unordered_map<uint64_t, PlayerInput> latest;
+                {
+                    std::lock_guard<std::mutex> lock(lobby.inputMutex);
+                    latest = std::move(lobby.inputQueue);
+                    lobby.inputQueue.clear();
+                }
+                inputs += latest.size();
+            }
+            return inputs;
+        }
+
+    private:
+        std::mutex handlerMutex;
+        std::vector<LockedLobby> lobbies;
+        std::unordered_map<uint64_t, LockedLobby *> clientLobbies;
+    };
+
+    class ShardedRouting {
+    public:
+        explicit ShardedRouting(std::vector<Client> &clients) {
+            for (size_t i = 0; i < clients.size(); i += PLAYERS_PER_LOBBY) {
+                Shard &shard = shards[clients[i].lobby % SHARDS];
+                const auto handle = shard.lobbies.emplace();
+                for (size_t seat = 0; seat < PLAYERS_PER_LOBBY; ++seat) {
+                    SlotLobby *lobby = shard.lobbies.get(handle);
+                    lobby->players[seat] = clients[i + seat].playerId;
+                    lobby->inputRings[seat] = std::make_shared<InputRing>();
+                    clients[i + seat].inputRing = lobby->inputRings[seat];
+                    clients[i + seat].handle = handle;
+                }
+            }
+        }
+
+        void send(const Client &client, const PlayerInput &input) {
+            Shard &shard = shards[client.lobby % SHARDS];
+            std::shared_lock lock(shard.mutex);
+            if (shard.lobbies.get(client.handle)) {
+                client.inputRing->push(input);
+            }
+        }
+
+        size_t tick() {
+            size_t inputs = 0;
+            for (auto &shard: shards) {
+                std::unique_lock lock(shard.mutex);
+                for (auto &lobby: shard.lobbies) {
+                    for (auto &ring: lobby.inputRings) inputs += ring->drain([](const PlayerInput &) {});
+                }
+            }
+            return inputs;
+        }
+
+    private:
+        std::array<Shard, SHARDS> shards;
+    };
+
+    template<typename Routing>
+    void run(const char *name, size_t clientCount, double seconds, size_t maxThreads) {
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            std::vector<Client> clients;
+            std::vector<uint32_t> sequences(clientCount, 0); // a client is only ever sent from one thread
+            for (size_t i = 0; i < clientCount; ++i) {
+                clients.push_back({i + 1, i / PLAYERS_PER_LOBBY, {}});
+            }
+            Routing routing(clients);
+
+            std::atomic<bool> running = true;
+            std::atomic<uint64_t> sent = 0;
+            size_t ticked = 0;
+
+            std::thread ticker([&] {
+                auto next = std::chrono::steady_clock::now();
+                while (running) {
+                    ticked += routing.tick();
+                    next += TICK;
+                    std::this_thread::sleep_until(next);
+                }
+            });
+
+            std::vector<std::thread> senders;
+            for (size_t t = 0; t < threads; ++t) {
+                senders.emplace_back([&, t] {
+                    PlayerInput input;
+                    uint64_t count = 0;
+                    for (size_t i = t; running; i += threads) {
+                        const size_t index = i % clients.size();
+                        const Client &client = clients[index];
+                        input.sequence = ++sequences[index];
+                        input.moveForward = (i & 1) != 0;
+                        input.aimRotation = static_cast<float>(i & 255) * 0.01f;
+                        routing.send(client, input);
+                        ++count;
+                    }
+                    sent += count;
+                });
+            }
+
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+            running = false;
+            for (auto &sender: senders) sender.join();
+            ticker.join();
+
+            std::printf("%-8s %2zu threads  %12.0f messages/s  %10zu inputs applied\n",
+                        name, threads, static_cast<double>(sent) / seconds, ticked);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t clients = argc > 1 ? std::strtoul(argv[1], nullptr, 10) / PLAYERS_PER_LOBBY * PLAYERS_PER_LOBBY : 4000;
+    const double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+    const size_t maxThreads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%zu clients in %zu lobbies, %.1fs per run\n", clients, clients / PLAYERS_PER_LOBBY, seconds);
+    run<GlobalRouting>("global", clients, seconds, maxThreads);
+    run<ShardedRouting>("sharded", clients, seconds, maxThreads);
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Times the /login lookup against databases of 10k, 100k and 1M synthetic accounts: the previous
+// getAll<Player>() and a scan for the username, against DatabaseManager::findPlayerByUsername with the
+// unique index and the prepared statement. Each database is a fresh file in the temp directory.
+//
+// usage: login_bench [indexed lookups] [scan lookups]
+
+#include "data/DatabaseManager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+
+namespace {
+    std::string usernameFor(size_t i) { return "player" + std::to_string(i); }
+    std::string passwordFor(size_t i) { return "secret" + std::to_string(i); }
+
+    void removeDatabase(const std::filesystem::path &file) {
+        for (const char *suffix : {"", "-wal", "-shm"}) {
+            std::filesystem::remove(file.string() + suffix);
+        }
+    }
+
+    // Returns microseconds per login, login(username, password) tells whether it succeeded.
+    template<typename Login>
+    double timeLogins(size_t accounts, size_t lookups, Login &&login) {
+        std::mt19937_64 random(42);
+        std::uniform_int_distribution<size_t> account(0, accounts - 1);
+
+        size_t failed = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups; ++i) {
+            const size_t picked = account(random);
+            if (!login(usernameFor(picked), passwordFor(picked))) ++failed;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (failed > 0) std::printf("  %zu logins failed\n", failed);
+        return seconds * 1e6 / static_cast<double>(lookups);
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t lookups = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    const size_t scanLookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+
+    for (const size_t accounts : {10000, 100000, 1000000}) {
+        const auto file = std::filesystem::temp_directory_path() / ("atlas_login_bench_" + std::to_string(accounts) + ".db");
+        removeDatabase(file);
+
+        DatabaseManager::init(file.string());
+        DatabaseManager::setSynchronous(false);
+
+        const auto fillStart = std::chrono::steady_clock::now();
+        DatabaseManager::transaction([&] {
+            for (size_t i = 0; i < accounts; ++i) {
+                DatabaseManager::create(Player(usernameFor(i), passwordFor(i), 0));
+            }
+        });
+        const double fillSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fillStart).count();
+
+        // /login before the index: the whole table is loaded for every request
+        const double scanUs = timeLogins(accounts, scanLookups, [](const std::string &username, const std::string &password) {
+            const auto players = DatabaseManager::getAll<Player>();
+            const auto it = std::ranges::find_if(players, [&](const Player &player) { return player.getUsername() == username; });
+            return it != players.end() && it->getPassword() == password;
+        });
+
+        const double indexUs = timeLogins(accounts, lookups, [](const std::string &username, const std::string &password) {
+            const auto player = DatabaseManager::findPlayerByUsername(username);
+            return player && player->getPassword() == password;
+        });
+
+        std::printf("%8zu accounts (filled in %5.1fs)  scan %11.1f us/login   index %6.1f us/login   %8.0fx\n",
+                    accounts, fillSeconds, scanUs, indexUs, scanUs / indexUs);
+
+        DatabaseManager::shutdown();
+        removeDatabase(file);
+    }
+    return 0;
+}
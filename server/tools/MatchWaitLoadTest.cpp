@@ -0,0 +1,333 @@
+// Keeps a queue of stand-in players waiting for a match while a matchmaking pass every 250ms matches a
+// fixed number of them per second, and every matched player is replaced by a new one. The clients
+// learn about their match once by polling /match_status every second, as they did before, and once
+// through one /match_wait long poll each. Both routes are replicas of the server's handlers over the
+// same queue, lobby shards and parked-request registry, with the HTTP layer left out, which if
+// anything flatters polling. Reports requests per second, process CPU and how long a matched player
+// took to find out.
+//
+// usage: match_wait_load_test [queued players] [players matched per second] [seconds per run]
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t SHARDS = 16;
+    constexpr size_t DRIVER_THREADS = 2;
+    constexpr auto MATCHMAKING_INTERVAL = std::chrono::milliseconds(250);
+    constexpr auto POLL_INTERVAL = std::chrono::seconds(1);
+    constexpr auto MAX_MATCH_WAIT = std::chrono::milliseconds(25000);
+
+    struct Response {
+        int code = 0;
+        std::string body;
+    };
+
+    std::string matchFoundBody(uint64_t matchId) {
+        return nlohmann::json{{"matchFound", true}, {"matchId", matchId}}.dump();
+    }
+
+    // MatchWaitRegistry with the crow response replaced by the slot of the client that parked it.
+    class WaitRegistry {
+    public:
+        using Complete = std::function<void(size_t slot, const Response &response)>;
+
+        explicit WaitRegistry(Complete complete) : onComplete(std::move(complete)) {}
+
+        void wait(uint64_t playerId, size_t slot, Clock::time_point deadline) {
+            std::lock_guard<std::mutex> lock(mutex);
+            waiters[playerId].push_back({slot, deadline});
+        }
+
+        void notify(uint64_t playerId, uint64_t matchId) {
+            std::vector<Waiter> pending;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = waiters.find(playerId);
+                if (it == waiters.end()) return;
+                pending = std::move(it->second);
+                waiters.erase(it);
+            }
+            complete(pending, {200, matchFoundBody(matchId)});
+        }
+
+        void expire(Clock::time_point now) {
+            std::vector<Waiter> expired;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto it = waiters.begin(); it != waiters.end();) {
+                    std::erase_if(it->second, [&](const Waiter &waiter) {
+                        if (waiter.deadline > now) return false;
+                        expired.push_back(waiter);
+                        return true;
+                    });
+                    it = it->second.empty() ? waiters.erase(it) : std::next(it);
+                }
+            }
+            complete(expired, {200, R"({"matchFound": false})"});
+        }
+
+    private:
+        struct Waiter {
+            size_t slot;
+            Clock::time_point deadline;
+        };
+
+        std::mutex mutex;
+        std::unordered_map<uint64_t, std::vector<Waiter>> waiters;
+        Complete onComplete;
+
+        void complete(const std::vector<Waiter> &pending, const Response &response) {
+            for (const Waiter &waiter: pending) onComplete(waiter.slot, response);
+        }
+    };
+
+    // One client, the player it currently queues with and when that player was matched.
+    struct Slot {
+        uint64_t playerId = 0;
+        std::atomic<int64_t> matchedAt{0}; // ns since start, written by the matchmaking pass
+        Clock::time_point nextPoll;
+    };
+
+    struct LobbyShard {
+        std::shared_mutex mutex;
+        std::unordered_map<uint64_t, uint64_t> playerLobbies;
+    };
+
+    // Finished long polls, handed from the thread that completed them to the slot's driver thread.
+    struct Inbox {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<std::pair<size_t, bool>> completed; // slot, match found
+    };
+
+    class Server {
+    public:
+        Server(size_t slotCount, size_t matchesPerSecond, bool longPoll)
+            : slots(slotCount), longPoll(longPoll),
+              matchesPerPass(std::max<size_t>(2, matchesPerSecond * MATCHMAKING_INTERVAL.count() / 1000 / 2 * 2)),
+              waits([this](size_t slot, const Response &response) { deliver(slot, response); }) {
+            std::mt19937_64 random(42);
+            std::uniform_int_distribution<int64_t> phase(0, std::chrono::duration_cast<std::chrono::nanoseconds>(POLL_INTERVAL).count());
+            for (size_t slot = 0; slot < slots.size(); ++slot) {
+                slots[slot].nextPoll = start + std::chrono::nanoseconds(phase(random));
+                join(slot);
+            }
+        }
+
+        void run(std::chrono::duration<double> duration) {
+            running = true;
+            std::thread matchmaker([this] { matchmakingLoop(); });
+
+            std::vector<std::thread> drivers;
+            for (size_t t = 0; t < DRIVER_THREADS; ++t) {
+                drivers.emplace_back([this, t] { longPoll ? longPollClients(t) : pollingClients(t); });
+            }
+
+            std::this_thread::sleep_for(duration);
+            running = false;
+            for (auto &inbox: inboxes) inbox.condition.notify_all();
+            for (auto &driver: drivers) driver.join();
+            matchmaker.join();
+        }
+
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> noticed{0};
+        std::atomic<int64_t> noticeNs{0};
+
+    private:
+        const Clock::time_point start = Clock::now();
+        std::vector<Slot> slots;
+        const bool longPoll;
+        const size_t matchesPerPass;
+        std::atomic<bool> running{false};
+
+        std::mutex queueMutex;
+        std::unordered_map<uint64_t, size_t> matchmakingQueue; // player id -> slot, guarded by queueMutex
+        std::deque<uint64_t> arrivals;                         // guarded by queueMutex
+        uint64_t nextPlayerId = 1;                             // guarded by queueMutex
+        uint64_t nextLobbyId = 1;                              // matchmaking thread only
+        std::array<LobbyShard, SHARDS> lobbyShards;
+
+        WaitRegistry waits;
+        std::array<Inbox, DRIVER_THREADS> inboxes;
+
+        int64_t elapsedNs() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        }
+
+        // /join_queue
+        void join(size_t slot) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            slots[slot].playerId = nextPlayerId++;
+            matchmakingQueue.emplace(slots[slot].playerId, slot);
+            arrivals.push_back(slots[slot].playerId);
+        }
+
+        std::optional<uint64_t> findPlayerLobby(uint64_t playerId) {
+            auto &shard = lobbyShards[playerId % SHARDS];
+            std::shared_lock lock(shard.mutex);
+            auto it = shard.playerLobbies.find(playerId);
+            if (it == shard.playerLobbies.end()) return std::nullopt;
+            return it->second;
+        }
+
+        // /match_status
+        Response matchStatus(uint64_t playerId) {
+            ++requests;
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (auto lobby = findPlayerLobby(playerId)) {
+                return {200, matchFoundBody(*lobby)};
+            }
+            if (!matchmakingQueue.contains(playerId)) {
+                return {404, R"({"error": "Player not found in queue or match"})"};
+            }
+            return {200, R"({"matchFound": false})"};
+        }
+
+        // /match_wait, answered through deliver()
+        void matchWait(size_t slot) {
+            ++requests;
+            const uint64_t playerId = slots[slot].playerId;
+            Response response;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (auto lobby = findPlayerLobby(playerId)) {
+                    response = {200, matchFoundBody(*lobby)};
+                } else if (!matchmakingQueue.contains(playerId)) {
+                    response = {404, R"({"error": "Player not found in queue or match"})"};
+                } else {
+                    waits.wait(playerId, slot, Clock::now() + MAX_MATCH_WAIT);
+                    return;
+                }
+            }
+            deliver(slot, response);
+        }
+
+        void deliver(size_t slot, const Response &response) {
+            Inbox &inbox = inboxes[slot % DRIVER_THREADS];
+            {
+                std::lock_guard<std::mutex> lock(inbox.mutex);
+                inbox.completed.emplace_back(slot, response.body.find("\"matchFound\":true") != std::string::npos);
+            }
+            inbox.condition.notify_one();
+        }
+
+        // The client saw its match: count how late, then come back as a new player.
+        void matched(size_t slot) {
+            noticeNs += elapsedNs() - slots[slot].matchedAt.load(std::memory_order_relaxed);
+            ++noticed;
+            join(slot);
+        }
+
+        void pollingClients(size_t thread) {
+            while (running) {
+                const auto now = Clock::now();
+                for (size_t slot = thread; slot < slots.size(); slot += DRIVER_THREADS) {
+                    if (slots[slot].nextPoll > now) continue;
+                    const Response response = matchStatus(slots[slot].playerId);
+                    if (response.body.find("\"matchFound\":true") != std::string::npos) matched(slot);
+                    slots[slot].nextPoll = now + POLL_INTERVAL;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+
+        void longPollClients(size_t thread) {
+            for (size_t slot = thread; slot < slots.size(); slot += DRIVER_THREADS) matchWait(slot);
+
+            Inbox &inbox = inboxes[thread];
+            std::vector<std::pair<size_t, bool>> completed;
+            while (running) {
+                {
+                    std::unique_lock<std::mutex> lock(inbox.mutex);
+                    inbox.condition.wait_for(lock, std::chrono::milliseconds(50), [&] { return !inbox.completed.empty() || !running; });
+                    completed.swap(inbox.completed);
+                }
+                for (const auto &[slot, found]: completed) {
+                    if (found) matched(slot);
+                    matchWait(slot);
+                }
+                completed.clear();
+            }
+        }
+
+        // Matches the longest waiting players in pairs, then completes their parked requests outside queueMutex.
+        void matchmakingLoop() {
+            std::vector<std::pair<uint64_t, uint64_t>> matchedWaits;
+            while (running) {
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    for (size_t count = 0; count < matchesPerPass && !arrivals.empty();) {
+                        const uint64_t playerId = arrivals.front();
+                        arrivals.pop_front();
+                        auto it = matchmakingQueue.find(playerId);
+                        if (it == matchmakingQueue.end()) continue;
+
+                        const uint64_t lobbyId = nextLobbyId + count / 2;
+                        {
+                            auto &shard = lobbyShards[playerId % SHARDS];
+                            std::unique_lock shardLock(shard.mutex);
+                            shard.playerLobbies[playerId] = lobbyId;
+                        }
+                        slots[it->second].matchedAt.store(elapsedNs(), std::memory_order_relaxed);
+                        matchmakingQueue.erase(it);
+                        matchedWaits.emplace_back(playerId, lobbyId);
+                        ++count;
+                    }
+                    nextLobbyId += matchesPerPass / 2;
+                }
+
+                for (const auto &[playerId, lobbyId]: matchedWaits) waits.notify(playerId, lobbyId);
+                matchedWaits.clear();
+                waits.expire(Clock::now());
+                std::this_thread::sleep_for(MATCHMAKING_INTERVAL);
+            }
+        }
+    };
+
+    void run(const char *name, bool longPoll, size_t players, size_t matchesPerSecond, double seconds) {
+        Server server(players, matchesPerSecond, longPoll);
+
+        const std::clock_t cpuStart = std::clock(); // process CPU time, all threads
+        server.run(std::chrono::duration<double>(seconds));
+        const double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        const double requests = static_cast<double>(server.requests.load());
+        const uint64_t noticed = server.noticed.load();
+        std::printf("%-10s %10.0f requests/s  CPU %6.1f%% of a core  %7.2f us/request  %6zu matches seen %8.1f ms after\n",
+                    name, requests / seconds, cpuSeconds / seconds * 100.0, cpuSeconds * 1e6 / std::max(1.0, requests),
+                    static_cast<size_t>(noticed), noticed ? static_cast<double>(server.noticeNs.load()) / noticed / 1e6 : 0.0);
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t players = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const size_t matchesPerSecond = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+    const double seconds = argc > 3 ? std::atof(argv[3]) : 30.0;
+
+    std::printf("%zu queued players, %zu matched per second, %.0fs per run\n", players, matchesPerSecond, seconds);
+    run("status", false, players, matchesPerSecond, seconds);
+    run("wait", true, players, matchesPerSecond, seconds);
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Replays synthetic queue arrivals through MatchmakingIndex and reports throughput and time to match. Every
+// pass works like ServerNetworkService::tryMatchGroups: collect the candidate groups, score them all, then
+// take them in anchor order while none of their players is matched yet.
+//
+// usage: matchmaking_sim [arrivals per second] [simulated seconds] [group size]
+
+#include "matchmaking/MatchmakingIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    struct SimulatedPlayer {
+        double rating;
+        double deviation;
+        MatchmakingIndex::Clock::time_point queueTime;
+    };
+
+    // Same rule as evaluateMatch in the matchmaker library: quality falls with the largest distance from the mean.
+    double evaluateQuality(const std::vector<double> &ratings) {
+        double mean = 0.0;
+        for (const double rating: ratings) mean += rating;
+        mean /= static_cast<double>(ratings.size());
+
+        double maxSpread = 0.0;
+        for (const double rating: ratings) maxSpread = std::max(maxSpread, std::abs(rating - mean));
+
+        return maxSpread < 600.0 ? 1.0 - maxSpread / 800.0 : 0.0;
+    }
+
+    double percentile(std::vector<double> &sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        return sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1))];
+    }
+}
+
+int main(int argc, char **argv) {
+    const double arrivalsPerSecond = argc > 1 ? std::atof(argv[1]) : 200.0;
+    const double simulatedSeconds = argc > 2 ? std::atof(argv[2]) : 300.0;
+    const size_t groupSize = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2;
+    const double minQuality = groupSize == 2 ? 0.7 : 0.6; // the server's duel and arena thresholds
+
+    constexpr auto passInterval = std::chrono::milliseconds(250); // ServerNetworkService::MATCHMAKING_INTERVAL
+
+    std::mt19937_64 random(42);
+    std::normal_distribution<double> ratingDistribution(1500.0, 300.0);
+    std::uniform_real_distribution<double> deviationDistribution(50.0, 350.0);
+    std::poisson_distribution<int> arrivalDistribution(arrivalsPerSecond * std::chrono::duration<double>(passInterval).count());
+
+    MatchmakingIndex index;
+    std::unordered_map<uint64_t, SimulatedPlayer> queue;
+    std::vector<double> waitSeconds;
+    std::vector<double> ratings;
+    std::vector<uint64_t> candidates;
+    std::vector<double> quality;
+
+    uint64_t nextPlayerId = 1;
+    size_t matches = 0;
+    size_t peakQueue = 0;
+    double matchingSeconds = 0.0;
+
+    auto now = MatchmakingIndex::Clock::time_point{};
+    const auto end = now + std::chrono::duration_cast<MatchmakingIndex::Clock::duration>(std::chrono::duration<double>(simulatedSeconds));
+
+    for (; now < end; now += passInterval) {
+        for (int i = arrivalDistribution(random); i > 0; --i) {
+            const uint64_t playerId = nextPlayerId++;
+            const SimulatedPlayer player{ratingDistribution(random), deviationDistribution(random), now};
+            queue.emplace(playerId, player);
+            index.insert(playerId, player.rating, player.deviation, now);
+        }
+        peakQueue = std::max(peakQueue, index.size());
+
+        const auto passStart = std::chrono::steady_clock::now();
+        candidates.clear();
+        const size_t groupCount = index.collectCandidates(groupSize, now, candidates);
+        quality.resize(groupCount);
+        for (size_t g = 0; g < groupCount; ++g) {
+            ratings.clear();
+            for (size_t seat = 0; seat < groupSize; ++seat) ratings.push_back(queue.at(candidates[g * groupSize + seat]).rating);
+            quality[g] = evaluateQuality(ratings);
+        }
+
+        for (size_t g = 0; g < groupCount; ++g) {
+            if (quality[g] < minQuality) continue;
+
+            const std::span<const uint64_t> group(candidates.data() + g * groupSize, groupSize);
+            if (!std::ranges::all_of(group, [&](uint64_t playerId) { return index.contains(playerId); })) continue;
+
+            for (const uint64_t playerId: group) {
+                waitSeconds.push_back(std::chrono::duration<double>(now - queue.at(playerId).queueTime).count());
+                queue.erase(playerId);
+                index.erase(playerId);
+            }
+            ++matches;
+        }
+        matchingSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - passStart).count();
+    }
+
+    std::ranges::sort(waitSeconds);
+
+    std::printf("arrivals: %llu over %.0fs (%.0f/s), group size %zu\n",
+                static_cast<unsigned long long>(nextPlayerId - 1), simulatedSeconds, arrivalsPerSecond, groupSize);
+    std::printf("matches: %zu, still queued: %zu, peak queue: %zu\n", matches, index.size(), peakQueue);
+    std::printf("matching cpu: %.3fs, %.0f matches/s\n", matchingSeconds, matchingSeconds > 0.0 ? matches / matchingSeconds : 0.0);
+    std::printf("time to match: p50 %.2fs, p95 %.2fs, p99 %.2fs, max %.2fs\n",
+                percentile(waitSeconds, 0.50), percentile(waitSeconds, 0.95),
+                percentile(waitSeconds, 0.99), percentile(waitSeconds, 1.0));
+    return 0;
+}
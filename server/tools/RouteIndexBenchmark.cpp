@@ -0,0 +1,112 @@
+// Times the lookups behind /login, /join_match (and the websocket handshake) and /match_result with
+// the previous linear scans and with the session and lobby indexes.
+//
+// usage: route_bench [sessions] [lookups]
+
+#include "core/SlotMap.hpp"
+#include "network/SessionRegistry.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace {
+    // The part of Lobby the routes look at.
+    struct BenchLobby {
+        uint64_t id;
+        std::vector<uint64_t> players;
+
+        bool containsPlayer(uint64_t playerId) const { return std::ranges::find(players, playerId) != players.end(); }
+    };
+
+    template<typename Func>
+    double timeLookups(size_t lookups, Func &&lookup) {
+        uint64_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups; ++i) {
+            checksum += lookup(i);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (checksum == 1) std::puts(""); // keeps the lookups from being optimized out
+        return seconds * 1e9 / static_cast<double>(lookups);
+    }
+
+    void report(const char *route, double scanNs, double indexNs) {
+        std::printf("%-14s scan %10.1f ns   index %8.1f ns   %6.0fx\n", route, scanNs, indexNs, scanNs / indexNs);
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t sessionCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    const size_t lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+
+    std::mt19937_64 random(42);
+
+    // sessions as the old map held them, and the registry
+    std::unordered_map<uint64_t, Player> sessionMap;
+    SessionRegistry sessions;
+    std::vector<std::string> usernames;
+    std::vector<uint64_t> tokens;
+    for (size_t i = 0; i < sessionCount; ++i) {
+        Player player("player" + std::to_string(i), "password", 0);
+        const uint64_t token = sessions.open(player);
+        sessionMap.emplace(token, player);
+        usernames.push_back(player.getUsername());
+        tokens.push_back(token);
+    }
+
+    // every session in a duel lobby
+    std::vector<BenchLobby> lobbyVector;
+    SlotMap<BenchLobby> lobbies;
+    std::unordered_map<uint64_t, SlotMap<BenchLobby>::Handle> lobbyIds;
+    std::unordered_map<uint64_t, SlotMap<BenchLobby>::Handle> playerLobbies;
+    for (size_t i = 0; i + 1 < tokens.size(); i += 2) {
+        BenchLobby lobby{i / 2 + 1, {tokens[i], tokens[i + 1]}};
+        const auto handle = lobbies.emplace(lobby);
+        lobbyIds.emplace(lobby.id, handle);
+        playerLobbies.emplace(tokens[i], handle);
+        playerLobbies.emplace(tokens[i + 1], handle);
+        lobbyVector.push_back(std::move(lobby));
+    }
+
+    std::vector<size_t> picks(lookups);
+    std::uniform_int_distribution<size_t> pick(0, lobbyVector.size() * 2 - 1);
+    for (auto &index: picks) index = pick(random);
+
+    std::printf("%zu sessions, %zu lobbies, %zu lookups per route\n", sessionCount, lobbies.size(), lookups);
+
+    report("/login",
+           timeLookups(lookups, [&](size_t i) -> uint64_t {
+               for (const auto &[token, player]: sessionMap) {
+                   if (player.getUsername() == usernames[picks[i]]) return token;
+               }
+               return 0;
+           }),
+           timeLookups(lookups, [&](size_t i) -> uint64_t {
+               return sessions.open(Player(usernames[picks[i]], "password", 0));
+           }));
+
+    report("/join_match",
+           timeLookups(lookups, [&](size_t i) -> uint64_t {
+               for (const auto &lobby: lobbyVector) {
+                   if (lobby.containsPlayer(tokens[picks[i]])) return lobby.id;
+               }
+               return 0;
+           }),
+           timeLookups(lookups, [&](size_t i) -> uint64_t {
+               auto it = playerLobbies.find(tokens[picks[i]]);
+               return it != playerLobbies.end() ? lobbies.get(it->second)->id : 0;
+           }));
+
+    report("/match_result",
+           timeLookups(lookups, [&](size_t i) -> uint64_t {
+               const uint64_t matchId = picks[i] / 2 + 1;
+               auto it = std::ranges::find(lobbyVector, matchId, &BenchLobby::id);
+               return it != lobbyVector.end() ? it->players.size() : 0;
+           }),
+           timeLookups(lookups, [&](size_t i) -> uint64_t {
+               auto it = lobbyIds.find(picks[i] / 2 + 1);
+               return it != lobbyIds.end() ? lobbies.get(it->second)->players.size() : 0;
+           }));
+    return 0;
+}